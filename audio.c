@@ -0,0 +1,296 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "profiler.h"
+#include "spsc.h"
+#include "instrument.h"
+#include "effects.h"
+#include "audio.h"
+
+#define RING_FRAMES 2048                            // Rendered audio waiting for the device (power of two)
+#define TARGET_FILL (AUDIO_BUFFER_FRAMES * 2)       // Frames the render thread keeps queued
+#define LATENCY_FRAMES (TARGET_FILL + AUDIO_BUFFER_FRAMES)
+#define NOTE_QUEUE 1024                             // Scheduler -> render notes in flight
+#define MAX_PENDING 512                             // Notes waiting for their frame
+
+// Note from the scheduler thread, stamped with its nowSeconds() deadline
+typedef struct {
+    double time;
+    uint8_t note;
+    uint8_t velocity;
+} AudioNote;
+
+// Note converted to the frame it must start on
+typedef struct {
+    uint64_t frame;
+    uint8_t note;
+    uint8_t velocity;
+} PendingNote;
+
+struct AudioEngine {
+    Instrument instrument;          // Owned by the render thread
+    EffectChain effects;            // Owned by the render thread
+    SpscQueue notes;                // Scheduler -> render thread
+    PendingNote pending[MAX_PENDING]; // Sorted by frame, owned by the render thread
+    int pendingCount;
+    float ring[RING_FRAMES * 2];    // Interleaved stereo
+    _Atomic uint64_t writeFrame;    // Frames rendered into the ring
+    _Atomic uint64_t readFrame;     // Frames handed to the device
+    _Atomic uint32_t anchorSequence; // Seqlock around the anchor pair
+    _Atomic uint64_t anchorFrame;   // readFrame when the device last pulled
+    _Atomic int64_t anchorWallNs;   // nowSeconds() when the device last pulled
+    atomic_bool running;
+    pthread_t renderThread;
+    pthread_t deviceThread;         // Null device only
+    bool deviceThreadStarted;
+    bool nullDevice;
+    AudioStream stream;             // raylib device only
+
+    _Atomic uint32_t underruns;
+    _Atomic uint32_t droppedNotes;
+    _Atomic uint32_t loadPermille;
+    _Atomic int activeVoices;
+};
+
+// raylib's stream callback carries no user pointer
+static AudioEngine* streamEngine = NULL;
+
+static void publishAnchor(AudioEngine* engine, uint64_t frame, double wall) {
+    uint32_t sequence = atomic_load_explicit(&engine->anchorSequence, memory_order_relaxed);
+    atomic_store_explicit(&engine->anchorSequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&engine->anchorFrame, frame, memory_order_relaxed);
+    atomic_store_explicit(&engine->anchorWallNs, (int64_t)(wall * 1e9), memory_order_relaxed);
+    atomic_store_explicit(&engine->anchorSequence, sequence + 2, memory_order_release);
+}
+
+static void readAnchor(AudioEngine* engine, uint64_t* frame, double* wall) {
+    for (;;) {
+        uint32_t before = atomic_load_explicit(&engine->anchorSequence, memory_order_acquire);
+        *frame = atomic_load_explicit(&engine->anchorFrame, memory_order_relaxed);
+        *wall = atomic_load_explicit(&engine->anchorWallNs, memory_order_relaxed) / 1e9;
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t after = atomic_load_explicit(&engine->anchorSequence, memory_order_relaxed);
+        if (before == after && !(before & 1)) return;
+        spinPause();
+    }
+}
+
+// Device side: copy rendered frames out of the ring, padding with silence on underrun
+static void consumeFrames(AudioEngine* engine, float* output, unsigned int frames) {
+    double started = profileBegin();
+    uint64_t read = atomic_load_explicit(&engine->readFrame, memory_order_relaxed);
+    uint64_t write = atomic_load_explicit(&engine->writeFrame, memory_order_acquire);
+    publishAnchor(engine, read, started);
+
+    unsigned int available = (unsigned int)(write - read);
+    unsigned int count = frames < available ? frames : available;
+    unsigned int start = (unsigned int)(read & (RING_FRAMES - 1));
+    unsigned int first = count < RING_FRAMES - start ? count : RING_FRAMES - start;
+    memcpy(output, &engine->ring[start * 2], sizeof(float) * 2 * first);
+    memcpy(output + first * 2, engine->ring, sizeof(float) * 2 * (count - first));
+    if (count < frames) {
+        memset(output + count * 2, 0, sizeof(float) * 2 * (frames - count));
+        atomic_fetch_add_explicit(&engine->underruns, 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&engine->readFrame, read + count, memory_order_release);
+    profileEnd(PROFILE_AUDIO_CALLBACK, started);
+}
+
+static void streamCallback(void* buffer, unsigned int frames) {
+    if (streamEngine) consumeFrames(streamEngine, buffer, frames);
+}
+
+// Stand-in for a sound card: pulls buffers at the real-time rate and drops them
+static void* nullDeviceThread(void* argument) {
+    AudioEngine* engine = argument;
+    float buffer[AUDIO_BUFFER_FRAMES * 2];
+    double period = (double)AUDIO_BUFFER_FRAMES / AUDIO_SAMPLE_RATE;
+    double deadline = nowSeconds();
+    while (atomic_load_explicit(&engine->running, memory_order_acquire)) {
+        deadline += period;
+        sleepUntil(deadline);
+        consumeFrames(engine, buffer, AUDIO_BUFFER_FRAMES);
+    }
+    return NULL;
+}
+
+static void applyNote(AudioEngine* engine, int note, int velocity) {
+    if (velocity > 0) engine->instrument.noteOn(engine->instrument.state, note, velocity);
+    else engine->instrument.noteOff(engine->instrument.state, note);
+}
+
+// Turn queued deadlines into frames. A note due at wall time t is heard
+// LATENCY_FRAMES after the device position at t, which always lands after
+// what has been rendered, so note spacing is kept to the sample.
+static void collectNotes(AudioEngine* engine, uint64_t write) {
+    uint64_t anchorFrame;
+    double anchorWall;
+    readAnchor(engine, &anchorFrame, &anchorWall);
+
+    AudioNote note;
+    while (spscPop(&engine->notes, &note)) {
+        double offset = (note.time - anchorWall) * AUDIO_SAMPLE_RATE + LATENCY_FRAMES;
+        int64_t target = (int64_t)anchorFrame + (int64_t)offset;
+        uint64_t frame = target > (int64_t)write ? (uint64_t)target : write;
+
+        if (engine->pendingCount == MAX_PENDING) {
+            applyNote(engine, note.note, note.velocity);
+            continue;
+        }
+        int i = engine->pendingCount++;
+        while (i > 0 && engine->pending[i - 1].frame > frame) {
+            engine->pending[i] = engine->pending[i - 1];
+            i--;
+        }
+        engine->pending[i] = (PendingNote){ frame, note.note, note.velocity };
+    }
+}
+
+// Render one block into the ring, splitting it wherever a note starts
+static void renderBlock(AudioEngine* engine, uint64_t write) {
+    float* output = &engine->ring[(write & (RING_FRAMES - 1)) * 2];
+    uint64_t frame = write;
+    uint64_t end = write + AUDIO_BUFFER_FRAMES;
+    int consumed = 0;
+    while (frame < end) {
+        while (consumed < engine->pendingCount && engine->pending[consumed].frame <= frame) {
+            applyNote(engine, engine->pending[consumed].note, engine->pending[consumed].velocity);
+            consumed++;
+        }
+        uint64_t next = end;
+        if (consumed < engine->pendingCount && engine->pending[consumed].frame < end) next = engine->pending[consumed].frame;
+        engine->instrument.render(engine->instrument.state, output, (int)(next - frame));
+        output += (next - frame) * 2;
+        frame = next;
+    }
+    engine->pendingCount -= consumed;
+    memmove(engine->pending, engine->pending + consumed, sizeof(PendingNote) * engine->pendingCount);
+}
+
+// Keeps the ring TARGET_FILL frames ahead of the device
+static void* renderThread(void* argument) {
+    AudioEngine* engine = argument;
+    raiseThreadPriority();
+
+    double blockSeconds = (double)AUDIO_BUFFER_FRAMES / AUDIO_SAMPLE_RATE;
+    float load = 0.0f;
+    while (atomic_load_explicit(&engine->running, memory_order_acquire)) {
+        uint64_t read = atomic_load_explicit(&engine->readFrame, memory_order_acquire);
+        uint64_t write = atomic_load_explicit(&engine->writeFrame, memory_order_relaxed);
+        if (write - read >= TARGET_FILL) {
+            sleepUntil(nowSeconds() + blockSeconds / 4);
+            continue;
+        }
+
+        double start = nowSeconds();
+        collectNotes(engine, write);
+        renderBlock(engine, write);
+        double effectsStart = profileBegin();
+        processEffectChain(&engine->effects, &engine->ring[(write & (RING_FRAMES - 1)) * 2], AUDIO_BUFFER_FRAMES);
+        profileEnd(PROFILE_AUDIO_EFFECTS, effectsStart);
+        atomic_store_explicit(&engine->writeFrame, write + AUDIO_BUFFER_FRAMES, memory_order_release);
+        profileEnd(PROFILE_AUDIO_RENDER, start);
+
+        load = load * 0.95f + (float)((nowSeconds() - start) / blockSeconds) * 0.05f;
+        atomic_store_explicit(&engine->loadPermille, (uint32_t)(load * 1000.0f), memory_order_relaxed);
+        atomic_store_explicit(&engine->activeVoices, engine->instrument.activeVoices(engine->instrument.state), memory_order_relaxed);
+    }
+    return NULL;
+}
+
+// Start the instrument, its effect chain and an output. The instrument is
+// the sampled piano when samplePath names an SFZ set, otherwise the synth.
+// Falls back to the null device when there is no sound card; nullDevice
+// forces it (useful for testing).
+AudioEngine* createAudioEngine(bool nullDevice, const char* samplePath) {
+    AudioEngine* engine = calloc(1, sizeof(AudioEngine));
+    if (!engine) return NULL;
+    if (!initSpscQueue(&engine->notes, sizeof(AudioNote), NOTE_QUEUE)) {
+        free(engine);
+        return NULL;
+    }
+    if (!createInstrument(&engine->instrument, samplePath, AUDIO_SAMPLE_RATE)) {
+        freeSpscQueue(&engine->notes);
+        free(engine);
+        return NULL;
+    }
+    createEffectChain(&engine->effects, AUDIO_SAMPLE_RATE);
+    publishAnchor(engine, 0, nowSeconds());
+
+    if (!nullDevice) {
+        InitAudioDevice();
+        if (!IsAudioDeviceReady()) {
+            TraceLog(LOG_WARNING, "AUDIO: No output device, using the null device");
+            nullDevice = true;
+        }
+    }
+    engine->nullDevice = nullDevice;
+
+    atomic_store(&engine->running, true);
+    if (pthread_create(&engine->renderThread, NULL, renderThread, engine) != 0) {
+        if (!nullDevice) CloseAudioDevice();
+        freeEffectChain(&engine->effects);
+        destroyInstrument(&engine->instrument);
+        freeSpscQueue(&engine->notes);
+        free(engine);
+        return NULL;
+    }
+
+    if (nullDevice) {
+        engine->deviceThreadStarted = pthread_create(&engine->deviceThread, NULL, nullDeviceThread, engine) == 0;
+        if (!engine->deviceThreadStarted) TraceLog(LOG_WARNING, "AUDIO: Failed to start the null device");
+    } else {
+        SetAudioStreamBufferSizeDefault(AUDIO_BUFFER_FRAMES);
+        engine->stream = LoadAudioStream(AUDIO_SAMPLE_RATE, 32, 2);
+        streamEngine = engine;
+        SetAudioStreamCallback(engine->stream, streamCallback);
+        PlayAudioStream(engine->stream);
+    }
+    return engine;
+}
+
+void destroyAudioEngine(AudioEngine* engine) {
+    if (!engine) return;
+    if (!engine->nullDevice) {
+        StopAudioStream(engine->stream);
+        UnloadAudioStream(engine->stream);
+        CloseAudioDevice();
+        streamEngine = NULL;
+    }
+    atomic_store(&engine->running, false);
+    pthread_join(engine->renderThread, NULL);
+    if (engine->deviceThreadStarted) pthread_join(engine->deviceThread, NULL);
+    freeEffectChain(&engine->effects);
+    destroyInstrument(&engine->instrument);
+    freeSpscQueue(&engine->notes);
+    free(engine);
+}
+
+// NoteSink for Playback: runs on the scheduler thread and only enqueues.
+// When the queue is full a note-on is dropped and counted, but a note-off
+// waits for the render thread to make room: losing it would leave the note
+// hanging.
+void audioNoteSink(void* userData, int note, int velocity, double time) {
+    AudioEngine* engine = userData;
+    AudioNote message = { time, (uint8_t)note, (uint8_t)velocity };
+    while (!spscPush(&engine->notes, &message)) {
+        if (velocity > 0 || !atomic_load_explicit(&engine->running, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&engine->droppedNotes, 1, memory_order_relaxed);
+            return;
+        }
+        spinPause();
+    }
+}
+
+void audioGetStats(AudioEngine* engine, AudioStats* stats) {
+    stats->nullDevice = engine->nullDevice;
+    stats->activeVoices = atomic_load_explicit(&engine->activeVoices, memory_order_relaxed);
+    stats->underruns = atomic_load_explicit(&engine->underruns, memory_order_relaxed);
+    stats->droppedNotes = atomic_load_explicit(&engine->droppedNotes, memory_order_relaxed);
+    stats->renderLoad = atomic_load_explicit(&engine->loadPermille, memory_order_relaxed) / 1000.0f;
+    stats->latencyMs = LATENCY_FRAMES * 1000.0f / AUDIO_SAMPLE_RATE;
+}
@@ -0,0 +1,27 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_BUFFER_FRAMES 256         // Device buffer and render block size
+
+// Snapshot of the audio engine for the UI
+typedef struct {
+    bool nullDevice;            // Output is discarded (no sound card or forced)
+    int activeVoices;           // Instrument voices currently sounding
+    uint32_t underruns;         // Device callbacks that ran out of rendered audio
+    uint32_t droppedNotes;      // Notes lost to a full note queue
+    float renderLoad;           // Render time as a fraction of real time
+    float latencyMs;            // Delay from a note's deadline to it being heard
+} AudioStats;
+
+typedef struct AudioEngine AudioEngine;
+
+AudioEngine* createAudioEngine(bool nullDevice, const char* samplePath);
+void destroyAudioEngine(AudioEngine* engine);
+void audioNoteSink(void* userData, int note, int velocity, double time);
+void audioGetStats(AudioEngine* engine, AudioStats* stats);
+
+#endif
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "reverb.h"
+#include "effects.h"
+
+static void reverbEffectProcess(void* state, float* buffer, int frames) {
+    reverbProcess(state, buffer, frames);
+}
+
+static int reverbEffectTail(const void* state) {
+    return reverbTailFrames(state);
+}
+
+static void reverbEffectDestroy(void* state) {
+    destroyReverb(state);
+}
+
+// The chain the app plays through. NOCTIVOX_REVERB names an impulse
+// response file for the convolution reverb and NOCTIVOX_REVERB_MIX sets its
+// wet share (0-1). Without them the chain is empty.
+void createEffectChain(EffectChain* chain, float sampleRate) {
+    memset(chain, 0, sizeof(*chain));
+    const char* impulsePath = getenv("NOCTIVOX_REVERB");
+    if (impulsePath && impulsePath[0]) {
+        const char* mix = getenv("NOCTIVOX_REVERB_MIX");
+        Reverb* reverb = loadReverb(impulsePath, sampleRate, mix && mix[0] ? (float)atof(mix) : REVERB_DEFAULT_MIX);
+        if (reverb) addEffect(chain, (Effect){ reverb, reverbEffectProcess, reverbEffectTail, reverbEffectDestroy });
+    }
+}
+
+// Takes ownership of the effect; a full chain destroys it and returns false
+bool addEffect(EffectChain* chain, Effect effect) {
+    if (chain->count == EFFECT_CHAIN_MAX) {
+        TraceLog(LOG_WARNING, "EFFECTS: Chain is full");
+        effect.destroy(effect.state);
+        return false;
+    }
+    chain->effects[chain->count++] = effect;
+    return true;
+}
+
+void processEffectChain(EffectChain* chain, float* buffer, int frames) {
+    for (int i = 0; i < chain->count; i++) chain->effects[i].process(chain->effects[i].state, buffer, frames);
+}
+
+// Input this far back can still be heard at the chain's output
+int effectChainTailFrames(const EffectChain* chain) {
+    int frames = 0;
+    for (int i = 0; i < chain->count; i++) frames += chain->effects[i].tailFrames(chain->effects[i].state);
+    return frames;
+}
+
+void freeEffectChain(EffectChain* chain) {
+    for (int i = 0; i < chain->count; i++) chain->effects[i].destroy(chain->effects[i].state);
+    chain->count = 0;
+}
@@ -0,0 +1,29 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <stdbool.h>
+
+#define EFFECT_CHAIN_MAX 8
+
+// Stage on the instrument's output. process runs on the render thread and
+// must not block or allocate.
+typedef struct {
+    void* state;
+    void (*process)(void* state, float* buffer, int frames);   // Interleaved stereo, in place
+    int (*tailFrames)(const void* state);                     // Past input frames still heard
+    void (*destroy)(void* state);
+} Effect;
+
+// Effects applied in order; the chain owns them
+typedef struct {
+    Effect effects[EFFECT_CHAIN_MAX];
+    int count;
+} EffectChain;
+
+void createEffectChain(EffectChain* chain, float sampleRate);
+bool addEffect(EffectChain* chain, Effect effect);
+void processEffectChain(EffectChain* chain, float* buffer, int frames);
+int effectChainTailFrames(const EffectChain* chain);
+void freeEffectChain(EffectChain* chain);
+
+#endif
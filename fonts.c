@@ -0,0 +1,359 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "fonts.h"
+
+#define METRIC_MISSING -1      // Advance of a codepoint no source has a glyph for
+
+typedef struct {
+    int codepoint;              // 0 if the slot is empty
+    int advance;                // At baseSize, or METRIC_MISSING
+} GlyphMetric;
+
+// Glyphs beyond the baked ASCII set live in a grid of cells under the ASCII
+// atlas in the same texture, so every copy of the Font keeps working as
+// cells change: the glyph and rectangle arrays are shared and their size
+// never changes. Cells are filled from the extra bake or the fallback face
+// when text first uses a codepoint, and the least recently used cell is
+// reused when the grid is full.
+typedef struct {
+    unsigned int textureId;     // 0 if unused
+    Font font;
+    const BakedFont* extra;     // Non-ASCII glyphs baked for this face (may be NULL)
+    int firstCell;              // Index of cell 0 in font.glyphs
+    int cellSize;               // Cell edge in pixels, padding included
+    int cellTop;                // Texture row where the grid starts
+    unsigned int lastUse[FONT_CACHE_CELLS];      // Frame a cell was last drawn (0 = empty)
+    GlyphMetric metrics[FONT_METRIC_SLOTS];      // Direct-mapped by codepoint
+    unsigned char* cellPixels;  // Scratch upload for one cell, gray+alpha
+} GlyphCache;
+
+static GlyphCache caches[FONT_CACHE_FONTS];
+static unsigned int glyphFrame = 1;
+
+// System font used for codepoints no baked face has, mapped on first need
+static const char* fallbackFontPaths[] = {
+#if defined(_WIN32)
+    "C:/Windows/Fonts/YuGothR.ttc",
+    "C:/Windows/Fonts/msgothic.ttc",
+    "C:/Windows/Fonts/msyh.ttc",
+    "C:/Windows/Fonts/malgun.ttf",
+    "C:/Windows/Fonts/arialuni.ttf",
+#elif defined(__APPLE__)
+    "/System/Library/Fonts/Hiragino Sans GB.ttc",
+    "/System/Library/Fonts/AppleSDGothicNeo.ttc",
+    "/Library/Fonts/Arial Unicode.ttf",
+    "/System/Library/Fonts/Supplemental/Arial Unicode.ttf",
+#else
+    "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/google-noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+#endif
+};
+
+static struct {
+    bool tried;
+    MappedFile file;
+} fallbackFace;
+
+// Codepoint at the start of text, reading at most length bytes. Malformed
+// sequences decode as '?' one byte long, as raylib draws them.
+int decodeCodepoint(const char* text, int length, int* size) {
+    const unsigned char* bytes = (const unsigned char*)text;
+    int count = 0;
+    if (bytes[0] < 0x80) count = 1;
+    else if (bytes[0] >= 0xC2 && bytes[0] < 0xE0) count = 2;
+    else if (bytes[0] >= 0xE0 && bytes[0] < 0xF0) count = 3;
+    else if (bytes[0] >= 0xF0 && bytes[0] < 0xF5) count = 4;
+    if (count > length) count = 0;
+    int codepoint = count > 1 ? bytes[0] & (0x7F >> count) : bytes[0];
+    for (int i = 1; i < count; i++) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            count = 0;
+            break;
+        }
+        codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+    }
+    if (count == 0 || (count == 3 && codepoint < 0x800) || (count == 4 && (codepoint < 0x10000 || codepoint > 0x10FFFF))) {
+        *size = 1;
+        return '?';
+    }
+    *size = count;
+    return codepoint;
+}
+
+// stb_truetype, behind LoadFontData, reads the first font of a file. For a
+// collection, copy its first font's table directory over the collection
+// header; table offsets are relative to the file, so the rest stays valid.
+static bool flattenFontCollection(MappedFile* file) {
+    unsigned char* data = (unsigned char*)file->data;
+    if (!data || file->size < 16) return false;
+    if (memcmp(data, "ttcf", 4) != 0) return true;
+    size_t offset = ((size_t)data[12] << 24) | ((size_t)data[13] << 16) | ((size_t)data[14] << 8) | data[15];
+    if (offset + 12 > file->size) return false;
+    size_t directorySize = 12 + 16 * (((size_t)data[offset + 4] << 8) | data[offset + 5]);
+    if (offset + directorySize > file->size) return false;
+    memmove(data, data + offset, directorySize);
+    return true;
+}
+
+static GlyphCache* findGlyphCache(Font font) {
+    if (font.texture.id == 0) return NULL;
+    for (int i = 0; i < FONT_CACHE_FONTS; i++) {
+        if (caches[i].textureId == font.texture.id) return &caches[i];
+    }
+    return NULL;
+}
+
+// Rasterize one codepoint from the fallback face at the cache's size. Free
+// with UnloadFontData(glyph, 1). NULL if the face lacks it.
+static GlyphInfo* rasterizeFallbackGlyph(const GlyphCache* cache, int codepoint) {
+    if (!fallbackFace.tried) {
+        fallbackFace.tried = true;
+        for (size_t i = 0; i < sizeof(fallbackFontPaths) / sizeof(fallbackFontPaths[0]); i++) {
+            if (mapFileCopyOnWrite(fallbackFontPaths[i], &fallbackFace.file) && flattenFontCollection(&fallbackFace.file)) break;
+            unmapFile(&fallbackFace.file);
+        }
+    }
+    if (!fallbackFace.file.data) return NULL;
+
+    GlyphInfo* glyph = LoadFontData(fallbackFace.file.data, (int)fallbackFace.file.size, cache->font.baseSize, &codepoint, 1, FONT_DEFAULT);
+    if (glyph && !glyph->image.data && glyph->advanceX == 0) {
+        // stb_truetype has no glyph for it
+        UnloadFontData(glyph, 1);
+        glyph = NULL;
+    }
+    return glyph;
+}
+
+// Index of codepoint in the extra bake, or -1
+static int findExtraGlyph(const BakedFont* extra, int codepoint) {
+    if (!extra) return -1;
+    int low = 0;
+    int high = extra->glyphCount - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (extra->glyphs[middle].value < codepoint) low = middle + 1;
+        else if (extra->glyphs[middle].value > codepoint) high = middle - 1;
+        else return middle;
+    }
+    return -1;
+}
+
+static int glyphAdvanceOf(const GlyphInfo* glyph, float width) {
+    return glyph->advanceX ? glyph->advanceX : (int)width + glyph->offsetX;
+}
+
+static int findCell(const GlyphCache* cache, int codepoint) {
+    const GlyphInfo* cells = cache->font.glyphs + cache->firstCell;
+    for (int i = 0; i < FONT_CACHE_CELLS; i++) {
+        if (cells[i].value == codepoint) return i;
+    }
+    return -1;
+}
+
+static GlyphMetric* findGlyphMetric(GlyphCache* cache, int codepoint) {
+    return &cache->metrics[((unsigned int)codepoint * 2654435761u) % FONT_METRIC_SLOTS];
+}
+
+// Empty cell, else the least recently used one not drawn this frame; -1 if
+// every cell is in use this frame
+static int claimCell(const GlyphCache* cache) {
+    int best = -1;
+    for (int i = 0; i < FONT_CACHE_CELLS; i++) {
+        if (cache->lastUse[i] == 0) return i;
+        if (cache->lastUse[i] != glyphFrame && (best < 0 || cache->lastUse[i] < cache->lastUse[best])) best = i;
+    }
+    return best;
+}
+
+// Put a codepoint's glyph into a cell. Returns false if no source has it or
+// no cell is free this frame.
+static bool loadGlyphCell(GlyphCache* cache, int codepoint) {
+    GlyphMetric* metric = findGlyphMetric(cache, codepoint);
+    if (metric->codepoint == codepoint && metric->advance == METRIC_MISSING) return false;
+    int cell = claimCell(cache);
+    if (cell < 0) return false;
+
+    // Coverage of the glyph, from the extra bake or the fallback face
+    GlyphInfo info = { 0 };
+    const unsigned char* coverage = NULL;
+    int stride = 0;
+    int width = 0;
+    int height = 0;
+    GlyphInfo* rasterized = NULL;
+    int extraIndex = findExtraGlyph(cache->extra, codepoint);
+    if (extraIndex >= 0) {
+        const BakedFont* extra = cache->extra;
+        Rectangle rec = extra->recs[extraIndex];
+        info = extra->glyphs[extraIndex];
+        width = (int)rec.width;
+        height = (int)rec.height;
+        stride = extra->width;
+        coverage = extra->alpha + (int)rec.y * stride + (int)rec.x;
+    } else {
+        rasterized = rasterizeFallbackGlyph(cache, codepoint);
+        if (!rasterized) {
+            metric->codepoint = codepoint;
+            metric->advance = METRIC_MISSING;
+            return false;
+        }
+        info = *rasterized;
+        width = rasterized->image.width;
+        height = rasterized->image.height;
+        stride = width;
+        coverage = rasterized->image.data;
+    }
+
+    // Clip to the cell, leaving the padding raylib samples around each glyph
+    int padding = cache->font.glyphPadding;
+    int inner = cache->cellSize - 2 * padding;
+    if (width > inner) width = inner;
+    if (height > inner) height = inner;
+    memset(cache->cellPixels, 0, cache->cellSize * cache->cellSize * 2);
+    for (int i = 0; i < cache->cellSize * cache->cellSize; i++) cache->cellPixels[i * 2] = 255;
+    for (int y = 0; y < height && coverage; y++) {
+        unsigned char* row = cache->cellPixels + ((y + padding) * cache->cellSize + padding) * 2;
+        for (int x = 0; x < width; x++) row[x * 2 + 1] = coverage[y * stride + x];
+    }
+    if (rasterized) UnloadFontData(rasterized, 1);
+
+    float cellX = (float)(cell % FONT_CACHE_COLUMNS * cache->cellSize);
+    float cellY = (float)(cache->cellTop + cell / FONT_CACHE_COLUMNS * cache->cellSize);
+    UpdateTextureRec(cache->font.texture, (Rectangle){ cellX, cellY, cache->cellSize, cache->cellSize }, cache->cellPixels);
+
+    GlyphInfo* glyph = &cache->font.glyphs[cache->firstCell + cell];
+    glyph->value = codepoint;
+    glyph->offsetX = info.offsetX;
+    glyph->offsetY = info.offsetY;
+    glyph->advanceX = info.advanceX;
+    cache->font.recs[cache->firstCell + cell] = (Rectangle){ cellX + padding, cellY + padding, width, height };
+    cache->lastUse[cell] = glyphFrame;
+    metric->codepoint = codepoint;
+    metric->advance = glyphAdvanceOf(glyph, width);
+    return true;
+}
+
+// Upload a baked atlas and copy its metrics into a Font with room for
+// FONT_CACHE_CELLS more glyphs, taken from extra or the fallback face as
+// text needs them. Release it with unloadBakedFont.
+Font loadBakedFont(const BakedFont* baked, const BakedFont* extra) {
+    GlyphCache* cache = NULL;
+    for (int i = 0; i < FONT_CACHE_FONTS && !cache; i++) {
+        if (caches[i].textureId == 0) cache = &caches[i];
+    }
+    if (!cache) return GetFontDefault();
+    memset(cache, 0, sizeof(*cache));
+
+    int cellSize = baked->baseSize * 3 / 2 + 2 * baked->glyphPadding;
+    int width = FONT_CACHE_COLUMNS * cellSize > baked->width ? FONT_CACHE_COLUMNS * cellSize : baked->width;
+    int height = baked->height + FONT_CACHE_ROWS * cellSize;
+    int glyphCount = baked->glyphCount + FONT_CACHE_CELLS;
+
+    Font font = { 0 };
+    unsigned char* grayAlpha = RL_CALLOC(width * height, 2);
+    cache->cellPixels = RL_MALLOC(cellSize * cellSize * 2);
+    font.recs = RL_CALLOC(glyphCount, sizeof(Rectangle));
+    font.glyphs = RL_CALLOC(glyphCount, sizeof(GlyphInfo));
+    if (!grayAlpha || !cache->cellPixels || !font.recs || !font.glyphs) {
+        RL_FREE(grayAlpha);
+        RL_FREE(cache->cellPixels);
+        RL_FREE(font.recs);
+        RL_FREE(font.glyphs);
+        cache->cellPixels = NULL;
+        return GetFontDefault();
+    }
+
+    for (int i = 0; i < width * height; i++) grayAlpha[i * 2] = 255;
+    for (int y = 0; y < baked->height; y++) {
+        for (int x = 0; x < baked->width; x++) grayAlpha[(y * width + x) * 2 + 1] = baked->alpha[y * baked->width + x];
+    }
+    Image atlas = { grayAlpha, width, height, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+    font.texture = LoadTextureFromImage(atlas);
+    RL_FREE(grayAlpha);
+
+    font.baseSize = baked->baseSize;
+    font.glyphPadding = baked->glyphPadding;
+    font.glyphCount = glyphCount;
+    memcpy(font.recs, baked->recs, baked->glyphCount * sizeof(Rectangle));
+    memcpy(font.glyphs, baked->glyphs, baked->glyphCount * sizeof(GlyphInfo));
+    for (int i = baked->glyphCount; i < glyphCount; i++) font.glyphs[i].value = -1;
+
+    cache->textureId = font.texture.id;
+    cache->font = font;
+    cache->extra = extra;
+    cache->firstCell = baked->glyphCount;
+    cache->cellSize = cellSize;
+    cache->cellTop = baked->height;
+    return font;
+}
+
+void unloadBakedFont(Font font) {
+    GlyphCache* cache = findGlyphCache(font);
+    if (cache) {
+        RL_FREE(cache->cellPixels);
+        memset(cache, 0, sizeof(*cache));
+    }
+    UnloadFont(font);
+}
+
+// Start a new frame for cell reuse. Cells drawn in the current frame are
+// never reused, because their quads may still be waiting in raylib's batch.
+void nextGlyphFrame(void) {
+    glyphFrame++;
+    if (glyphFrame == 0) glyphFrame = 1;
+}
+
+// Make sure every codepoint of text has a cell before it is drawn, and mark
+// the cells as used this frame. Codepoints left without one draw as '?'.
+void useFontGlyphs(Font font, const char* text, int length) {
+    GlyphCache* cache = NULL;
+    for (int i = 0; i < length; ) {
+        if ((unsigned char)text[i] < 0x80) {
+            i++;
+            continue;
+        }
+        int size = 1;
+        int codepoint = decodeCodepoint(text + i, length - i, &size);
+        i += size;
+        if (!cache && !(cache = findGlyphCache(font))) return;
+        int cell = findCell(cache, codepoint);
+        if (cell >= 0) cache->lastUse[cell] = glyphFrame;
+        else loadGlyphCell(cache, codepoint);
+    }
+}
+
+// Pen advance of a codepoint at the font's base size, whether or not it has
+// a cell right now, or -1 if no source has a glyph for it
+int fontGlyphAdvance(Font font, int codepoint) {
+    GlyphCache* cache = findGlyphCache(font);
+    if (!cache || codepoint < 0x80) {
+        int index = GetGlyphIndex(font, codepoint);
+        if (font.glyphs[index].value != codepoint) return -1;
+        return glyphAdvanceOf(&font.glyphs[index], font.recs[index].width);
+    }
+
+    int cell = findCell(cache, codepoint);
+    if (cell >= 0) return glyphAdvanceOf(&cache->font.glyphs[cache->firstCell + cell], cache->font.recs[cache->firstCell + cell].width);
+    GlyphMetric* metric = findGlyphMetric(cache, codepoint);
+    if (metric->codepoint == codepoint) return metric->advance;
+
+    int advance = METRIC_MISSING;
+    int extraIndex = findExtraGlyph(cache->extra, codepoint);
+    if (extraIndex >= 0) {
+        advance = glyphAdvanceOf(&cache->extra->glyphs[extraIndex], cache->extra->recs[extraIndex].width);
+    } else {
+        GlyphInfo* glyph = rasterizeFallbackGlyph(cache, codepoint);
+        if (glyph) {
+            advance = glyphAdvanceOf(glyph, glyph->image.width);
+            UnloadFontData(glyph, 1);
+        }
+    }
+    metric->codepoint = codepoint;
+    metric->advance = advance;
+    return advance;
+}
@@ -0,0 +1,32 @@
+#ifndef FONTS_H
+#define FONTS_H
+
+#include "raylib.h"
+
+#define FONT_CACHE_COLUMNS 16       // Grid of glyph cells filled on first use
+#define FONT_CACHE_ROWS 8
+#define FONT_CACHE_CELLS (FONT_CACHE_COLUMNS * FONT_CACHE_ROWS)
+#define FONT_CACHE_FONTS 8          // Baked fonts loaded at once
+#define FONT_METRIC_SLOTS 1024      // Remembered advances of glyphs not in a cell
+
+// A font rasterized at build time by tools/bakefonts.c. The atlas is stored
+// as one coverage byte per pixel; the glyph metrics are raylib's own.
+typedef struct {
+    int baseSize;               // Pixel size it was rasterized at
+    int glyphPadding;
+    int width;                  // Atlas size
+    int height;
+    int glyphCount;
+    const unsigned char* alpha; // width*height coverage bytes
+    const Rectangle* recs;      // Glyph rectangles in the atlas
+    const GlyphInfo* glyphs;    // Codepoints (ascending in extra sets) and metrics, no images
+} BakedFont;
+
+Font loadBakedFont(const BakedFont* baked, const BakedFont* extra);
+void unloadBakedFont(Font font);
+void nextGlyphFrame(void);
+void useFontGlyphs(Font font, const char* text, int length);
+int fontGlyphAdvance(Font font, int codepoint);
+int decodeCodepoint(const char* text, int length, int* size);
+
+#endif
@@ -0,0 +1,409 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "inputlog.h"
+
+#define LOG_MAGIC "NVXI"
+#define LOG_VERSION 1u
+#define LOG_BYTE_ORDER 0x01020304u      // Logs are replayed on the machine type that recorded them
+
+#define INPUT_KEY_COUNT 352             // Key codes up to KEY_KB_MENU
+#define INPUT_KEY_BYTES (INPUT_KEY_COUNT / 8)
+#define INPUT_BUTTON_COUNT 7            // MOUSE_BUTTON_LEFT through MOUSE_BUTTON_BACK
+#define INPUT_MAX_CHARS 32              // raylib queues at most 16 a frame
+#define INPUT_MAX_DROPPED 16
+#define CLIPBOARD_NULL 0xFFFFFFFFu      // Stored length when raylib returned no clipboard text
+
+// Sections present in a frame record, after its frame time
+enum {
+    FRAME_MOUSE = 1 << 0,       // float x, y; the position changed
+    FRAME_WHEEL = 1 << 1,       // float wheel move, when nonzero
+    FRAME_BUTTONS = 1 << 2,     // uint8 mask of held mouse buttons, when it changed
+    FRAME_KEYS = 1 << 3,        // uint16 count, then a uint16 per key pressed or released
+    FRAME_CHARS = 1 << 4,       // uint8 count, then a int32 per typed codepoint
+    FRAME_CLIPBOARD = 1 << 5,   // uint32 length, then the text the UI read this frame
+    FRAME_DROPPED = 1 << 6      // uint8 count, then per path a uint16 length and the path
+};
+
+typedef enum {
+    INPUT_LIVE,
+    INPUT_RECORD,
+    INPUT_REPLAY
+} InputMode;
+
+// Everything the UI can ask about one frame
+typedef struct {
+    float frameTime;
+    Vector2 mouse;
+    float wheel;
+    uint8_t buttons;                    // Bit per held mouse button
+    uint8_t keys[INPUT_KEY_BYTES];      // Bit per held key
+    int chars[INPUT_MAX_CHARS];
+    int charCount;
+    bool clipboardRead;                 // The clipboard was asked for this frame
+    bool clipboardNull;
+    char* clipboard;                    // Terminated copy of what it held
+    int clipboardCapacity;
+    char* dropped[INPUT_MAX_DROPPED];
+    int droppedCount;
+} InputFrame;
+
+static InputMode mode = INPUT_LIVE;
+static FILE* logFile;
+static InputFrame frame;
+static uint8_t previousKeys[INPUT_KEY_BYTES];
+static uint8_t previousButtons;
+static Vector2 previousMouse;
+static bool framePending;               // Recording: the current frame is not yet written
+static int nextChar;                    // Next of frame.chars for inputCharPressed
+
+// Replay frame-time capture
+static double frameStarted;
+static float* frameTimes;               // Milliseconds from beginInputFrame to endInputFrame
+static int frameTimeCount;
+static int frameTimeCapacity;
+static char* frameTimesPath;
+
+static bool bitSet(const uint8_t* bits, int index) {
+    return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static bool writeBytes(const void* data, size_t size) {
+    return fwrite(data, 1, size, logFile) == size;
+}
+
+static bool readBytes(void* data, size_t size) {
+    return fread(data, 1, size, logFile) == size;
+}
+
+static bool reserveClipboard(int length) {
+    if (length + 1 <= frame.clipboardCapacity) return true;
+    char* clipboard = realloc(frame.clipboard, length + 1);
+    if (!clipboard) return false;
+    frame.clipboard = clipboard;
+    frame.clipboardCapacity = length + 1;
+    return true;
+}
+
+static void clearDropped(void) {
+    for (int i = 0; i < frame.droppedCount; i++) free(frame.dropped[i]);
+    frame.droppedCount = 0;
+}
+
+static void pollFrame(void) {
+    frame.frameTime = GetFrameTime();
+    frame.mouse = GetMousePosition();
+    frame.wheel = GetMouseWheelMove();
+    frame.buttons = 0;
+    for (int button = 0; button < INPUT_BUTTON_COUNT; button++) {
+        if (IsMouseButtonDown(button)) frame.buttons |= 1 << button;
+    }
+    memset(frame.keys, 0, sizeof(frame.keys));
+    for (int key = 1; key < INPUT_KEY_COUNT; key++) {
+        if (IsKeyDown(key)) frame.keys[key / 8] |= 1 << (key % 8);
+    }
+    for (int c = GetCharPressed(); c > 0; c = GetCharPressed()) {
+        if (frame.charCount < INPUT_MAX_CHARS) frame.chars[frame.charCount++] = c;
+    }
+    if (IsFileDropped()) {
+        FilePathList dropped = LoadDroppedFiles();
+        for (unsigned int i = 0; i < dropped.count && frame.droppedCount < INPUT_MAX_DROPPED; i++) {
+            char* path = strdup(dropped.paths[i]);
+            if (path) frame.dropped[frame.droppedCount++] = path;
+        }
+        UnloadDroppedFiles(dropped);
+    }
+}
+
+// Write the frame just finished, once the UI is done asking about it, so a
+// clipboard it read is included
+static bool writeFrame(void) {
+    uint16_t toggled[INPUT_KEY_COUNT];
+    uint16_t toggledCount = 0;
+    for (int key = 1; key < INPUT_KEY_COUNT; key++) {
+        if (bitSet(frame.keys, key) != bitSet(previousKeys, key)) toggled[toggledCount++] = (uint16_t)key;
+    }
+
+    uint8_t flags = 0;
+    if (frame.mouse.x != previousMouse.x || frame.mouse.y != previousMouse.y) flags |= FRAME_MOUSE;
+    if (frame.wheel != 0) flags |= FRAME_WHEEL;
+    if (frame.buttons != previousButtons) flags |= FRAME_BUTTONS;
+    if (toggledCount > 0) flags |= FRAME_KEYS;
+    if (frame.charCount > 0) flags |= FRAME_CHARS;
+    if (frame.clipboardRead) flags |= FRAME_CLIPBOARD;
+    if (frame.droppedCount > 0) flags |= FRAME_DROPPED;
+
+    bool ok = writeBytes(&flags, 1) && writeBytes(&frame.frameTime, sizeof(float));
+    if (ok && (flags & FRAME_MOUSE)) ok = writeBytes(&frame.mouse.x, sizeof(float)) && writeBytes(&frame.mouse.y, sizeof(float));
+    if (ok && (flags & FRAME_WHEEL)) ok = writeBytes(&frame.wheel, sizeof(float));
+    if (ok && (flags & FRAME_BUTTONS)) ok = writeBytes(&frame.buttons, 1);
+    if (ok && (flags & FRAME_KEYS)) ok = writeBytes(&toggledCount, sizeof(uint16_t)) && writeBytes(toggled, sizeof(uint16_t) * toggledCount);
+    if (ok && (flags & FRAME_CHARS)) {
+        uint8_t count = (uint8_t)frame.charCount;
+        int32_t chars[INPUT_MAX_CHARS];
+        for (int i = 0; i < count; i++) chars[i] = frame.chars[i];
+        ok = writeBytes(&count, 1) && writeBytes(chars, sizeof(int32_t) * count);
+    }
+    if (ok && (flags & FRAME_CLIPBOARD)) {
+        uint32_t length = frame.clipboardNull ? CLIPBOARD_NULL : (uint32_t)strlen(frame.clipboard);
+        ok = writeBytes(&length, sizeof(uint32_t)) && (frame.clipboardNull || writeBytes(frame.clipboard, length));
+    }
+    if (ok && (flags & FRAME_DROPPED)) {
+        uint8_t count = (uint8_t)frame.droppedCount;
+        ok = writeBytes(&count, 1);
+        for (int i = 0; ok && i < count; i++) {
+            uint16_t length = (uint16_t)strlen(frame.dropped[i]);
+            ok = writeBytes(&length, sizeof(uint16_t)) && writeBytes(frame.dropped[i], length);
+        }
+    }
+    return ok;
+}
+
+// Read the next frame record over the previous frame's state. False at the
+// end of the log or on a damaged record.
+static bool readFrame(void) {
+    uint8_t flags;
+    if (!readBytes(&flags, 1) || !readBytes(&frame.frameTime, sizeof(float))) return false;
+    frame.wheel = 0;
+    if ((flags & FRAME_MOUSE) && !(readBytes(&frame.mouse.x, sizeof(float)) && readBytes(&frame.mouse.y, sizeof(float)))) return false;
+    if ((flags & FRAME_WHEEL) && !readBytes(&frame.wheel, sizeof(float))) return false;
+    if ((flags & FRAME_BUTTONS) && !readBytes(&frame.buttons, 1)) return false;
+    if (flags & FRAME_KEYS) {
+        uint16_t count;
+        if (!readBytes(&count, sizeof(uint16_t))) return false;
+        for (int i = 0; i < count; i++) {
+            uint16_t key;
+            if (!readBytes(&key, sizeof(uint16_t)) || key >= INPUT_KEY_COUNT) return false;
+            frame.keys[key / 8] ^= 1 << (key % 8);
+        }
+    }
+    if (flags & FRAME_CHARS) {
+        uint8_t count;
+        if (!readBytes(&count, 1) || count > INPUT_MAX_CHARS) return false;
+        for (int i = 0; i < count; i++) {
+            int32_t c;
+            if (!readBytes(&c, sizeof(int32_t))) return false;
+            frame.chars[frame.charCount++] = c;
+        }
+    }
+    if (flags & FRAME_CLIPBOARD) {
+        uint32_t length;
+        if (!readBytes(&length, sizeof(uint32_t))) return false;
+        frame.clipboardRead = true;
+        frame.clipboardNull = length == CLIPBOARD_NULL;
+        if (!frame.clipboardNull) {
+            if (length > INT32_MAX - 1 || !reserveClipboard((int)length) || !readBytes(frame.clipboard, length)) return false;
+            frame.clipboard[length] = '\0';
+        }
+    }
+    if (flags & FRAME_DROPPED) {
+        uint8_t count;
+        if (!readBytes(&count, 1) || count > INPUT_MAX_DROPPED) return false;
+        for (int i = 0; i < count; i++) {
+            uint16_t length;
+            if (!readBytes(&length, sizeof(uint16_t))) return false;
+            char* path = malloc(length + 1);
+            if (!path) return false;
+            frame.dropped[frame.droppedCount++] = path;
+            if (!readBytes(path, length)) return false;
+            path[length] = '\0';
+        }
+    }
+    return true;
+}
+
+static bool openLog(const char* path, bool writing) {
+    logFile = fopen(path, writing ? "wb" : "rb");
+    if (!logFile) {
+        TraceLog(LOG_ERROR, "INPUT: Failed to open %s", path);
+        return false;
+    }
+    uint32_t version = LOG_VERSION;
+    uint32_t byteOrder = LOG_BYTE_ORDER;
+    char magic[4];
+    bool ok;
+    if (writing) {
+        ok = writeBytes(LOG_MAGIC, 4) && writeBytes(&version, sizeof(uint32_t)) && writeBytes(&byteOrder, sizeof(uint32_t));
+    } else {
+        ok = readBytes(magic, 4) && readBytes(&version, sizeof(uint32_t)) && readBytes(&byteOrder, sizeof(uint32_t)) &&
+             memcmp(magic, LOG_MAGIC, 4) == 0 && version == LOG_VERSION && byteOrder == LOG_BYTE_ORDER;
+    }
+    if (!ok) {
+        TraceLog(LOG_ERROR, "INPUT: %s is not an input log this build can %s", path, writing ? "write" : "read");
+        fclose(logFile);
+        logFile = NULL;
+        return false;
+    }
+
+    // Both ends of a log start from nothing held and the mouse at the origin
+    memset(frame.keys, 0, sizeof(frame.keys));
+    frame.buttons = 0;
+    frame.mouse = (Vector2){ 0, 0 };
+    return true;
+}
+
+// Record every frame's input to path until stopInputLog
+bool startInputRecording(const char* path) {
+    if (!openLog(path, true)) return false;
+    mode = INPUT_RECORD;
+    TraceLog(LOG_INFO, "INPUT: Recording to %s", path);
+    return true;
+}
+
+// Take input from a recorded log instead of raylib. Each replayed frame
+// reports the recorded frame time, so timers advance as they did in the
+// recording however fast frames run. The time each frame took is written
+// to frameTimesPath as CSV when the replay stops (NULL to skip).
+bool startInputReplay(const char* path, const char* frameTimesCsv) {
+    if (!openLog(path, false)) return false;
+    mode = INPUT_REPLAY;
+    frameTimesPath = frameTimesCsv ? strdup(frameTimesCsv) : NULL;
+    TraceLog(LOG_INFO, "INPUT: Replaying %s", path);
+    return true;
+}
+
+bool inputReplaying(void) {
+    return mode == INPUT_REPLAY;
+}
+
+static int compareFloats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void writeFrameTimes(void) {
+    if (frameTimeCount == 0) return;
+    if (frameTimesPath) {
+        FILE* file = fopen(frameTimesPath, "w");
+        if (file) {
+            fprintf(file, "frame,frame_ms\n");
+            for (int i = 0; i < frameTimeCount; i++) fprintf(file, "%d,%.4f\n", i, frameTimes[i]);
+            fclose(file);
+        } else {
+            TraceLog(LOG_ERROR, "INPUT: Failed to write frame times to %s", frameTimesPath);
+        }
+    }
+    qsort(frameTimes, frameTimeCount, sizeof(float), compareFloats);
+    TraceLog(LOG_INFO, "INPUT: Replayed %d frames, p50 %.3f ms, p99 %.3f ms, max %.3f ms", frameTimeCount,
+             frameTimes[(frameTimeCount + 1) / 2 - 1], frameTimes[(frameTimeCount * 99 + 99) / 100 - 1],
+             frameTimes[frameTimeCount - 1]);
+}
+
+// Finish the recording or replay and go back to live input
+void stopInputLog(void) {
+    if (mode == INPUT_RECORD && framePending && !writeFrame()) TraceLog(LOG_WARNING, "INPUT: Failed to write the last frame");
+    if (mode == INPUT_REPLAY) writeFrameTimes();
+    if (logFile) fclose(logFile);
+    logFile = NULL;
+    mode = INPUT_LIVE;
+    framePending = false;
+    free(frameTimes);
+    frameTimes = NULL;
+    frameTimeCount = frameTimeCapacity = 0;
+    free(frameTimesPath);
+    frameTimesPath = NULL;
+    clearDropped();
+    free(frame.clipboard);
+    frame.clipboard = NULL;
+    frame.clipboardCapacity = 0;
+}
+
+// Take this frame's input. Call once at the top of the frame; false when a
+// replay has run out of frames.
+bool beginInputFrame(void) {
+    if (mode == INPUT_RECORD && framePending && !writeFrame()) {
+        TraceLog(LOG_WARNING, "INPUT: Failed to write the input log, recording stopped");
+        stopInputLog();
+    }
+    memcpy(previousKeys, frame.keys, sizeof(previousKeys));
+    previousButtons = frame.buttons;
+    previousMouse = frame.mouse;
+    frame.charCount = 0;
+    frame.clipboardRead = false;
+    clearDropped();
+    nextChar = 0;
+
+    if (mode == INPUT_REPLAY) {
+        if (!readFrame()) return false;
+    } else {
+        pollFrame();
+    }
+    framePending = mode == INPUT_RECORD;
+    frameStarted = nowSeconds();
+    return true;
+}
+
+// End of the frame's work; replays keep its duration
+void endInputFrame(void) {
+    if (mode != INPUT_REPLAY) return;
+    if (frameTimeCount == frameTimeCapacity) {
+        int capacity = frameTimeCapacity ? frameTimeCapacity * 2 : 4096;
+        float* times = realloc(frameTimes, sizeof(float) * capacity);
+        if (!times) return;
+        frameTimes = times;
+        frameTimeCapacity = capacity;
+    }
+    frameTimes[frameTimeCount++] = (float)((nowSeconds() - frameStarted) * 1000.0);
+}
+
+Vector2 inputMousePosition(void) {
+    return frame.mouse;
+}
+
+float inputMouseWheelMove(void) {
+    return frame.wheel;
+}
+
+bool inputMouseButtonPressed(int button) {
+    return button >= 0 && button < INPUT_BUTTON_COUNT && (frame.buttons >> button & 1) && !(previousButtons >> button & 1);
+}
+
+bool inputMouseButtonDown(int button) {
+    return button >= 0 && button < INPUT_BUTTON_COUNT && (frame.buttons >> button & 1);
+}
+
+bool inputKeyPressed(int key) {
+    return key > 0 && key < INPUT_KEY_COUNT && bitSet(frame.keys, key) && !bitSet(previousKeys, key);
+}
+
+bool inputKeyDown(int key) {
+    return key > 0 && key < INPUT_KEY_COUNT && bitSet(frame.keys, key);
+}
+
+bool inputKeyReleased(int key) {
+    return key > 0 && key < INPUT_KEY_COUNT && !bitSet(frame.keys, key) && bitSet(previousKeys, key);
+}
+
+// Next typed codepoint of the frame, 0 when there are no more
+int inputCharPressed(void) {
+    return nextChar < frame.charCount ? frame.chars[nextChar++] : 0;
+}
+
+float inputFrameTime(void) {
+    return frame.frameTime;
+}
+
+// Clipboard text, read from the system at most once a frame. Valid until
+// the next frame.
+const char* inputClipboardText(void) {
+    if (!frame.clipboardRead && mode != INPUT_REPLAY) {
+        const char* text = GetClipboardText();
+        int length = text ? (int)strlen(text) : 0;
+        frame.clipboardRead = true;
+        frame.clipboardNull = !text || !reserveClipboard(length);
+        if (!frame.clipboardNull) memcpy(frame.clipboard, text, length + 1);
+    }
+    return frame.clipboardRead && !frame.clipboardNull ? frame.clipboard : NULL;
+}
+
+bool inputFileDropped(void) {
+    return frame.droppedCount > 0;
+}
+
+// Paths dropped on the window this frame, owned by the input log
+FilePathList inputDroppedFiles(void) {
+    return (FilePathList){ (unsigned int)frame.droppedCount, (unsigned int)frame.droppedCount, frame.dropped };
+}
@@ -0,0 +1,31 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <stdbool.h>
+#include "raylib.h"
+
+// Per-frame input, polled from raylib once at the start of each frame and
+// optionally recorded to a log, or read back from one instead. The UI reads
+// input only through these calls, so a replayed log drives it exactly as
+// the recorded session did.
+bool startInputRecording(const char* path);
+bool startInputReplay(const char* path, const char* frameTimesPath);
+void stopInputLog(void);
+bool inputReplaying(void);
+bool beginInputFrame(void);
+void endInputFrame(void);
+
+Vector2 inputMousePosition(void);
+float inputMouseWheelMove(void);
+bool inputMouseButtonPressed(int button);
+bool inputMouseButtonDown(int button);
+bool inputKeyPressed(int key);
+bool inputKeyDown(int key);
+bool inputKeyReleased(int key);
+int inputCharPressed(void);
+float inputFrameTime(void);
+const char* inputClipboardText(void);
+bool inputFileDropped(void);
+FilePathList inputDroppedFiles(void);
+
+#endif
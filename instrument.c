@@ -0,0 +1,77 @@
+#include <stdlib.h>
+#include "raylib.h"
+#include "synth.h"
+#include "sampler.h"
+#include "instrument.h"
+
+static void synthInstrumentNoteOn(void* state, int note, int velocity) {
+    synthNoteOn(state, note, velocity);
+}
+
+static void synthInstrumentNoteOff(void* state, int note) {
+    synthNoteOff(state, note);
+}
+
+static void synthInstrumentAllNotesOff(void* state) {
+    synthAllNotesOff(state);
+}
+
+static void synthInstrumentRender(void* state, float* output, int frames) {
+    synthRender(state, output, frames);
+}
+
+static int synthInstrumentVoices(void* state) {
+    return ((Synth*)state)->activeVoices;
+}
+
+static void samplerInstrumentNoteOn(void* state, int note, int velocity) {
+    samplerNoteOn(state, note, velocity);
+}
+
+static void samplerInstrumentNoteOff(void* state, int note) {
+    samplerNoteOff(state, note);
+}
+
+static void samplerInstrumentAllNotesOff(void* state) {
+    samplerAllNotesOff(state);
+}
+
+static void samplerInstrumentRender(void* state, float* output, int frames) {
+    samplerRender(state, output, frames);
+}
+
+static int samplerInstrumentVoices(void* state) {
+    return samplerActiveVoices(state);
+}
+
+static void samplerInstrumentDestroy(void* state) {
+    destroySampler(state);
+}
+
+// The sampled piano when samplePath names a loadable SFZ set, otherwise the
+// synth. NOCTIVOX_PIANO_BUDGET sets the sampler's memory budget in MB.
+bool createInstrument(Instrument* instrument, const char* samplePath, float sampleRate) {
+    if (samplePath && samplePath[0]) {
+        const char* budget = getenv("NOCTIVOX_PIANO_BUDGET");
+        size_t megabytes = budget && atoi(budget) > 0 ? (size_t)atoi(budget) : SAMPLER_DEFAULT_BUDGET_MB;
+        Sampler* sampler = createSampler(samplePath, sampleRate, megabytes << 20);
+        if (sampler) {
+            *instrument = (Instrument){ sampler, samplerInstrumentNoteOn, samplerInstrumentNoteOff, samplerInstrumentAllNotesOff,
+                                        samplerInstrumentRender, samplerInstrumentVoices, samplerInstrumentDestroy };
+            return true;
+        }
+        TraceLog(LOG_WARNING, "AUDIO: Falling back to the synth");
+    }
+
+    Synth* synth = malloc(sizeof(Synth));
+    if (!synth) return false;
+    initSynth(synth, sampleRate);
+    *instrument = (Instrument){ synth, synthInstrumentNoteOn, synthInstrumentNoteOff, synthInstrumentAllNotesOff,
+                                synthInstrumentRender, synthInstrumentVoices, free };
+    return true;
+}
+
+void destroyInstrument(Instrument* instrument) {
+    if (instrument->state) instrument->destroy(instrument->state);
+    instrument->state = NULL;
+}
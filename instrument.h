@@ -0,0 +1,21 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdbool.h>
+
+// Sound source the audio engine plays notes on. All calls but create and
+// destroy come from the render thread and must not block or allocate.
+typedef struct {
+    void* state;
+    void (*noteOn)(void* state, int note, int velocity);
+    void (*noteOff)(void* state, int note);
+    void (*allNotesOff)(void* state);
+    void (*render)(void* state, float* output, int frames);     // Interleaved stereo, overwrites output
+    int (*activeVoices)(void* state);
+    void (*destroy)(void* state);
+} Instrument;
+
+bool createInstrument(Instrument* instrument, const char* samplePath, float sampleRate);
+void destroyInstrument(Instrument* instrument);
+
+#endif
@@ -0,0 +1,374 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Index of the first '"' or '\\' in data[position, size), or size
+static size_t findQuoteOrBackslash(const char* data, size_t position, size_t size) {
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; position + 16 <= size; position += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + position));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask) return position + __builtin_ctz(mask);
+    }
+#endif
+    while (position < size && data[position] != '"' && data[position] != '\\') position++;
+    return position;
+}
+
+// Index of the first byte a JSON string must escape ('"', '\\' or a control
+// character) in data[position, size), or size
+static size_t findEscapable(const char* data, size_t position, size_t size) {
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    for (; position + 16 <= size; position += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + position));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)); // unsigned <= 0x1f
+        int mask = _mm_movemask_epi8(special);
+        if (mask) return position + __builtin_ctz(mask);
+    }
+#endif
+    for (; position < size; position++) {
+        unsigned char c = (unsigned char)data[position];
+        if (c == '"' || c == '\\' || c < 0x20) break;
+    }
+    return position;
+}
+
+void jsonReaderInit(JsonReader* reader, const char* data, size_t size) {
+    reader->data = data;
+    reader->size = data ? size : 0;
+    reader->position = 0;
+    reader->error = false;
+}
+
+static void skipWhitespace(JsonReader* reader) {
+    while (reader->position < reader->size) {
+        char c = reader->data[reader->position];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        reader->position++;
+    }
+}
+
+// Consume an expected character after optional whitespace
+static bool expect(JsonReader* reader, char c) {
+    skipWhitespace(reader);
+    if (reader->error || reader->position >= reader->size || reader->data[reader->position] != c) {
+        reader->error = true;
+        return false;
+    }
+    reader->position++;
+    return true;
+}
+
+// Find the closing quote of the string whose body starts at position.
+// Returns its index, or size if the string is unterminated.
+static size_t findStringEnd(const char* data, size_t position, size_t size) {
+    while ((position = findQuoteOrBackslash(data, position, size)) < size) {
+        if (data[position] == '"') return position;
+        position += 2; // Skip the escaped character
+    }
+    return size;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Read the 4 hex digits of a \u escape, or -1
+static int readHex4(const char* text, const char* end) {
+    if (end - text < 4) return -1;
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hexDigit(text[i]);
+        if (digit < 0) return -1;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+static int encodeUtf8(uint32_t codepoint, char* out) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xc0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3f));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xe0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (codepoint & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (codepoint & 0x3f));
+    return 4;
+}
+
+// Unescape body[0, length) into out, which has room for length bytes (an
+// escape never expands). Returns the unescaped length.
+static size_t unescape(const char* body, size_t length, char* out) {
+    size_t written = 0;
+    size_t position = 0;
+    while (position < length) {
+        size_t next = findQuoteOrBackslash(body, position, length);
+        memcpy(out + written, body + position, next - position);
+        written += next - position;
+        if (next >= length) break;
+        if (body[next] == '"' || next + 1 >= length) { // Stray quote or trailing backslash: keep it
+            out[written++] = body[next];
+            position = next + 1;
+            continue;
+        }
+        char c = body[next + 1];
+        position = next + 2;
+        switch (c) {
+            case 'n': out[written++] = '\n'; break;
+            case 't': out[written++] = '\t'; break;
+            case 'r': out[written++] = '\r'; break;
+            case 'b': out[written++] = '\b'; break;
+            case 'f': out[written++] = '\f'; break;
+            case 'u': {
+                int unit = readHex4(body + position, body + length);
+                if (unit < 0) {
+                    out[written++] = 'u';
+                    break;
+                }
+                position += 4;
+                uint32_t codepoint = (uint32_t)unit;
+                if (unit >= 0xd800 && unit <= 0xdbff && position + 6 <= length &&
+                    body[position] == '\\' && body[position + 1] == 'u') {
+                    int low = readHex4(body + position + 2, body + length);
+                    if (low >= 0xdc00 && low <= 0xdfff) {
+                        codepoint = 0x10000 + (((uint32_t)unit - 0xd800) << 10) + ((uint32_t)low - 0xdc00);
+                        position += 6;
+                    }
+                }
+                if (codepoint >= 0xd800 && codepoint <= 0xdfff) codepoint = 0xfffd; // Lone surrogate
+                written += encodeUtf8(codepoint, out + written);
+                break;
+            }
+            default: out[written++] = c; break; // \" \\ \/ and anything unknown
+        }
+    }
+    return written;
+}
+
+bool jsonIsString(JsonReader* reader) {
+    skipWhitespace(reader);
+    return !reader->error && reader->position < reader->size && reader->data[reader->position] == '"';
+}
+
+// Read a string value, unescaped and NUL-terminated (caller frees)
+char* jsonReadString(JsonReader* reader, int* length) {
+    if (!expect(reader, '"')) return NULL;
+    size_t start = reader->position;
+    size_t end = findStringEnd(reader->data, start, reader->size);
+    if (end >= reader->size) {
+        reader->error = true;
+        return NULL;
+    }
+    reader->position = end + 1;
+
+    char* value = malloc(end - start + 1);
+    if (!value) {
+        reader->error = true;
+        return NULL;
+    }
+    size_t written = unescape(reader->data + start, end - start, value);
+    value[written] = '\0';
+    if (length) *length = (int)written;
+    return value;
+}
+
+bool jsonReadNumber(JsonReader* reader, double* value) {
+    skipWhitespace(reader);
+    if (reader->error) return false;
+    char text[64];
+    size_t length = 0;
+    while (reader->position + length < reader->size && length < sizeof(text) - 1) {
+        char c = reader->data[reader->position + length];
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+        text[length++] = c;
+    }
+    text[length] = '\0';
+    char* end;
+    *value = strtod(text, &end);
+    if (length == 0 || end != text + length) {
+        reader->error = true;
+        return false;
+    }
+    reader->position += length;
+    return true;
+}
+
+bool jsonBeginObject(JsonReader* reader) {
+    return expect(reader, '{');
+}
+
+// Advance to the next member of the current object and read its key
+// (truncated to keySize). Returns false at the closing brace or on error.
+bool jsonNextMember(JsonReader* reader, char* key, size_t keySize) {
+    skipWhitespace(reader);
+    if (reader->error || reader->position >= reader->size) {
+        reader->error = true;
+        return false;
+    }
+    if (reader->data[reader->position] == ',') {
+        reader->position++;
+        skipWhitespace(reader);
+    }
+    if (reader->position < reader->size && reader->data[reader->position] == '}') {
+        reader->position++;
+        return false;
+    }
+
+    int length;
+    char* name = jsonReadString(reader, &length);
+    if (!name) return false;
+    snprintf(key, keySize, "%s", name);
+    free(name);
+    return expect(reader, ':');
+}
+
+// Skip one value of any type, including nested objects and arrays
+void jsonSkipValue(JsonReader* reader) {
+    skipWhitespace(reader);
+    int depth = 0;
+    while (!reader->error && reader->position < reader->size) {
+        char c = reader->data[reader->position];
+        if (c == '"') {
+            size_t end = findStringEnd(reader->data, reader->position + 1, reader->size);
+            if (end >= reader->size) reader->error = true;
+            reader->position = end + 1;
+        } else if (c == '{' || c == '[') {
+            depth++;
+            reader->position++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) return; // End of the enclosing container
+            depth--;
+            reader->position++;
+        } else if (c == ',' && depth == 0) {
+            return;
+        } else {
+            reader->position++;
+        }
+        if (depth == 0 && (c == '"' || c == '}' || c == ']')) return;
+    }
+}
+
+bool jsonWriterInit(JsonWriter* writer, FILE* file) {
+    memset(writer, 0, sizeof(*writer));
+    writer->file = file;
+    writer->buffer = malloc(JSON_WRITER_BUFFER);
+    writer->error = !file || !writer->buffer;
+    return !writer->error;
+}
+
+static void flushWriter(JsonWriter* writer) {
+    if (writer->length && !writer->error && fwrite(writer->buffer, 1, writer->length, writer->file) != writer->length) {
+        writer->error = true;
+    }
+    writer->length = 0;
+}
+
+void jsonWriteRaw(JsonWriter* writer, const char* text, size_t length) {
+    if (writer->error) return;
+    if (writer->length + length > JSON_WRITER_BUFFER) {
+        flushWriter(writer);
+        if (length >= JSON_WRITER_BUFFER) {
+            // Large runs go straight to the file
+            if (fwrite(text, 1, length, writer->file) != length) writer->error = true;
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->length, text, length);
+    writer->length += length;
+}
+
+// Write a string value, escaping only what JSON requires and copying the
+// runs in between in bulk
+void jsonWriteString(JsonWriter* writer, const char* value, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    jsonWriteRaw(writer, "\"", 1);
+    size_t position = 0;
+    while (position < length) {
+        size_t next = findEscapable(value, position, length);
+        jsonWriteRaw(writer, value + position, next - position);
+        if (next >= length) break;
+        unsigned char c = (unsigned char)value[next];
+        char escape[6] = { '\\', 0 };
+        size_t escapeLength = 2;
+        switch (c) {
+            case '"': escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            default:
+                memcpy(escape + 1, "u00", 3);
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 15];
+                escapeLength = 6;
+                break;
+        }
+        jsonWriteRaw(writer, escape, escapeLength);
+        position = next + 1;
+    }
+    jsonWriteRaw(writer, "\"", 1);
+}
+
+static void writeIndent(JsonWriter* writer) {
+    jsonWriteRaw(writer, "\n", 1);
+    for (int i = 0; i < writer->depth; i++) jsonWriteRaw(writer, "  ", 2);
+}
+
+void jsonWriteBeginObject(JsonWriter* writer) {
+    jsonWriteRaw(writer, "{", 1);
+    writer->depth++;
+    writer->first = true;
+}
+
+void jsonWriteEndObject(JsonWriter* writer) {
+    writer->depth--;
+    if (!writer->first) writeIndent(writer);
+    jsonWriteRaw(writer, "}", 1);
+    writer->first = false;
+}
+
+// Start a member; its value is written next
+void jsonWriteKey(JsonWriter* writer, const char* key) {
+    if (!writer->first) jsonWriteRaw(writer, ",", 1);
+    writeIndent(writer);
+    jsonWriteString(writer, key, strlen(key));
+    jsonWriteRaw(writer, ": ", 2);
+    writer->first = false;
+}
+
+// Flush what is buffered and release the buffer. The caller closes the file.
+// Returns false if any write failed.
+bool jsonWriterClose(JsonWriter* writer) {
+    if (writer->buffer) flushWriter(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return !writer->error;
+}
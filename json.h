@@ -0,0 +1,46 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define JSON_WRITER_BUFFER 65536        // Bytes collected before each fwrite
+
+// Pull reader over a JSON document held in memory (usually a mapped file).
+// Nothing is built up front; the caller walks members and reads the values
+// it wants, skipping the rest.
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t position;            // Next byte to read
+    bool error;                 // Set on the first malformed input; later reads fail
+} JsonReader;
+
+// Buffered writer producing indented JSON
+typedef struct {
+    FILE* file;
+    char* buffer;               // JSON_WRITER_BUFFER bytes
+    size_t length;              // Bytes waiting in buffer
+    int depth;                  // Open objects
+    bool first;                 // No member written yet in the innermost object
+    bool error;                 // A write failed
+} JsonWriter;
+
+void jsonReaderInit(JsonReader* reader, const char* data, size_t size);
+bool jsonBeginObject(JsonReader* reader);
+bool jsonNextMember(JsonReader* reader, char* key, size_t keySize);
+char* jsonReadString(JsonReader* reader, int* length);
+bool jsonReadNumber(JsonReader* reader, double* value);
+bool jsonIsString(JsonReader* reader);
+void jsonSkipValue(JsonReader* reader);
+
+bool jsonWriterInit(JsonWriter* writer, FILE* file);
+void jsonWriteBeginObject(JsonWriter* writer);
+void jsonWriteEndObject(JsonWriter* writer);
+void jsonWriteKey(JsonWriter* writer, const char* key);
+void jsonWriteString(JsonWriter* writer, const char* value, size_t length);
+void jsonWriteRaw(JsonWriter* writer, const char* text, size_t length);
+bool jsonWriterClose(JsonWriter* writer);
+
+#endif
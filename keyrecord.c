@@ -0,0 +1,254 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "raylib.h"
+#include "platform.h"
+#include "inputlog.h"
+#include "sheet.h"
+#include "spsc.h"
+#include "wake.h"
+#include "keyrecord.h"
+
+// Keys that play notes, unshifted
+static const char sheetKeys[] = "1234567890qwertyuiopasdfghjklzxcvbnm";
+
+struct KeyRecorder {
+    SpscQueue presses;          // Hook thread -> UI thread
+    bool hooked;                // Presses come from the platform key hook
+    _Atomic bool focused;       // Window has focus, published each frame for the hook
+    _Atomic uint32_t dropped;   // Presses lost to a full queue
+
+    // Owned by the hook thread (the UI thread without a hook)
+    bool held[128];             // Keys down, to skip auto-repeat
+    bool shift;
+    double frameClock;          // Time without a hook: summed frame times
+
+    // Owned by the UI thread
+    RecordedNote* notes;
+    int count;
+    int capacity;
+};
+
+// Sharps are typed shifted: uppercase letters and the symbols over the digits
+static char sheetCharacter(int key, bool shift) {
+    if (!shift) return (char)key;
+    char shifted = key >= 'a' ? (char)(key - 'a' + 'A') : ")!@#$%^&*("[key - '0'];
+    return sheetKeyToNote((unsigned char)shifted) >= 0 ? shifted : (char)key;
+}
+
+static void pressKey(KeyRecorder* recorder, int key, bool down, double time) {
+    if (key == KEY_HOOK_SHIFT) {
+        recorder->shift = down;
+        return;
+    }
+    if (key <= 0 || key >= 128 || recorder->held[key] == down) return; // Auto-repeat
+    recorder->held[key] = down;
+    if (!down) return;
+
+    RecordedNote note = { time, sheetCharacter(key, recorder->shift) };
+    if (!spscPush(&recorder->presses, &note)) atomic_fetch_add_explicit(&recorder->dropped, 1, memory_order_relaxed);
+    else if (recorder->hooked) wakeEventLoop();
+}
+
+// The hook sees every keyboard press system-wide; presses while another
+// window has focus are typing meant for it. Releases still go through so
+// held keys are let go.
+static void hookKey(void* userData, int key, bool down, double time) {
+    KeyRecorder* recorder = userData;
+    if (down && key != KEY_HOOK_SHIFT && !atomic_load_explicit(&recorder->focused, memory_order_relaxed)) return;
+    pressKey(recorder, key, down, time);
+}
+
+// Without a hook, presses are only seen once per frame
+static void pollKeys(KeyRecorder* recorder) {
+    recorder->frameClock += inputFrameTime();
+    double time = recorder->frameClock;
+    bool shift = inputKeyDown(KEY_LEFT_SHIFT) || inputKeyDown(KEY_RIGHT_SHIFT);
+    if (shift != recorder->shift) pressKey(recorder, KEY_HOOK_SHIFT, shift, time);
+    for (const char* key = sheetKeys; *key; key++) {
+        int rayKey = (*key >= 'a' && *key <= 'z') ? KEY_A + (*key - 'a') : KEY_ZERO + (*key - '0');
+        if (inputKeyPressed(rayKey)) pressKey(recorder, *key, true, time);
+        if (inputKeyReleased(rayKey)) pressKey(recorder, *key, false, time);
+    }
+}
+
+// Begin capturing key presses. They are timestamped on an input thread
+// where the platform allows it, otherwise polled each frame. Replays always
+// poll, so they stay driven by the log. Presses made while the window is
+// unfocused are left out.
+KeyRecorder* startKeyRecording(void) {
+    KeyRecorder* recorder = calloc(1, sizeof(KeyRecorder));
+    if (!recorder) return NULL;
+    if (!initSpscQueue(&recorder->presses, sizeof(RecordedNote), RECORD_QUEUE)) {
+        free(recorder);
+        return NULL;
+    }
+    atomic_store_explicit(&recorder->focused, IsWindowFocused(), memory_order_relaxed);
+    recorder->hooked = !inputReplaying() && startKeyHook(hookKey, recorder);
+    if (recorder->hooked) TraceLog(LOG_INFO, "RECORD: Capturing key presses on an input thread");
+    else TraceLog(LOG_WARNING, "RECORD: No key hook available, capturing key presses once per frame");
+    return recorder;
+}
+
+// Once per frame: take in the presses since the last call
+void updateKeyRecording(KeyRecorder* recorder) {
+    if (recorder->hooked) atomic_store_explicit(&recorder->focused, IsWindowFocused(), memory_order_relaxed);
+    else pollKeys(recorder);
+    RecordedNote note;
+    while (spscPop(&recorder->presses, &note)) {
+        if (recorder->count == recorder->capacity) {
+            int capacity = recorder->capacity ? recorder->capacity * 2 : 256;
+            RecordedNote* notes = realloc(recorder->notes, sizeof(RecordedNote) * capacity);
+            if (!notes) {
+                atomic_fetch_add_explicit(&recorder->dropped, 1, memory_order_relaxed);
+                continue;
+            }
+            recorder->notes = notes;
+            recorder->capacity = capacity;
+        }
+        recorder->notes[recorder->count++] = note;
+    }
+}
+
+int keyRecordingNoteCount(const KeyRecorder* recorder) {
+    return recorder->count;
+}
+
+// Stop capturing and free the recorder. Returns the recording as notation
+// quantized to *bpm, subdivided up to maxSubdivision times when that keeps
+// the rhythm (malloc'd, NULL if nothing was played). *bpm becomes the
+// tempo the notation is written at.
+char* finishKeyRecording(KeyRecorder* recorder, int* bpm, int maxSubdivision, int* length) {
+    if (recorder->hooked) stopKeyHook();
+    recorder->hooked = false;
+    updateKeyRecording(recorder);
+
+    uint32_t dropped = atomic_load_explicit(&recorder->dropped, memory_order_relaxed);
+    if (dropped > 0) TraceLog(LOG_WARNING, "RECORD: Lost %u key presses", dropped);
+    char* text = recordedNotesToSheet(recorder->notes, recorder->count, bpm, maxSubdivision, length);
+    if (text) TraceLog(LOG_INFO, "RECORD: Recorded %d notes at %d bpm", recorder->count, *bpm);
+
+    freeSpscQueue(&recorder->presses);
+    free(recorder->notes);
+    free(recorder);
+    return text;
+}
+
+static int compareRecordedNotes(const void* a, const void* b) {
+    double first = ((const RecordedNote*)a)->time;
+    double second = ((const RecordedNote*)b)->time;
+    return (first > second) - (first < second);
+}
+
+// Group presses within RECORD_CHORD_WINDOW of each other into chords
+static void groupChords(const RecordedNote* notes, int count, int* chords) {
+    int chord = -1;
+    int chordFirst = 0;
+    for (int i = 0; i < count; i++) {
+        bool joins = chord >= 0 && notes[i].time - notes[chordFirst].time <= RECORD_CHORD_WINDOW;
+        for (int n = chordFirst; joins && n < i; n++) {
+            if (notes[n].key == notes[i].key) joins = false;    // A repeated key is a new onset
+        }
+        if (!joins) {
+            chord++;
+            chordFirst = i;
+        }
+        chords[i] = chord;
+    }
+}
+
+// Put each chord on the step nearest its onset, counting steps of
+// stepSeconds from the first press. Returns how many chords share a step
+// with the chord before while too far from it to pass as an arpeggio.
+static int quantizeChords(const RecordedNote* notes, int count, const int* chords, double stepSeconds, int* steps) {
+    int collisions = 0;
+    double previousOnset = notes[0].time;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && chords[i] == chords[i - 1]) {
+            steps[i] = steps[i - 1];
+            continue;
+        }
+        double onset = notes[i].time;
+        steps[i] = (int)((onset - notes[0].time) / stepSeconds + 0.5);
+        if (i > 0 && steps[i] == steps[i - 1] && onset - previousOnset > RECORD_ARPEGGIO_GAP * stepSeconds) collisions++;
+        previousOnset = onset;
+    }
+    return collisions;
+}
+
+// Write presses as notation, starting with the first press. Presses within
+// RECORD_CHORD_WINDOW of each other form a chord, and each chord goes to
+// the step nearest its onset, so timing errors never add up. Steps are one
+// beat at *bpm, or up to maxSubdivision times shorter (powers of two) when
+// whole beats would put notes that are audibly apart on the same step;
+// *bpm is multiplied to match, and the finest level needed is used. Chords
+// that still share a step become an arpeggio [a b c], which plays them an
+// eighth of a step apart: fast trills are written that way. A step holding
+// one chord is written as a note or [chord], and notes of a chord inside an
+// arpeggio are spread with it. Empty steps become rests, and lines break
+// every RECORD_LINE_STEPS steps.
+// Sorts notes in place; returns a malloc'd string or NULL.
+char* recordedNotesToSheet(RecordedNote* notes, int count, int* bpm, int maxSubdivision, int* length) {
+    *length = 0;
+    if (count <= 0 || *bpm <= 0) return NULL;
+    qsort(notes, count, sizeof(RecordedNote), compareRecordedNotes);
+
+    int* chords = malloc(sizeof(int) * count);
+    int* steps = malloc(sizeof(int) * count);
+    if (!chords || !steps) {
+        free(chords);
+        free(steps);
+        return NULL;
+    }
+    groupChords(notes, count, chords);
+    int subdivision = 1;
+    int fewest = -1;
+    for (int level = 1; level <= maxSubdivision; level *= 2) {
+        int collisions = quantizeChords(notes, count, chords, 60.0 / (*bpm * level), steps);
+        if (fewest < 0 || collisions < fewest) {
+            fewest = collisions;
+            subdivision = level;
+        }
+        if (collisions == 0) break;
+    }
+    *bpm *= subdivision;
+    quantizeChords(notes, count, chords, 60.0 / *bpm, steps);
+
+    // Each note takes at most a character, a separator and a bracket, and
+    // each empty step at most one rest character and a line break
+    int lastStep = steps[count - 1];
+    char* text = malloc((size_t)count * 3 + lastStep + lastStep / RECORD_LINE_STEPS + 2);
+    if (!text) {
+        free(chords);
+        free(steps);
+        return NULL;
+    }
+    int pos = 0;
+    int previous = -1;
+    for (int i = 0; i < count;) {
+        int end = i;
+        while (end < count && steps[end] == steps[i]) end++;
+        if (previous >= 0) {
+            int rests = steps[i] - previous - 1;
+            for (; rests >= 2; rests -= 2) text[pos++] = '|';
+            if (rests) text[pos++] = ' ';
+            if (steps[i] / RECORD_LINE_STEPS != previous / RECORD_LINE_STEPS) text[pos++] = '\n';
+        }
+        if (end - i == 1) {
+            text[pos++] = notes[i].key;
+        } else {
+            text[pos++] = '[';
+            for (int n = i; n < end; n++) {
+                if (n > i && chords[n] != chords[n - 1]) text[pos++] = ' ';
+                text[pos++] = notes[n].key;
+            }
+            text[pos++] = ']';
+        }
+        previous = steps[i];
+        i = end;
+    }
+    text[pos] = '\0';
+    *length = pos;
+    free(chords);
+    free(steps);
+    return text;
+}
@@ -0,0 +1,26 @@
+#ifndef KEYRECORD_H
+#define KEYRECORD_H
+
+#include <stdbool.h>
+
+#define RECORD_CHORD_WINDOW 0.03        // Presses this close together (seconds) form one chord
+#define RECORD_ARPEGGIO_GAP 0.1875      // Widest onset gap (in steps) kept as an arpeggio: 1.5x its 1/8 step spacing
+#define RECORD_MAX_SUBDIVISION 4        // Finest steps a recording may switch to: sixteenths of the beat
+#define RECORD_LINE_STEPS 16            // Steps per line of written notation
+#define RECORD_QUEUE 4096               // Presses waiting for the UI thread
+
+// Key press captured while recording
+typedef struct {
+    double time;                // nowSeconds() of the press (frame clock without a hook)
+    char key;                   // Sheet character, shifted for sharps
+} RecordedNote;
+
+typedef struct KeyRecorder KeyRecorder;
+
+KeyRecorder* startKeyRecording(void);
+void updateKeyRecording(KeyRecorder* recorder);
+int keyRecordingNoteCount(const KeyRecorder* recorder);
+char* finishKeyRecording(KeyRecorder* recorder, int* bpm, int maxSubdivision, int* length);
+char* recordedNotesToSheet(RecordedNote* notes, int count, int* bpm, int maxSubdivision, int* length);
+
+#endif
@@ -0,0 +1,385 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "song.h"
+#include "library.h"
+
+#define INDEX_MAGIC "NVXI"
+#define INDEX_VERSION 2
+#define ENTRY_HEADER_SIZE 32    // size, modifiedTime, length, bpm, noteCount, two name lengths
+#define INDEX_NO_SONG 0xFFFF    // Song name length of a file that is not a valid song
+
+// Cached metadata of one file, pointing into the mapped index
+typedef struct {
+    const char* fileName;       // Key: file name inside the song directory
+    int fileNameLength;
+    const char* songName;
+    int songNameLength;         // INDEX_NO_SONG if the file is not a valid song
+    int64_t size;
+    int64_t modifiedTime;
+    float length;
+    int bpm;
+    int noteCount;
+} IndexEntry;
+
+// Index file loaded for lookups by file name
+typedef struct {
+    MappedFile file;
+    IndexEntry* entries;
+    int count;
+    int* slots;                 // Open-addressing table of entry indices (-1 = empty)
+    uint32_t mask;
+} LibraryIndex;
+
+// State threaded through scanDirectory
+typedef struct {
+    const char* directory;
+    LibraryIndex* index;
+    SavedSong* songs;           // Every .json found, including invalid ones (songName NULL)
+    int count;
+    int capacity;
+    int reused;                 // Files whose metadata came from the index
+    int reread;                 // Files that had to be parsed
+} LibraryScan;
+
+static uint32_t hashName(const char* name, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    return hash;
+}
+
+static uint32_t readU32(const unsigned char* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint16_t readU16(const unsigned char* data) {
+    uint16_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Map the index and hash its entries. A missing, foreign or truncated index
+// is treated as empty so every file is simply re-read.
+static void loadIndex(LibraryIndex* index, const char* path) {
+    memset(index, 0, sizeof(*index));
+    if (!mapFile(path, &index->file)) return;
+
+    const unsigned char* data = index->file.data;
+    size_t size = index->file.size;
+    if (size < 12 || memcmp(data, INDEX_MAGIC, 4) != 0 || readU32(data + 4) != INDEX_VERSION) {
+        unmapFile(&index->file);
+        return;
+    }
+    uint32_t count = readU32(data + 8);
+    if (count > size / ENTRY_HEADER_SIZE) count = (uint32_t)(size / ENTRY_HEADER_SIZE);
+
+    uint32_t capacity = 16;
+    while (capacity < count * 2) capacity *= 2;
+    index->entries = malloc(sizeof(IndexEntry) * (count ? count : 1));
+    index->slots = malloc(sizeof(int) * capacity);
+    if (!index->entries || !index->slots) {
+        free(index->entries);
+        free(index->slots);
+        unmapFile(&index->file);
+        memset(index, 0, sizeof(*index));
+        return;
+    }
+    memset(index->slots, 0xff, sizeof(int) * capacity);
+    index->mask = capacity - 1;
+
+    size_t offset = 12;
+    for (uint32_t i = 0; i < count && offset + ENTRY_HEADER_SIZE <= size; i++) {
+        const unsigned char* header = data + offset;
+        IndexEntry* entry = &index->entries[index->count];
+        memcpy(&entry->size, header, 8);
+        memcpy(&entry->modifiedTime, header + 8, 8);
+        memcpy(&entry->length, header + 16, 4);
+        memcpy(&entry->bpm, header + 20, 4);
+        memcpy(&entry->noteCount, header + 24, 4);
+        entry->fileNameLength = readU16(header + 28);
+        entry->songNameLength = readU16(header + 30);
+        int songNameBytes = entry->songNameLength == INDEX_NO_SONG ? 0 : entry->songNameLength;
+        offset += ENTRY_HEADER_SIZE;
+        if (offset + entry->fileNameLength + songNameBytes > size) break;
+        entry->fileName = (const char*)data + offset;
+        entry->songName = entry->fileName + entry->fileNameLength;
+        offset += entry->fileNameLength + songNameBytes;
+
+        uint32_t slot = hashName(entry->fileName, entry->fileNameLength) & index->mask;
+        while (index->slots[slot] >= 0) slot = (slot + 1) & index->mask;
+        index->slots[slot] = index->count++;
+    }
+}
+
+static const IndexEntry* findIndexEntry(const LibraryIndex* index, const char* name) {
+    if (index->count == 0) return NULL;
+    int length = (int)strlen(name);
+    uint32_t slot = hashName(name, length) & index->mask;
+    while (index->slots[slot] >= 0) {
+        const IndexEntry* entry = &index->entries[index->slots[slot]];
+        if (entry->fileNameLength == length && memcmp(entry->fileName, name, length) == 0) return entry;
+        slot = (slot + 1) & index->mask;
+    }
+    return NULL;
+}
+
+static void freeIndex(LibraryIndex* index) {
+    free(index->entries);
+    free(index->slots);
+    unmapFile(&index->file);
+    memset(index, 0, sizeof(*index));
+}
+
+// Parse a song file for the metadata shown in the library
+static void readSongMetadata(SavedSong* saved) {
+    Song song;
+    if (!loadSong(saved->filename, &song)) return;
+
+    Timeline timeline;
+    if (loadSongTimeline(&song, &timeline)) {
+        saved->noteCount = timeline.eventCount;
+        saved->length = (float)timelineTickToSeconds(&timeline, timeline.endTick, song.bpm);
+        freeTimeline(&timeline);
+    }
+    saved->bpm = song.bpm;
+    saved->songName = song.name;
+    song.name = NULL;
+    freeSong(&song);
+}
+
+static bool hasJsonExtension(const char* name) {
+    size_t length = strlen(name);
+    if (length < 5) return false;
+    const char* extension = name + length - 5;
+    for (int i = 0; i < 5; i++) {
+        if (tolower((unsigned char)extension[i]) != ".json"[i]) return false;
+    }
+    return true;
+}
+
+static void visitSongFile(void* userData, const DirectoryEntry* file) {
+    LibraryScan* scan = userData;
+    if (!hasJsonExtension(file->name)) return;
+
+    if (scan->count == scan->capacity) {
+        int capacity = scan->capacity ? scan->capacity * 2 : 64;
+        SavedSong* songs = realloc(scan->songs, sizeof(SavedSong) * capacity);
+        if (!songs) return;
+        scan->songs = songs;
+        scan->capacity = capacity;
+    }
+    SavedSong* saved = &scan->songs[scan->count];
+    memset(saved, 0, sizeof(*saved));
+    saved->filename = joinPath(scan->directory, file->name);
+    if (!saved->filename) return;
+    saved->fileSize = file->size;
+    saved->modifiedTime = file->modifiedTime;
+    scan->count++;
+
+    const IndexEntry* entry = findIndexEntry(scan->index, file->name);
+    if (entry && entry->size == file->size && entry->modifiedTime == file->modifiedTime) {
+        if (entry->songNameLength != INDEX_NO_SONG) {
+            saved->songName = malloc(entry->songNameLength + 1);
+            if (saved->songName) {
+                memcpy(saved->songName, entry->songName, entry->songNameLength);
+                saved->songName[entry->songNameLength] = '\0';
+            }
+        }
+        saved->bpm = entry->bpm;
+        saved->noteCount = entry->noteCount;
+        saved->length = entry->length;
+        scan->reused++;
+    } else {
+        readSongMetadata(saved);
+        scan->reread++;
+    }
+}
+
+// Write every scanned file (valid or not) to a temporary file and swap it in
+static void writeIndex(const LibraryScan* scan, const char* path) {
+    size_t size = 12;
+    for (int i = 0; i < scan->count; i++) {
+        const SavedSong* saved = &scan->songs[i];
+        size += ENTRY_HEADER_SIZE + strlen(GetFileName(saved->filename)) + (saved->songName ? strlen(saved->songName) : 0);
+    }
+    unsigned char* buffer = malloc(size);
+    if (!buffer) return;
+
+    uint32_t version = INDEX_VERSION;
+    uint32_t count = (uint32_t)scan->count;
+    memcpy(buffer, INDEX_MAGIC, 4);
+    memcpy(buffer + 4, &version, 4);
+    memcpy(buffer + 8, &count, 4);
+    size_t offset = 12;
+    for (int i = 0; i < scan->count; i++) {
+        const SavedSong* saved = &scan->songs[i];
+        const char* fileName = GetFileName(saved->filename);
+        size_t fileNameLength = strlen(fileName);
+        size_t songNameLength = saved->songName ? strlen(saved->songName) : 0;
+        if (fileNameLength > UINT16_MAX) fileNameLength = UINT16_MAX;
+        if (songNameLength > INDEX_NO_SONG - 1) songNameLength = INDEX_NO_SONG - 1;
+        uint16_t lengths[2] = { (uint16_t)fileNameLength, saved->songName ? (uint16_t)songNameLength : INDEX_NO_SONG };
+
+        unsigned char* header = buffer + offset;
+        memcpy(header, &saved->fileSize, 8);
+        memcpy(header + 8, &saved->modifiedTime, 8);
+        memcpy(header + 16, &saved->length, 4);
+        memcpy(header + 20, &saved->bpm, 4);
+        memcpy(header + 24, &saved->noteCount, 4);
+        memcpy(header + 28, lengths, 4);
+        offset += ENTRY_HEADER_SIZE;
+        memcpy(buffer + offset, fileName, fileNameLength);
+        offset += fileNameLength;
+        if (songNameLength) memcpy(buffer + offset, saved->songName, songNameLength);
+        offset += songNameLength;
+    }
+
+    size_t temporarySize = strlen(path) + 5;
+    char* temporary = malloc(temporarySize);
+    if (!temporary) {
+        free(buffer);
+        return;
+    }
+    snprintf(temporary, temporarySize, "%s.tmp", path);
+    FILE* file = fopen(temporary, "wb");
+    bool ok = file && fwrite(buffer, 1, offset, file) == offset;
+    if (file && fclose(file) != 0) ok = false;
+    free(buffer);
+#ifdef _WIN32
+    if (ok) remove(path); // rename() does not replace on Windows
+#endif
+    if (!ok || rename(temporary, path) != 0) {
+        TraceLog(LOG_WARNING, "Failed to write library index: %s", path);
+        remove(temporary);
+    }
+    free(temporary);
+}
+
+static int compareSongs(const void* a, const void* b) {
+    const SavedSong* left = a;
+    const SavedSong* right = b;
+    for (const char *l = left->songName, *r = right->songName; ; l++, r++) {
+        int difference = tolower((unsigned char)*l) - tolower((unsigned char)*r);
+        if (difference != 0) return difference;
+        if (*l == '\0') break;
+    }
+    return strcmp(left->filename, right->filename);
+}
+
+// Load saved songs from noctivoxFiles directory. Metadata comes from the
+// index for files whose size and modification time are unchanged; only new
+// or modified files are parsed, and the index is rewritten if anything moved.
+void loadSavedSongs(SavedSong** songs, int* songCount, const char* directory) {
+    double start = nowSeconds();
+    char* indexPath = joinPath(directory, LIBRARY_INDEX_NAME);
+    if (!indexPath) {
+        *songs = NULL;
+        *songCount = 0;
+        return;
+    }
+
+    LibraryIndex index;
+    loadIndex(&index, indexPath);
+    LibraryScan scan = { directory, &index, NULL, 0, 0, 0, 0 };
+    scanDirectory(directory, visitSongFile, &scan);
+    bool changed = scan.reread > 0 || scan.reused != index.count;
+    freeIndex(&index);
+    if (changed) writeIndex(&scan, indexPath);
+    free(indexPath);
+
+    // Drop files that are not songs; they stay in the index so they are not re-read
+    int valid = 0;
+    for (int i = 0; i < scan.count; i++) {
+        if (scan.songs[i].songName) scan.songs[valid++] = scan.songs[i];
+        else free(scan.songs[i].filename);
+    }
+    if (valid > 1) qsort(scan.songs, valid, sizeof(SavedSong), compareSongs);
+
+    *songs = scan.songs;
+    *songCount = valid;
+    TraceLog(LOG_INFO, "Loaded %d songs from %s (%d indexed, %d read) in %.1f ms",
+             valid, directory, scan.reused, scan.reread, (nowSeconds() - start) * 1000.0);
+}
+
+// Read one song file's metadata. Returns false if the file is gone; a file
+// that exists but is not a valid song comes back with a NULL songName.
+bool readSavedSong(const char* path, SavedSong* saved) {
+    memset(saved, 0, sizeof(*saved));
+    if (!getFileInfo(path, &saved->fileSize, &saved->modifiedTime)) return false;
+    saved->filename = strdup(path);
+    if (!saved->filename) return false;
+    readSongMetadata(saved);
+    return true;
+}
+
+static int compareFilenames(const void* a, const void* b) {
+    return strcmp(((const SavedSong*)a)->filename, ((const SavedSong*)b)->filename);
+}
+
+// Merge a batch of changes into the sorted song list, taking ownership of
+// their strings. Each change replaces any song with the same filename; a
+// change with a NULL songName only removes it. Costs one pass over the list
+// plus a sort of the batch, so a bulk copy is as cheap as a single save.
+void applySavedSongChanges(SavedSong** songs, int* songCount, SavedSong* changes, int changeCount) {
+    if (changeCount == 0) return;
+    qsort(changes, changeCount, sizeof(SavedSong), compareFilenames);
+
+    // Drop songs the batch replaces or removes
+    int kept = 0;
+    for (int i = 0; i < *songCount; i++) {
+        SavedSong* song = &(*songs)[i];
+        if (bsearch(song, changes, changeCount, sizeof(SavedSong), compareFilenames)) {
+            free(song->filename);
+            free(song->songName);
+        } else {
+            (*songs)[kept++] = *song;
+        }
+    }
+
+    // Keep one change per file, and only the ones that add a song
+    int added = 0;
+    for (int i = 0; i < changeCount; i++) {
+        bool superseded = i + 1 < changeCount && strcmp(changes[i].filename, changes[i + 1].filename) == 0;
+        if (superseded || !changes[i].songName) {
+            free(changes[i].filename);
+            free(changes[i].songName);
+        } else {
+            changes[added++] = changes[i];
+        }
+    }
+    if (added > 1) qsort(changes, added, sizeof(SavedSong), compareSongs);
+
+    SavedSong* merged = malloc(sizeof(SavedSong) * (kept + added > 0 ? kept + added : 1));
+    if (!merged) {
+        for (int i = 0; i < added; i++) {
+            free(changes[i].filename);
+            free(changes[i].songName);
+        }
+        *songCount = kept;
+        return;
+    }
+    int left = 0;
+    int right = 0;
+    int out = 0;
+    while (left < kept || right < added) {
+        bool takeLeft = right >= added || (left < kept && compareSongs(&(*songs)[left], &changes[right]) <= 0);
+        merged[out++] = takeLeft ? (*songs)[left++] : changes[right++];
+    }
+    free(*songs);
+    *songs = merged;
+    *songCount = out;
+}
+
+// Free memory allocated for saved songs
+void freeSavedSongs(SavedSong* songs, int songCount) {
+    for (int i = 0; i < songCount; i++) {
+        free(songs[i].filename);
+        free(songs[i].songName);
+    }
+    free(songs);
+}
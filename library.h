@@ -0,0 +1,25 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LIBRARY_INDEX_NAME ".noctivox-index"    // Metadata cache kept in the song directory
+
+// Structure for saved songs
+typedef struct {
+    char* filename;             // Full path to the JSON file
+    char* songName;             // Extracted song name for display
+    int bpm;                    // Stored BPM (0 if none)
+    int noteCount;              // Number of notes in the song
+    float length;               // Length in seconds at the stored BPM
+    int64_t fileSize;           // Size of the JSON when its metadata was read
+    int64_t modifiedTime;       // Modification time of the JSON when its metadata was read
+} SavedSong;
+
+void loadSavedSongs(SavedSong** songs, int* songCount, const char* directory);
+void freeSavedSongs(SavedSong* songs, int songCount);
+bool readSavedSong(const char* path, SavedSong* saved);
+void applySavedSongChanges(SavedSong** songs, int* songCount, SavedSong* changes, int changeCount);
+
+#endif
@@ -0,0 +1,213 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "profiler.h"
+#include "songcache.h"
+#include "wake.h"
+#include "loader.h"
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_QUEUED,                // Waiting for a thread
+    SLOT_LOADING,               // A thread is reading it; the slot is pinned
+    SLOT_READY                  // loaded holds the result
+} SlotState;
+
+// One cached song, keyed by path
+typedef struct {
+    SlotState state;
+    char* path;
+    bool selected;              // The UI is waiting for this one
+    uint64_t lastUse;           // Request clock; newest prefetches load first, oldest are evicted
+    int64_t fileSize;           // Size and time of the file that was read
+    int64_t modifiedTime;
+    LoadedSong loaded;
+} LoaderSlot;
+
+struct SongLoader {
+    pthread_t threads[LOADER_MAX_THREADS];
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool running;
+    LoaderSlot slots[LOADER_CACHE_SIZE];
+    uint64_t clock;
+};
+
+void freeLoadedSong(LoadedSong* loaded) {
+    freeSong(&loaded->song);
+    freeSheet(&loaded->sheet);
+    memset(loaded, 0, sizeof(*loaded));
+}
+
+// Read a song on the calling thread: from its .nvx sidecar when that is
+// current, otherwise by parsing and compiling the JSON and writing one
+void readLoadedSong(const char* path, LoadedSong* loaded) {
+    memset(loaded, 0, sizeof(*loaded));
+    CompiledSong compiled;
+    if (openCompiledSong(path, &compiled)) {
+        loaded->valid = compiledSongToSong(&compiled, path, &loaded->song);
+        if (loaded->valid && !compiledSongToSheet(&compiled, &loaded->sheet)) {
+            sheetCompile(&loaded->sheet, loaded->song.sheet, loaded->song.sheetLength);
+        }
+        closeCompiledSong(&compiled);
+        if (loaded->valid) return;
+    }
+
+    loaded->valid = loadSong(path, &loaded->song);
+    if (!loaded->valid) return;
+    sheetCompile(&loaded->sheet, loaded->song.sheet, loaded->song.sheetLength);
+    writeCompiledSong(path, &loaded->song, &loaded->sheet);
+}
+
+static void clearSlot(LoaderSlot* slot) {
+    if (slot->state == SLOT_READY) freeLoadedSong(&slot->loaded);
+    free(slot->path);
+    memset(slot, 0, sizeof(*slot));
+}
+
+// Selected song first, then the most recently requested prefetch
+static LoaderSlot* nextQueued(SongLoader* loader) {
+    LoaderSlot* best = NULL;
+    for (int i = 0; i < LOADER_CACHE_SIZE; i++) {
+        LoaderSlot* slot = &loader->slots[i];
+        if (slot->state != SLOT_QUEUED) continue;
+        if (!best || slot->selected > best->selected ||
+            (slot->selected == best->selected && slot->lastUse > best->lastUse)) best = slot;
+    }
+    return best;
+}
+
+static void* loaderThread(void* argument) {
+    SongLoader* loader = argument;
+    pthread_mutex_lock(&loader->lock);
+    while (loader->running) {
+        LoaderSlot* slot = nextQueued(loader);
+        if (!slot) {
+            pthread_cond_wait(&loader->wake, &loader->lock);
+            continue;
+        }
+        slot->state = SLOT_LOADING;
+        pthread_mutex_unlock(&loader->lock);
+
+        // A loading slot is never evicted, so its path stays valid unlocked
+        LoadedSong loaded;
+        int64_t fileSize = -1;
+        int64_t modifiedTime = 0;
+        double started = profileBegin();
+        getFileInfo(slot->path, &fileSize, &modifiedTime);
+        readLoadedSong(slot->path, &loaded);
+        profileEnd(PROFILE_LIBRARY_IO, started);
+
+        pthread_mutex_lock(&loader->lock);
+        slot->loaded = loaded;
+        slot->fileSize = fileSize;
+        slot->modifiedTime = modifiedTime;
+        slot->state = SLOT_READY;
+        if (slot->selected) wakeEventLoop();
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+// Start the parser threads. Returns NULL if none could be started, in which
+// case the caller should load songs itself.
+SongLoader* createSongLoader(void) {
+    SongLoader* loader = calloc(1, sizeof(SongLoader));
+    if (!loader) return NULL;
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->wake, NULL);
+    loader->running = true;
+
+    int threads = processorCount() / 2;
+    if (threads < 1) threads = 1;
+    if (threads > LOADER_MAX_THREADS) threads = LOADER_MAX_THREADS;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&loader->threads[loader->threadCount], NULL, loaderThread, loader) == 0) loader->threadCount++;
+    }
+    if (loader->threadCount == 0) {
+        destroySongLoader(loader);
+        return NULL;
+    }
+    return loader;
+}
+
+void destroySongLoader(SongLoader* loader) {
+    if (!loader) return;
+    pthread_mutex_lock(&loader->lock);
+    loader->running = false;
+    pthread_cond_broadcast(&loader->wake);
+    pthread_mutex_unlock(&loader->lock);
+    for (int i = 0; i < loader->threadCount; i++) pthread_join(loader->threads[i], NULL);
+    for (int i = 0; i < LOADER_CACHE_SIZE; i++) clearSlot(&loader->slots[i]);
+    pthread_cond_destroy(&loader->wake);
+    pthread_mutex_destroy(&loader->lock);
+    free(loader);
+}
+
+// Ask for a song to be read and compiled in the background. A selected
+// request replaces the previous selection and jumps the queue; otherwise it
+// is a prefetch that is dropped first when the cache fills up.
+void songLoaderRequest(SongLoader* loader, const char* path, bool selected) {
+    if (!loader || !path) return;
+    int64_t fileSize = -1;
+    int64_t modifiedTime = 0;
+    getFileInfo(path, &fileSize, &modifiedTime);
+
+    pthread_mutex_lock(&loader->lock);
+    LoaderSlot* slot = NULL;
+    LoaderSlot* victim = NULL;
+    for (int i = 0; i < LOADER_CACHE_SIZE; i++) {
+        LoaderSlot* candidate = &loader->slots[i];
+        if (selected) candidate->selected = false;
+        if (candidate->path && strcmp(candidate->path, path) == 0) {
+            slot = candidate;
+        } else if (candidate->state != SLOT_LOADING && !candidate->selected &&
+                   (!victim || candidate->state == SLOT_EMPTY ||
+                    (victim->state != SLOT_EMPTY && candidate->lastUse < victim->lastUse))) {
+            victim = candidate;
+        }
+    }
+
+    if (slot && slot->state == SLOT_READY && (slot->fileSize != fileSize || slot->modifiedTime != modifiedTime)) {
+        // Changed on disk since it was read
+        freeLoadedSong(&slot->loaded);
+        slot->state = SLOT_QUEUED;
+    }
+    if (!slot && victim) {
+        clearSlot(victim);
+        victim->path = strdup(path);
+        if (victim->path) {
+            victim->state = SLOT_QUEUED;
+            slot = victim;
+        }
+    }
+    if (slot) {
+        slot->lastUse = ++loader->clock;
+        slot->selected = slot->selected || selected;
+        if (slot->state == SLOT_QUEUED) pthread_cond_signal(&loader->wake);
+    }
+    pthread_mutex_unlock(&loader->lock);
+}
+
+// Hand over the selected song once it is ready. The caller owns the result
+// and frees it with freeLoadedSong; the slot is emptied.
+bool songLoaderTake(SongLoader* loader, LoadedSong* loaded) {
+    if (!loader) return false;
+    bool taken = false;
+    pthread_mutex_lock(&loader->lock);
+    for (int i = 0; i < LOADER_CACHE_SIZE && !taken; i++) {
+        LoaderSlot* slot = &loader->slots[i];
+        if (!slot->selected || slot->state != SLOT_READY) continue;
+        *loaded = slot->loaded;
+        memset(&slot->loaded, 0, sizeof(slot->loaded));
+        slot->state = SLOT_EMPTY;
+        clearSlot(slot);
+        taken = true;
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return taken;
+}
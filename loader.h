@@ -0,0 +1,27 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stdbool.h>
+#include "song.h"
+#include "sheet.h"
+
+#define LOADER_MAX_THREADS 2    // Parser threads; the audio and playback threads come first
+#define LOADER_CACHE_SIZE 8     // Songs kept parsed and compiled
+
+// A saved song read and compiled off the UI thread
+typedef struct {
+    bool valid;                 // false if the file could not be read
+    Song song;                  // Parsed JSON
+    Sheet sheet;                // song.sheet compiled, ready to become the paste sheet
+} LoadedSong;
+
+typedef struct SongLoader SongLoader;
+
+SongLoader* createSongLoader(void);
+void destroySongLoader(SongLoader* loader);
+void songLoaderRequest(SongLoader* loader, const char* path, bool selected);
+bool songLoaderTake(SongLoader* loader, LoadedSong* loaded);
+void readLoadedSong(const char* path, LoadedSong* loaded);
+void freeLoadedSong(LoadedSong* loaded);
+
+#endif
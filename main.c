@@ -2,67 +2,91 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
+#include <time.h>
 #include "raylib.h"
-#include "resources/GFSNeohellenic_Italic.h"
-#include "resources/GFSNeohellenic_Bold.h"
-#include "resources/GFSNeohellenic_BoldItalic.h"
-
-// Fixed-size textbox for most inputs
-typedef struct {
-    Rectangle bounds;           // Position and size
-    char text[256];             // Fixed buffer for text
-    int textLength;             // Current length of text
-    bool editing;               // Is this textbox active?
-    float cursorBlink;          // Blink timer for cursor
-    bool numericOnly;           // Restrict to positive nonzero numbers?
-    Font font;                  // Custom font
-    float fontSize;             // Font size
-    float horizontalOffset;     // Horizontal offset for long text
-    float verticalOffset;       // Vertical offset for scrolling
-    float backspaceTimer;       // Time for multi-character removal
-    const char* placeholder;    // Placeholder text
-    int cursorPos;              // Cursor position in text
-    int selectionStart;         // Start of text selection (-1 if none)
-    int selectionEnd;           // End of text selection
-} Textbox;
-
-// Dynamic textbox for paste area
+#include "midi.h"
+#include "sheet.h"
+#include "playback.h"
+#include "audio.h"
+#include "render.h"
+#include "library.h"
+#include "watcher.h"
+#include "search.h"
+#include "loader.h"
+#include "songcache.h"
+#include "platform.h"
+#include "wake.h"
+#include "profiler.h"
+#include "inputlog.h"
+#include "keyrecord.h"
+#include "fonts.h"
+#include "textbox.h"
+#include "resources/baked_fonts.h"     // Generated by tools/bakefonts.c
+
+#define CARET_BLINK_WAKE 0.5         // Seconds between idle wakes while a caret blinks
+#define PLAYBACK_STATUS_WAKE 0.25    // Seconds between idle wakes while a song plays
+#define PROFILER_OVERLAY_WAKE 0.25   // Seconds between idle wakes while the profiler overlay shows
+
+// Upload panel parts, each redrawn into the panel texture only when its bit
+// in the dirty mask is set. PANEL_BACKGROUND redraws the whole panel.
+typedef enum {
+    PANEL_BACKGROUND,
+    PANEL_PASTE_AREA,
+    PANEL_SONG_NAME,
+    PANEL_BPM,
+    PANEL_CANCEL,
+    PANEL_SAVE,
+    PANEL_NOTE_COUNT,
+    PANEL_MIDI_PATH,
+    PANEL_DROP_HINT,
+    PANEL_RECORDING,
+    PANEL_WIDGET_COUNT
+} PanelWidget;
+
+#define PANEL_BIT(widget) (1u << (widget))
+#define PANEL_ALL (PANEL_BIT(PANEL_WIDGET_COUNT) - 1)
+
+// What a textbox showed when it was last drawn; any difference means redraw
 typedef struct {
-    Rectangle bounds;           // Position and size
-    char* text;                 // Dynamic buffer for text
-    int textLength;             // Current length of text
-    int textCapacity;           // Allocated capacity of text buffer
-    bool editing;               // Is this textbox active?
-    float cursorBlink;          // Blink timer for cursor
-    bool numericOnly;           // Restrict to positive nonzero numbers?
-    Font font;                  // Custom font
-    float fontSize;             // Font size
-    float horizontalOffset;     // Horizontal offset for long text
-    float verticalOffset;       // Vertical offset for scrolling
-    float backspaceTimer;       // Time for multi-character removal
-    const char* placeholder;    // Placeholder text
-    int cursorPos;              // Cursor position in text
-    int selectionStart;         // Start of text selection (-1 if none)
-    int selectionEnd;           // End of text selection
-} DynamicTextbox;
-
-// Structure for saved songs
+    int textLength;
+    int cursorPos;
+    int selectionStart;
+    int selectionEnd;
+    float verticalOffset;
+    bool editing;
+    bool caretVisible;
+} TextboxView;
+
+#define SONG_ROW_HEIGHT 30          // Row pitch of the song list
+#define SONG_SCROLL_IMPULSE 600.0f  // Scroll speed added per wheel notch, px/s
+#define SONG_SCROLL_FRICTION 8.0f   // Momentum decay rate, 1/s
+#define SONG_SCROLL_REST 5.0f       // Speed below which scrolling stops, px/s
+
+// Scrolling song list; only the rows inside bounds are ever drawn
 typedef struct {
-    char* filename;        // Full path to the JSON file
-    char* songName;        // Extracted song name for display
-} SavedSong;
+    Rectangle bounds;           // Scrolling frame area
+    float offset;               // Vertical scroll offset
+    float velocity;             // Scroll momentum in px/s
+    int hoveredRow;             // Row under the mouse (-1 if none)
+    int* labelFit;              // Per song: bytes of the name that fit a row (-1 until measured)
+    int labelCount;             // Songs labelFit covers
+} SongList;
 
 Color toHex(const char* hex);
 void loadFonts(void);
 void unloadFonts(void);
-void drawTextboxText(Textbox* textbox, Color textColor, bool isPasteArea);
-void drawDynamicTextboxText(DynamicTextbox* textbox, Color textColor);
-void handleTextboxInput(Textbox* textbox, bool isPasteArea);
-void handleDynamicTextboxInput(DynamicTextbox* textbox);
-void loadSavedSongs(SavedSong** songs, int* songCount, const char* directory);
-void freeSavedSongs(SavedSong* songs, int songCount);
 char* getUniqueFilename(const char* baseName, const char* directory);
 char* sanitizeFilename(const char* input);
+void resetSongListLabels(SongList* list, int songCount);
+int songListRowAt(const SongList* list, Vector2 point, int rowCount);
+bool updateSongList(SongList* list, int rowCount, Vector2 mousePosition);
+void drawSongList(SongList* list, const SavedSong* songs, const int* rows, int rowCount);
+void prefetchSongRows(SongLoader* loader, const SavedSong* songs, const int* rows, int rowCount, int centerRow);
+bool showLoadedSong(LoadedSong* loaded, DynamicTextbox* pasteArea, Sheet* pasteSheet, Textbox* bpmBox);
+bool updateTextboxView(TextboxView* view, int textLength, int cursorPos, int selectionStart, int selectionEnd,
+                       float verticalOffset, bool editing, float cursorBlink);
+void drawProfilerOverlay(Vector2 position);
 
 // Global font variables
 Font italicGFS;
@@ -78,558 +102,280 @@ Color toHex(const char* hex) {
     return (Color){ (unsigned char)r, (unsigned char)g, (unsigned char)b, 255 };
 }
 
-// Load fonts from memory
+// Load fonts from the atlases baked at build time
 void loadFonts(void) {
-    italicGFS = LoadFontFromMemory(".ttf", font_data_italic, sizeof(font_data_italic), 14, NULL, 0);
-    boldGFS_h1 = LoadFontFromMemory(".ttf", font_data_bold, sizeof(font_data_bold), 20, NULL, 0);
-    boldGFS_h2 = LoadFontFromMemory(".ttf", font_data_bold, sizeof(font_data_bold), 14, NULL, 0);
-    boldItalicGFS = LoadFontFromMemory(".ttf", font_data_bold_italic, sizeof(font_data_bold_italic), 12, NULL, 0);
+    italicGFS = loadBakedFont(&bakedItalic14, &bakedItalic14Extra);
+    boldGFS_h1 = loadBakedFont(&bakedBold20, &bakedBold20Extra);
+    boldGFS_h2 = loadBakedFont(&bakedBold14, &bakedBold14Extra);
+    boldItalicGFS = loadBakedFont(&bakedBoldItalic12, &bakedBoldItalic12Extra);
 }
 
 // Unload fonts
 void unloadFonts(void) {
-    UnloadFont(italicGFS);
-    UnloadFont(boldGFS_h1);
-    UnloadFont(boldGFS_h2);
-    UnloadFont(boldItalicGFS);
+    unloadBakedFont(italicGFS);
+    unloadBakedFont(boldGFS_h1);
+    unloadBakedFont(boldGFS_h2);
+    unloadBakedFont(boldItalicGFS);
 }
 
-// Render fixed-size textbox text
-void drawTextboxText(Textbox* textbox, Color textColor, bool isPasteArea) {
-    const char* displayText = (textbox->textLength == 0 && !textbox->editing) ? textbox->placeholder : textbox->text;
-    Vector2 textSize = MeasureTextEx(textbox->font, displayText, textbox->fontSize, 1);
-    float maxTextWidth = textbox->bounds.width - 10;
-    float maxTextHeight = textbox->bounds.height - 10;
-
-    textbox->horizontalOffset = (textSize.x > maxTextWidth) ? (textSize.x - maxTextWidth) : 0;
-
-    Rectangle scissorRect = { textbox->bounds.x + 5, textbox->bounds.y + 5, maxTextWidth, maxTextHeight };
-    BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
-
-    float yPos = textbox->bounds.y + 5;
-    DrawTextEx(textbox->font, displayText, 
-               (Vector2){ textbox->bounds.x + 5 - textbox->horizontalOffset, yPos }, 
-               textbox->fontSize, 1, textColor);
-
-    // Draw selection highlight
-    if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
-        int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-        int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-        Vector2 lineSize = MeasureTextEx(textbox->font, displayText, textbox->fontSize, 1);
-        float startX = textbox->bounds.x + 5 + (start * lineSize.x / textbox->textLength) - textbox->horizontalOffset;
-        float endX = textbox->bounds.x + 5 + (end * lineSize.x / textbox->textLength) - textbox->horizontalOffset;
-        DrawRectangle(startX, yPos, endX - startX, textbox->fontSize, Fade(toHex("#FFFFFF"), 0.3f));
-    }
 
-    // Draw cursor
-    if (textbox->editing && textbox->cursorBlink < 0.5f) {
-        if (textbox->textLength == 0) {
-            float cursorX = textbox->bounds.x + 5 - textbox->horizontalOffset;
-            DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
-        } else {
-            float cursorX = textbox->bounds.x + 5 + MeasureTextEx(textbox->font, displayText, textbox->fontSize, 1).x * textbox->cursorPos / (float)textbox->textLength - textbox->horizontalOffset;
-            DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
+// Sanitize filename by replacing invalid characters
+char* sanitizeFilename(const char* input) {
+    char* output = strdup(input);
+    for (int i = 0; output[i]; i++) {
+        if (strchr("\\/:*?\"<>|", output[i])) {
+            output[i] = '_';
         }
     }
-
-    EndScissorMode();
+    return output;
 }
 
-// Render dynamic textbox text (paste area)
-void drawDynamicTextboxText(DynamicTextbox* textbox, Color textColor) {
-    const char* displayText = (textbox->textLength == 0 && !textbox->editing) ? textbox->placeholder : textbox->text;
-    float maxTextWidth = textbox->bounds.width - 15;
-    float maxTextHeight = textbox->bounds.height - 10;
-
-    // Calculate horizontal offset based on the longest line
-    char* tempCopy = strdup(displayText);
-    char* tempLine = strtok(tempCopy, "\n");
-    float maxLineWidth = 0;
-    while (tempLine) {
-        Vector2 lineSize = MeasureTextEx(textbox->font, tempLine, textbox->fontSize, 1);
-        if (lineSize.x > maxLineWidth) maxLineWidth = lineSize.x;
-        tempLine = strtok(NULL, "\n");
-    }
-    free(tempCopy);
-    textbox->horizontalOffset = (maxLineWidth > maxTextWidth) ? (maxLineWidth - maxTextWidth) : 0;
-
-    Rectangle scissorRect = { textbox->bounds.x + 5, textbox->bounds.y + 5, maxTextWidth, maxTextHeight };
-    BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
-
-    float yPos = textbox->bounds.y + 5 - textbox->verticalOffset;
-    int charIndex = 0;
-    float totalHeight = 0;
-
-    // Render each line
-    char* textCopy = strdup(displayText);
-    char* line = strtok(textCopy, "\n");
-    while (line) {
-        DrawTextEx(textbox->font, line, 
-                   (Vector2){ textbox->bounds.x + 5 - textbox->horizontalOffset, yPos }, 
-                   textbox->fontSize, 1, textColor);
-        totalHeight += textbox->fontSize + 2;
-        yPos += textbox->fontSize + 2;
-        charIndex += strlen(line) + 1;
-        line = strtok(NULL, "\n");
-    }
-    free(textCopy);
-
-    // Draw selection highlight
-    if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
-        int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-        int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-        yPos = textbox->bounds.y + 5 - textbox->verticalOffset;
-        charIndex = 0;
-        textCopy = strdup(displayText);
-        line = strtok(textCopy, "\n");
-
-        while (line != NULL) {
-            int lineLen = strlen(line);
-            if (charIndex + lineLen >= start && charIndex <= end) {
-                Vector2 lineSize = MeasureTextEx(textbox->font, line, textbox->fontSize, 1);
-                float startX = textbox->bounds.x + 5 - textbox->horizontalOffset;
-                float endX = startX + lineSize.x;
-                if (charIndex < start) startX += (start - charIndex) * lineSize.x / lineLen;
-                if (charIndex + lineLen > end) endX = startX + (end - charIndex) * lineSize.x / lineLen;
-                DrawRectangle(startX, yPos, endX - startX, textbox->fontSize, Fade(toHex("#FFFFFF"), 0.3f));
-            }
-            charIndex += lineLen + 1;
-            yPos += textbox->fontSize + 2;
-            line = strtok(NULL, "\n");
-        }
-        free(textCopy);
-    }
-
-    // Draw cursor
-    if (textbox->editing && textbox->cursorBlink < 0.5f) {
-        yPos = textbox->bounds.y + 5 - textbox->verticalOffset;
-        if (textbox->textLength == 0) {
-            float cursorX = textbox->bounds.x + 5 - textbox->horizontalOffset;
-            DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
-        } else {
-            charIndex = 0;
-            textCopy = strdup(displayText);
-            line = strtok(textCopy, "\n");
-            while (line != NULL) {
-                int lineLen = strlen(line);
-                if (charIndex + lineLen >= textbox->cursorPos) {
-                    float cursorX = textbox->bounds.x + 5 + 
-                                   MeasureTextEx(textbox->font, line, textbox->fontSize, 1).x * 
-                                   (textbox->cursorPos - charIndex) / (float)(lineLen ? lineLen : 1) - 
-                                   textbox->horizontalOffset;
-                    DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
-                    break;
-                }
-                charIndex += lineLen + 1;
-                yPos += textbox->fontSize + 2;
-                line = strtok(NULL, "\n");
-            }
-            free(textCopy);
-        }
-    }
-
-    // Scrolling logic
-    Vector2 mousePos = GetMousePosition();
-    if (CheckCollisionPointRec(mousePos, textbox->bounds)) {
-        float wheel = GetMouseWheelMove();
-        if (wheel != 0) {
-            if (totalHeight > maxTextHeight) {
-                textbox->verticalOffset -= wheel * 20.0f;
-                if (textbox->verticalOffset < 0) textbox->verticalOffset = 0;
-                if (textbox->verticalOffset > totalHeight - maxTextHeight) textbox->verticalOffset = totalHeight - maxTextHeight;
-            } else {
-                textbox->verticalOffset = 0;
-            }
-        }
+// Generate a unique filename by appending (1), (2), etc.
+char* getUniqueFilename(const char* baseName, const char* directory) {
+    char* sanitizedBase = sanitizeFilename(baseName);
+    char name[512];
+    snprintf(name, sizeof(name), "%s.json", sanitizedBase);
+    char* filename = joinPath(directory, name);
+    for (int counter = 1; filename && FileExists(filename); counter++) {
+        free(filename);
+        snprintf(name, sizeof(name), "%s(%d).json", sanitizedBase, counter);
+        filename = joinPath(directory, name);
     }
 
-    EndScissorMode();
-
-    // Scrollbar
-    if (totalHeight > maxTextHeight) {
-        float scrollBarHeight = maxTextHeight * maxTextHeight / totalHeight;
-        float scrollBarY = textbox->bounds.y + 5 + (textbox->verticalOffset * (maxTextHeight - scrollBarHeight) / (totalHeight - maxTextHeight));
-        DrawRectangle(textbox->bounds.x + textbox->bounds.width - 10, scrollBarY, 5, scrollBarHeight, toHex("#494D5A"));
-    }
+    free(sanitizedBase);
+    return filename;
 }
 
-// Input handling for fixed-size textbox
-void handleTextboxInput(Textbox* textbox, bool isPasteArea) {
-    Vector2 mousePos = GetMousePosition();
-    bool mouseOver = CheckCollisionPointRec(mousePos, textbox->bounds);
-
-    if (mouseOver && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        textbox->selectionStart = -1;
-        textbox->selectionEnd = -1;
-        float xOffset = mousePos.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
-        Vector2 lineSize = MeasureTextEx(textbox->font, textbox->text, textbox->fontSize, 1);
-        int pos = (int)((xOffset / lineSize.x) * textbox->textLength);
-        textbox->cursorPos = (pos < textbox->textLength) ? pos : textbox->textLength;
-    }
-
-    if (mouseOver && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-        float xOffset = mousePos.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
-        Vector2 lineSize = MeasureTextEx(textbox->font, textbox->text, textbox->fontSize, 1);
-        int pos = (int)((xOffset / lineSize.x) * textbox->textLength);
-        textbox->selectionEnd = (pos < textbox->textLength) ? pos : textbox->textLength;
-        if (textbox->selectionStart == -1) textbox->selectionStart = textbox->cursorPos;
-    }
+// Gaussian blur fragment shader
+const char* blurShaderCode = 
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec2 resolution;\n"
+    "void main() {\n"
+    "    vec2 texelSize = 1.0 / resolution;\n"
+    "    vec4 color = vec4(0.0);\n"
+    "    float weights[3] = float[](0.3, 0.2, 0.2);\n" 
+    "    color += texture(texture0, fragTexCoord) * weights[0];\n"
+    "    color += texture(texture0, fragTexCoord + vec2(texelSize.x, 0.0)) * weights[1];\n"
+    "    color += texture(texture0, fragTexCoord - vec2(texelSize.x, 0.0)) * weights[1];\n"
+    "    color += texture(texture0, fragTexCoord + vec2(0.0, texelSize.y)) * weights[1];\n"
+    "    color += texture(texture0, fragTexCoord - vec2(0.0, texelSize.y)) * weights[1];\n"
+    "    fragColor = color * 0.8f;\n"
+    "}";
 
-    int key = GetCharPressed();
-    while (key > 0 && textbox->textLength < 255) {
-        if (textbox->numericOnly) {
-            if (key >= '0' && key <= '9') { 
-                textbox->text[textbox->textLength++] = (char)key;
-                textbox->text[textbox->textLength] = '\0';
-                textbox->cursorPos++;
-            }
-        } else {
-            if (key >= 32 && key <= 126) {
-                textbox->text[textbox->textLength++] = (char)key;
-                textbox->text[textbox->textLength] = '\0';
-                textbox->cursorPos++;
-            }
-        }
-        key = GetCharPressed();
+// Forget measured labels; the song array they describe changed
+void resetSongListLabels(SongList* list, int songCount) {
+    if (songCount > list->labelCount) {
+        int* labelFit = realloc(list->labelFit, sizeof(int) * songCount);
+        if (!labelFit) songCount = list->labelCount;
+        else list->labelFit = labelFit;
     }
+    for (int i = 0; i < songCount; i++) list->labelFit[i] = -1;
+    list->labelCount = songCount;
+}
 
-    if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_V)) {
-        const char* clipboard = GetClipboardText();
-        if (clipboard) {
-            int len = strlen(clipboard);
-            int spaceLeft = 255 - textbox->textLength;
-            int charsToCopy = (len < spaceLeft) ? len : spaceLeft;
-            if (textbox->numericOnly) {
-                for (int i = 0; i < charsToCopy; i++) {
-                    if (clipboard[i] >= '0' && clipboard[i] <= '9') {
-                        textbox->text[textbox->textLength++] = clipboard[i];
-                        textbox->cursorPos++;
-                    }
-                }
-            } else {
-                strncpy(textbox->text + textbox->textLength, clipboard, charsToCopy);
-                textbox->textLength += charsToCopy;
-                textbox->cursorPos += charsToCopy;
-            }
-            textbox->text[textbox->textLength] = '\0';
-        }
-    }
+// Row under a point, or -1
+int songListRowAt(const SongList* list, Vector2 point, int rowCount) {
+    if (!CheckCollisionPointRec(point, list->bounds)) return -1;
+    int row = (int)((point.y - list->bounds.y + list->offset) / SONG_ROW_HEIGHT);
+    return row >= 0 && row < rowCount ? row : -1;
+}
 
-    if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_A)) {
-        textbox->selectionStart = 0;
-        textbox->selectionEnd = textbox->textLength;
-        textbox->cursorPos = textbox->textLength;
+// Wheel input adds momentum that decays smoothly. Returns true if the list
+// moved or the hovered row changed and needs a redraw.
+bool updateSongList(SongList* list, int rowCount, Vector2 mousePosition) {
+    float previousOffset = list->offset;
+    if (CheckCollisionPointRec(mousePosition, list->bounds)) {
+        float wheel = inputMouseWheelMove();
+        if (wheel != 0) list->velocity -= wheel * SONG_SCROLL_IMPULSE;
     }
 
-    if (IsKeyPressed(KEY_LEFT) && textbox->cursorPos > 0) {
-        textbox->cursorPos--;
-        textbox->selectionStart = textbox->selectionEnd = -1;
-    }
-    if (IsKeyPressed(KEY_RIGHT) && textbox->cursorPos < textbox->textLength) {
-        textbox->cursorPos++;
-        textbox->selectionStart = textbox->selectionEnd = -1;
+    if (list->velocity != 0) {
+        float dt = inputFrameTime();
+        if (dt > 0.05f) dt = 0.05f;
+        list->offset += list->velocity * dt;
+        list->velocity *= expf(-SONG_SCROLL_FRICTION * dt);
+        if (fabsf(list->velocity) < SONG_SCROLL_REST) list->velocity = 0;
     }
 
-    if (IsKeyPressed(KEY_BACKSPACE) && textbox->textLength > 0) {
-        if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
-            int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-            int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-            int lenToRemove = end - start;
-            memmove(textbox->text + start, textbox->text + end, textbox->textLength - end + 1);
-            textbox->textLength -= lenToRemove;
-            textbox->cursorPos = start;
-            textbox->selectionStart = textbox->selectionEnd = -1;
-        } else if (textbox->cursorPos > 0) {
-            memmove(textbox->text + textbox->cursorPos - 1, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
-            textbox->textLength--;
-            textbox->cursorPos--;
-        }
-        textbox->backspaceTimer = 0.3f;
+    float maxOffset = rowCount * SONG_ROW_HEIGHT - list->bounds.height;
+    if (maxOffset < 0) maxOffset = 0;
+    if (list->offset <= 0 || list->offset >= maxOffset) {
+        list->offset = list->offset <= 0 ? 0 : maxOffset;
+        list->velocity = 0;
     }
 
-    if (IsKeyDown(KEY_BACKSPACE) && textbox->textLength > 0 && textbox->cursorPos > 0) {
-        textbox->backspaceTimer -= GetFrameTime();
-        if (textbox->backspaceTimer <= 0) {
-            memmove(textbox->text + textbox->cursorPos - 1, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
-            textbox->textLength--;
-            textbox->cursorPos--;
-            textbox->backspaceTimer = 0.05f;
-        }
-    }
+    int hoveredRow = songListRowAt(list, mousePosition, rowCount);
+    bool changed = list->offset != previousOffset || hoveredRow != list->hoveredRow;
+    list->hoveredRow = hoveredRow;
+    return changed;
+}
 
-    if (IsKeyReleased(KEY_BACKSPACE)) {
-        textbox->backspaceTimer = 0;
+// Bytes of a name that fit maxWidth, on a UTF-8 boundary, leaving room for "..."
+static int fitSongLabel(const char* name, float maxWidth) {
+    const GlyphAdvances* glyphs = glyphAdvances(italicGFS, 14);
+    int length = (int)strlen(name);
+    float* caretX = malloc(sizeof(float) * (length + 1));
+    if (!caretX) return length;
+    buildCaretOffsets(glyphs, name, length, caretX);
+    int fit = length;
+    if (caretX[length] > maxWidth) {
+        float available = maxWidth - textAdvance(glyphs, "...", 3);
+        while (fit > 0 && (caretX[fit] > available || ((unsigned char)name[fit] & 0xC0) == 0x80)) fit--;
     }
-
-    textbox->cursorBlink += GetFrameTime();
-    if (textbox->cursorBlink > 1.0f) textbox->cursorBlink = 0.0f;
+    free(caretX);
+    return fit;
 }
 
-// Input handling for dynamic textbox (paste area)
-void handleDynamicTextboxInput(DynamicTextbox* textbox) {
-    Vector2 mousePos = GetMousePosition();
-    bool mouseOver = CheckCollisionPointRec(mousePos, textbox->bounds);
-
-    if (mouseOver && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        textbox->selectionStart = -1;
-        textbox->selectionEnd = -1;
-        float xOffset = mousePos.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
-        float yOffset = mousePos.y - (textbox->bounds.y + 5) + textbox->verticalOffset;
-        int charIndex = 0;
-        char* line = strtok(strdup(textbox->text), "\n");
-        int lineNum = (int)(yOffset / (textbox->fontSize + 2));
-
-        for (int i = 0; i < lineNum && line; i++) {
-            charIndex += strlen(line) + 1;
-            line = strtok(NULL, "\n");
+// Draw the rows inside bounds, measuring each label the first time it shows
+void drawSongList(SongList* list, const SavedSong* songs, const int* rows, int rowCount) {
+    Rectangle bounds = list->bounds;
+    int firstRow = (int)(list->offset / SONG_ROW_HEIGHT);
+    int lastRow = (int)((list->offset + bounds.height) / SONG_ROW_HEIGHT);
+    if (lastRow >= rowCount) lastRow = rowCount - 1;
+
+    BeginScissorMode(bounds.x, bounds.y, bounds.width, bounds.height);
+    for (int row = firstRow; row <= lastRow; row++) {
+        int song = rows[row];
+        Rectangle songRect = { bounds.x + 5, bounds.y + row * SONG_ROW_HEIGHT - list->offset, bounds.width - 10, 24 };
+        DrawRectangleRounded(songRect, 0.5f, 6, row == list->hoveredRow ? toHex("#393F5F") : toHex("#222329"));
+
+        const char* name = songs[song].songName;
+        int fit = (int)strlen(name);
+        if (song < list->labelCount) {
+            if (list->labelFit[song] < 0) list->labelFit[song] = fitSongLabel(name, songRect.width - 10);
+            fit = list->labelFit[song];
         }
-
-        if (line) {
-            float lineWidth = MeasureTextEx(textbox->font, line, textbox->fontSize, 1).x;
-            int pos = (int)((xOffset / lineWidth) * strlen(line));
-            textbox->cursorPos = charIndex + (pos < strlen(line) ? pos : strlen(line));
+        Vector2 labelPosition = { songRect.x + 5, songRect.y + 5 };
+        useFontGlyphs(italicGFS, name, fit);
+        if (name[fit] == '\0') {
+            DrawTextEx(italicGFS, name, labelPosition, 14, 1, toHex("#D0D0D0"));
         } else {
-            textbox->cursorPos = textbox->textLength;
+            DrawTextEx(italicGFS, TextFormat("%.*s...", fit, name), labelPosition, 14, 1, toHex("#D0D0D0"));
         }
     }
+    EndScissorMode();
 
-    if (mouseOver && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-        float xOffset = mousePos.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
-        float yOffset = mousePos.y - (textbox->bounds.y + 5) + textbox->verticalOffset;
-        int lineNum = (int)(yOffset / (textbox->fontSize + 2));
-        int charIndex = 0;
-        char* line = strtok(strdup(textbox->text), "\n");
-
-        for (int i = 0; i < lineNum && line; i++) {
-            charIndex += strlen(line) + 1;
-            line = strtok(NULL, "\n");
-        }
-
-        if (line) {
-            float lineWidth = MeasureTextEx(textbox->font, line, textbox->fontSize, 1).x;
-            int pos = (int)((xOffset / lineWidth) * strlen(line));
-            textbox->selectionEnd = charIndex + (pos < strlen(line) ? pos : strlen(line));
-            if (textbox->selectionStart == -1) textbox->selectionStart = textbox->cursorPos;
-        }
+    // Scrollbar
+    float totalHeight = rowCount * SONG_ROW_HEIGHT;
+    if (totalHeight > bounds.height) {
+        float scrollBarHeight = bounds.height * bounds.height / totalHeight;
+        if (scrollBarHeight < 8) scrollBarHeight = 8;
+        float scrollBarY = bounds.y + (list->offset * (bounds.height - scrollBarHeight) / (totalHeight - bounds.height));
+        DrawRectangle(bounds.x + bounds.width - 5, scrollBarY, 3, scrollBarHeight, toHex("#494D5A"));
     }
+}
 
-    int key = GetCharPressed();
-    while (key > 0) {
-        if (textbox->textLength + 1 >= textbox->textCapacity) {
-            textbox->textCapacity *= 2;
-            textbox->text = realloc(textbox->text, textbox->textCapacity);
-        }
-        if (textbox->numericOnly) {
-            if (key >= '0' && key <= '9') { 
-                textbox->text[textbox->textLength++] = (char)key;
-                textbox->text[textbox->textLength] = '\0';
-                textbox->cursorPos++;
-            }
-        } else {
-            if ((key >= 32 && key <= 126) || key == '\n') {
-                textbox->text[textbox->textLength++] = (char)key;
-                textbox->text[textbox->textLength] = '\0';
-                textbox->cursorPos++;
-            }
+// Per-scope timings from the profiler rings: percentiles and a log-scale
+// histogram of durations, 1 us per bucket doubling to the right
+void drawProfilerOverlay(Vector2 position) {
+    const float rowHeight = 16;
+    const float barWidth = 3;
+    float width = 300 + PROFILE_HISTOGRAM_BUCKETS * barWidth;
+    DrawRectangle(position.x, position.y, width, rowHeight * (PROFILE_SCOPE_COUNT + 1) + 8, Fade(BLACK, 0.8f));
+    DrawTextEx(italicGFS, "scope           p50 / p99 / max ms", (Vector2){ position.x + 6, position.y + 4 }, 14, 1, toHex("#979EBB"));
+
+    for (int scope = 0; scope < PROFILE_SCOPE_COUNT; scope++) {
+        ProfileSummary summary;
+        profileSummarize(scope, &summary);
+        float y = position.y + 4 + rowHeight * (scope + 1);
+        DrawTextEx(italicGFS, profileScopeName(scope), (Vector2){ position.x + 6, y }, 14, 1, toHex("#D0D0D0"));
+        if (summary.count == 0) continue;
+        DrawTextEx(italicGFS, TextFormat("%.2f / %.2f / %.2f", summary.p50Ms, summary.p99Ms, summary.maxMs),
+                   (Vector2){ position.x + 100, y }, 14, 1, toHex("#D0D0D0"));
+
+        uint32_t tallest = 1;
+        for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++) {
+            if (summary.histogram[i] > tallest) tallest = summary.histogram[i];
         }
-        key = GetCharPressed();
-    }
-
-    if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_V)) {
-        const char* clipboard = GetClipboardText();
-        if (clipboard) {
-            int len = strlen(clipboard);
-            int newLength = textbox->textLength + len;
-            if (newLength + 1 > textbox->textCapacity) {
-                textbox->textCapacity = newLength + 256;
-                textbox->text = realloc(textbox->text, textbox->textCapacity);
-            }
-            char* cleanClipboard = malloc(len + 1);
-            int cleanLen = 0;
-            for (int i = 0; i < len; i++) {
-                if (clipboard[i] == '\r' && i + 1 < len && clipboard[i + 1] == '\n') {
-                    cleanClipboard[cleanLen++] = '\n';
-                    i++;
-                } else if (clipboard[i] != '\r') {
-                    cleanClipboard[cleanLen++] = clipboard[i];
-                }
-            }
-            cleanClipboard[cleanLen] = '\0';
-
-            if (textbox->numericOnly) {
-                for (int i = 0; i < cleanLen; i++) {
-                    if (cleanClipboard[i] >= '0' && cleanClipboard[i] <= '9') {
-                        textbox->text[textbox->textLength++] = cleanClipboard[i];
-                        textbox->cursorPos++;
-                    }
-                }
-            } else {
-                memcpy(textbox->text + textbox->textLength, cleanClipboard, cleanLen);
-                textbox->textLength += cleanLen;
-                textbox->cursorPos += cleanLen;
-            }
-            textbox->text[textbox->textLength] = '\0';
-            free(cleanClipboard);
+        for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++) {
+            float height = summary.histogram[i] ? 1 + (rowHeight - 4) * summary.histogram[i] / tallest : 0;
+            DrawRectangle(position.x + 294 + i * barWidth, y + rowHeight - 2 - height, barWidth - 1, height, toHex("#393F5F"));
         }
     }
+}
 
-    if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_A)) {
-        textbox->selectionStart = 0;
-        textbox->selectionEnd = textbox->textLength;
-        textbox->cursorPos = textbox->textLength;
-    }
-
-    if (IsKeyPressed(KEY_LEFT) && textbox->cursorPos > 0) {
-        textbox->cursorPos--;
-        textbox->selectionStart = textbox->selectionEnd = -1;
-    }
-    if (IsKeyPressed(KEY_RIGHT) && textbox->cursorPos < textbox->textLength) {
-        textbox->cursorPos++;
-        textbox->selectionStart = textbox->selectionEnd = -1;
+// Warm the loader with a row and its neighbours
+void prefetchSongRows(SongLoader* loader, const SavedSong* songs, const int* rows, int rowCount, int centerRow) {
+    static const int order[] = { 0, 1, -1 };
+    for (int i = 0; i < 3; i++) {
+        int row = centerRow + order[i];
+        if (row >= 0 && row < rowCount) songLoaderRequest(loader, songs[rows[row]].filename, false);
     }
+}
 
-    if (IsKeyPressed(KEY_BACKSPACE) && textbox->textLength > 0) {
-        if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
-            int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-            int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
-            int lenToRemove = end - start;
-            memmove(textbox->text + start, textbox->text + end, textbox->textLength - end + 1);
-            textbox->textLength -= lenToRemove;
-            textbox->cursorPos = start;
-            textbox->selectionStart = textbox->selectionEnd = -1;
-        } else if (textbox->cursorPos > 0) {
-            memmove(textbox->text + textbox->cursorPos - 1, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
-            textbox->textLength--;
-            textbox->cursorPos--;
-        }
-        textbox->backspaceTimer = 0.3f;
+// Put a loaded song in the paste area and bpm box. Its precompiled sheet
+// replaces pasteSheet, so nothing is tokenized on this thread.
+bool showLoadedSong(LoadedSong* loaded, DynamicTextbox* pasteArea, Sheet* pasteSheet, Textbox* bpmBox) {
+    if (!loaded->valid) {
+        freeLoadedSong(loaded);
+        return false;
     }
-
-    if (IsKeyDown(KEY_BACKSPACE) && textbox->textLength > 0 && textbox->cursorPos > 0) {
-        textbox->backspaceTimer -= GetFrameTime();
-        if (textbox->backspaceTimer <= 0) {
-            memmove(textbox->text + textbox->cursorPos - 1, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
-            textbox->textLength--;
-            textbox->cursorPos--;
-            textbox->backspaceTimer = 0.05f;
-        }
+    int length = loaded->song.sheetLength;
+    if (!setDynamicTextboxText(pasteArea, loaded->song.sheet, length)) {
+        freeLoadedSong(loaded);
+        return false;
     }
-
-    if (IsKeyReleased(KEY_BACKSPACE)) {
-        textbox->backspaceTimer = 0;
-    }
-
-    textbox->cursorBlink += GetFrameTime();
-    if (textbox->cursorBlink > 1.0f) textbox->cursorBlink = 0.0f;
+    if (pasteArea->cursorPos > length) pasteArea->cursorPos = length;
+    pasteArea->selectionStart = -1;
+    pasteArea->selectionEnd = -1;
+    pasteArea->editStart = -1;
+
+    freeSheet(pasteSheet);
+    *pasteSheet = loaded->sheet;
+    memset(&loaded->sheet, 0, sizeof(loaded->sheet));
+
+    if (loaded->song.bpm > 0) snprintf(bpmBox->text, sizeof(bpmBox->text), "%d", loaded->song.bpm);
+    else bpmBox->text[0] = '\0';
+    bpmBox->textLength = strlen(bpmBox->text);
+    if (bpmBox->cursorPos > bpmBox->textLength) bpmBox->cursorPos = bpmBox->textLength;
+
+    freeLoadedSong(loaded);
+    return true;
 }
 
-// Sanitize filename by replacing invalid characters
-char* sanitizeFilename(const char* input) {
-    char* output = strdup(input);
-    for (int i = 0; output[i]; i++) {
-        if (strchr("\\/:*?\"<>|", output[i])) {
-            output[i] = '_';
-        }
-    }
-    return output;
+// Record what a textbox shows now; returns true if that changed since the last call
+bool updateTextboxView(TextboxView* view, int textLength, int cursorPos, int selectionStart, int selectionEnd,
+                       float verticalOffset, bool editing, float cursorBlink) {
+    TextboxView current = { textLength, cursorPos, selectionStart, selectionEnd, verticalOffset,
+                            editing, editing && cursorBlink < 0.5f };
+    bool changed = current.textLength != view->textLength || current.cursorPos != view->cursorPos ||
+                   current.selectionStart != view->selectionStart || current.selectionEnd != view->selectionEnd ||
+                   current.verticalOffset != view->verticalOffset || current.editing != view->editing ||
+                   current.caretVisible != view->caretVisible;
+    *view = current;
+    return changed;
 }
 
-// Load saved songs from noctivoxFiles directory
-void loadSavedSongs(SavedSong** songs, int* songCount, const char* directory) {
-    FilePathList files = LoadDirectoryFiles(directory);
-    *songCount = 0;
-    *songs = NULL;
-
-    for (int i = 0; i < files.count; i++) {
-        if (IsFileExtension(files.paths[i], ".json")) {
-            char* content = LoadFileText(files.paths[i]);
-            if (content) {
-                char* songNameStart = strstr(content, "\"songName\": \"");
-                if (songNameStart) {
-                    songNameStart += 12; // Skip past '"songName": "'
-                    char* songNameEnd = strchr(songNameStart, '"');
-                    if (songNameEnd) {
-                        int songNameLen = songNameEnd - songNameStart;
-                        *songs = realloc(*songs, (*songCount + 1) * sizeof(SavedSong));
-                        (*songs)[*songCount].filename = strdup(files.paths[i]);
-                        (*songs)[*songCount].songName = malloc(songNameLen + 1);
-                        strncpy((*songs)[*songCount].songName, songNameStart, songNameLen);
-                        (*songs)[*songCount].songName[songNameLen] = '\0';
-                        (*songCount)++;
-                    }
-                }
-                UnloadFileText(content);
-            }
+int main(int argc, char** argv) {
+    // Headless mode: noctivox --render <song.json> <out.wav>
+    if (argc > 1 && strcmp(argv[1], "--render") == 0) {
+        if (argc != 4) {
+            fprintf(stderr, "usage: %s --render <song.json> <out.wav>\n", argv[0]);
+            return 1;
         }
+        return renderSong(argv[2], argv[3]) ? 0 : 1;
     }
-    UnloadDirectoryFiles(files);
-    TraceLog(LOG_INFO, "Loaded %d songs from %s", *songCount, directory);
-}
 
-// Free memory allocated for saved songs
-void freeSavedSongs(SavedSong* songs, int songCount) {
-    for (int i = 0; i < songCount; i++) {
-        free(songs[i].filename);
-        free(songs[i].songName);
+    // Input logs: noctivox --record <input.log>, or
+    // noctivox --replay <input.log> [frame-times.csv] to play one back in a
+    // hidden window as fast as frames render
+    if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        if (!startInputRecording(argv[2])) return 1;
+    } else if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        if (!startInputReplay(argv[2], argc > 3 ? argv[3] : NULL)) return 1;
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
     }
-    free(songs);
-}
 
-// Generate a unique filename by appending (1), (2), etc.
-char* getUniqueFilename(const char* baseName, const char* directory) {
-    char* sanitizedBase = sanitizeFilename(baseName);
-    char* filename = malloc(512);
-#ifdef _WIN32
-    snprintf(filename, 512, "%s\\%s.json", directory, sanitizedBase);
-#else
-    snprintf(filename, 512, "%s/%s.json", directory, sanitizedBase);
-#endif
-    if (!FileExists(filename)) {
-        free(sanitizedBase);
-        return filename;
-    }
-
-    int counter = 1;
-    do {
-        free(filename);
-        filename = malloc(512);
-#ifdef _WIN32
-        snprintf(filename, 512, "%s\\%s(%d).json", directory, sanitizedBase, counter);
-#else
-        snprintf(filename, 512, "%s/%s(%d).json", directory, sanitizedBase, counter);
-#endif
-        counter++;
-    } while (FileExists(filename));
-
-    free(sanitizedBase);
-    return filename;
-}
-
-// Gaussian blur fragment shader
-const char* blurShaderCode = 
-    "#version 330\n"
-    "in vec2 fragTexCoord;\n"
-    "out vec4 fragColor;\n"
-    "uniform sampler2D texture0;\n"
-    "uniform vec2 resolution;\n"
-    "void main() {\n"
-    "    vec2 texelSize = 1.0 / resolution;\n"
-    "    vec4 color = vec4(0.0);\n"
-    "    float weights[3] = float[](0.3, 0.2, 0.2);\n" 
-    "    color += texture(texture0, fragTexCoord) * weights[0];\n"
-    "    color += texture(texture0, fragTexCoord + vec2(texelSize.x, 0.0)) * weights[1];\n"
-    "    color += texture(texture0, fragTexCoord - vec2(texelSize.x, 0.0)) * weights[1];\n"
-    "    color += texture(texture0, fragTexCoord + vec2(0.0, texelSize.y)) * weights[1];\n"
-    "    color += texture(texture0, fragTexCoord - vec2(0.0, texelSize.y)) * weights[1];\n"
-    "    fragColor = color * 0.8f;\n"
-    "}";
-
-int main(void) {
     const int screenWidth = 720;
     const int screenHeight = 360;
     InitWindow(screenWidth, screenHeight, "noctivox | a virtual piano player");
-    SetTargetFPS(60);
-    SetTraceLogLevel(LOG_ALL); // Enable all logging for debugging
+    SetTargetFPS(inputReplaying() ? 0 : 60);
+    SetTraceLogLevel(LOG_INFO); // Timings live in the profiler overlay (F3), not the log
+    initProfiler();
+    startEventWake(); // Lets timers and worker threads end an idle wait
 
     loadFonts();
 
@@ -656,6 +402,14 @@ int main(void) {
     RenderTexture2D sceneTexture = LoadRenderTexture(screenWidth, screenHeight);
     bool sceneTextureNeedsUpdate = true;
 
+    // The upload panel composites two cached layers: the scene blurred once
+    // when the panel opens, and the panel itself, redrawn part by part
+    RenderTexture2D blurTexture = LoadRenderTexture(screenWidth, screenHeight);
+    RenderTexture2D panelTexture = LoadRenderTexture(screenWidth, screenHeight);
+    bool blurTextureNeedsUpdate = true;
+    unsigned int panelDirty = PANEL_ALL;
+    unsigned int panelHover = 0;
+
     Shader blurShader = LoadShaderFromMemory(0, blurShaderCode);
     int resolutionLoc = GetShaderLocation(blurShader, "resolution");
     float resolution[2] = { (float)screenWidth, (float)screenHeight };
@@ -673,10 +427,26 @@ int main(void) {
 
     // Dynamic textbox for paste area
     DynamicTextbox pasteAreaInput = { 
-        { 170, 90, 380, 120 }, malloc(256), 0, 256, false, 0.0f, 
-        false, italicGFS, 14, 0, 0, 0, "", 0, -1, -1 
+        { 170, 90, 380, 120 }, malloc(256), 0, 256, 0, 256, false, 0.0f, 
+        false, italicGFS, 14, 0, 0, 0, "", 0, -1, -1, -1, 0, 0 
     };
-    pasteAreaInput.text[0] = '\0';
+    setDynamicTextboxText(&pasteAreaInput, "", 0);
+
+    // Compiled note timeline of the paste area, updated line by line as it is edited
+    Sheet pasteSheet = { 0 };
+    sheetCompile(&pasteSheet, dynamicTextboxText(&pasteAreaInput), pasteAreaInput.textLength);
+
+    // Synth output, or the sampled piano NOCTIVOX_PIANO points at (an .sfz file),
+    // through the reverb when NOCTIVOX_REVERB names an impulse response;
+    // NOCTIVOX_NULL_AUDIO discards it for machines without a sound card
+    AudioEngine* audio = createAudioEngine(getenv("NOCTIVOX_NULL_AUDIO") != NULL || inputReplaying(), getenv("NOCTIVOX_PIANO"));
+
+    // Playback runs on its own thread; the sheet is snapshotted into it on play
+    Playback* player = createPlayback(audio ? audioNoteSink : NULL, audio);
+    bool playerNeedsLoad = true;
+    int playerBpm = 0;
+    int loopFirstBar = -1;          // A/B loop marks in bars, -1 when unset
+    int loopLastBar = -1;
 
     // Fixed-size textboxes for upload panel
     Textbox songNameInput = { 
@@ -694,30 +464,62 @@ int main(void) {
     Rectangle saveButton = { 454, 276, 96, 30 };
     bool isUploadVisible = false;
     char* selectedMidiPath = NULL;
+    Rectangle panelRegions[PANEL_WIDGET_COUNT] = {
+        [PANEL_BACKGROUND] = uploadPanel,
+        [PANEL_PASTE_AREA] = pasteAreaInput.bounds,
+        [PANEL_SONG_NAME] = songNameInput.bounds,
+        [PANEL_BPM] = bpmValueInput.bounds,
+        [PANEL_CANCEL] = cancelButton,
+        [PANEL_SAVE] = saveButton,
+        [PANEL_NOTE_COUNT] = { 394, 212, 84, 14 },
+        [PANEL_MIDI_PATH] = { 170, 250, 380, 16 },
+        [PANEL_DROP_HINT] = { 394, 74, 156, 16 },
+        [PANEL_RECORDING] = { 296, 74, 94, 16 }
+    };
+    TextboxView pasteAreaView = { 0 };
+    TextboxView songNameView = { 0 };
+    TextboxView bpmInputView = { 0 };
+    bool panelCanSave = false;
+    int panelNoteCount = 0;
+    Timeline midiTimeline = { 0 }; // Parsed notes of the dropped .mid file
 
-    char songName[64] = "";
     int bpm = 100;
 
     // Saved songs list
     SavedSong* savedSongs = NULL;
     int songCount = 0;
-    float songListOffset = 0.0f; // Vertical scroll offset for song list
-    Rectangle songListBounds = { 14, 90, 180, 270 }; // Scrolling frame area
-
-    // Setup noctivoxFiles directory
+    SongSearch songSearch = { 0 };  // Index over savedSongs; results are the rows shown
+    bool libraryChanged = true;     // savedSongs changed since the index was built
+    char songQuery[SEARCH_QUERY_MAX] = ""; // Search text the results were computed for
+    SongList songList = { .bounds = { 14, 90, 180, 270 }, .hoveredRow = -1 };
+    // Parses selected and nearby songs off this thread. Replays load on this
+    // thread instead, so a song is shown on the same frame it was recorded on.
+    SongLoader* songLoader = inputReplaying() ? NULL : createSongLoader();
+    int prefetchedRow = -1;         // Hovered row the loader was last warmed around
+    bool wasEditingBase = false;    // A base-layer textbox was active last frame
+    bool showProfiler = false;      // F3 toggles the timing overlay, F4 dumps the samples to CSV
+    KeyRecorder* keyRecorder = NULL; // F5 records the keyboard into the paste area
+    int panelRecordedCount = -1;    // Notes shown by the recording indicator (-1 when hidden)
+
+    // Setup noctivoxFiles directory; NOCTIVOX_LIBRARY points replays at a fixed library
     char noctivoxDir[512];
+    const char* libraryDir = getenv("NOCTIVOX_LIBRARY");
     const char* homeDir = getenv("USERPROFILE"); // Windows
     if (!homeDir) homeDir = getenv("HOME");      // Unix-like
-    if (!homeDir) {
+    if (!homeDir && !libraryDir) {
         homeDir = GetWorkingDirectory();
         TraceLog(LOG_WARNING, "No HOME or USERPROFILE found, using working directory: %s", homeDir);
     }
 
+    if (libraryDir) {
+        snprintf(noctivoxDir, sizeof(noctivoxDir), "%s", libraryDir);
+    } else {
 #ifdef _WIN32
-    snprintf(noctivoxDir, sizeof(noctivoxDir), "%s\\Downloads\\noctivoxFiles", homeDir);
+        snprintf(noctivoxDir, sizeof(noctivoxDir), "%s\\Downloads\\noctivoxFiles", homeDir);
 #else
-    snprintf(noctivoxDir, sizeof(noctivoxDir), "%s/Downloads/noctivoxFiles", homeDir);
+        snprintf(noctivoxDir, sizeof(noctivoxDir), "%s/Downloads/noctivoxFiles", homeDir);
 #endif
+    }
 
     if (!DirectoryExists(noctivoxDir)) {
         int result = MakeDirectory(noctivoxDir);
@@ -738,21 +540,75 @@ int main(void) {
     } else {
         TraceLog(LOG_INFO, "Directory already exists: %s", noctivoxDir);
     }
+    // Started before the first scan so nothing copied in meanwhile is missed
+    LibraryWatcher* libraryWatcher = createLibraryWatcher(noctivoxDir);
+    double scanStarted = profileBegin();
     loadSavedSongs(&savedSongs, &songCount, noctivoxDir);
+    profileEnd(PROFILE_LIBRARY_IO, scanStarted);
 
     while (!WindowShouldClose()) {
-        Vector2 mousePosition = GetMousePosition();
+        if (!beginInputFrame()) break; // The replayed log ran out
+        double frameStarted = profileBegin();
+        double inputLibraryTime = 0;    // Library I/O started by input, timed on its own
+        Vector2 mousePosition = inputMousePosition();
+        nextGlyphFrame();
+
+        if (inputKeyPressed(KEY_F3)) showProfiler = !showProfiler;
+        if (inputKeyPressed(KEY_F4)) {
+            const char* csvPath = TextFormat("noctivox-profile-%ld.csv", (long)time(NULL));
+            if (writeProfileCsv(csvPath)) TraceLog(LOG_INFO, "Wrote profile samples to: %s", csvPath);
+            else TraceLog(LOG_ERROR, "Failed to write profile samples to: %s", csvPath);
+        }
 
-        if (IsFileDropped() && isUploadVisible) {
-            FilePathList droppedFiles = LoadDroppedFiles();
+        // Keyboard recording runs while the upload panel is open. Stopping it
+        // writes the notes in at the paste area cursor, quantized to the
+        // panel's bpm (or the playback bpm when that is empty).
+        if (!keyRecorder && isUploadVisible && inputKeyPressed(KEY_F5)) {
+            keyRecorder = startKeyRecording();
+        } else if (keyRecorder && (!isUploadVisible || inputKeyPressed(KEY_F5))) {
+            // Into an empty paste area the recording may pick a finer step
+            // and bpm; next to existing notes it keeps their tempo
+            int panelBpm = atoi(bpmValueInput.text);
+            int recordBpm = panelBpm > 0 ? panelBpm : bpm;
+            int selected = pasteAreaInput.selectionStart >= 0 && pasteAreaInput.selectionEnd >= 0 ?
+                           abs(pasteAreaInput.selectionEnd - pasteAreaInput.selectionStart) : 0;
+            int subdivision = pasteAreaInput.textLength == selected ? RECORD_MAX_SUBDIVISION : 1;
+            int length = 0;
+            char* recorded = finishKeyRecording(keyRecorder, &recordBpm, subdivision, &length);
+            keyRecorder = NULL;
+            if (recorded) {
+                deleteDynamicTextboxSelection(&pasteAreaInput);
+                if (insertDynamicTextboxText(&pasteAreaInput, pasteAreaInput.cursorPos, recorded, length)) {
+                    pasteAreaInput.cursorPos += length;
+                }
+                if (recordBpm != panelBpm) {
+                    snprintf(bpmValueInput.text, sizeof(bpmValueInput.text), "%d", recordBpm);
+                    bpmValueInput.textLength = (int)strlen(bpmValueInput.text);
+                    bpmValueInput.cursorPos = bpmValueInput.textLength;
+                    panelDirty |= PANEL_BIT(PANEL_BPM);
+                }
+                free(recorded);
+            }
+        }
+        if (keyRecorder) updateKeyRecording(keyRecorder);
+
+        if (inputFileDropped() && isUploadVisible) {
+            FilePathList droppedFiles = inputDroppedFiles();
             for (int i = 0; i < droppedFiles.count; i++) {
-                if (IsFileExtension(droppedFiles.paths[i], ".mid")) {
-                    if (selectedMidiPath) free(selectedMidiPath);
-                    selectedMidiPath = strdup(droppedFiles.paths[i]);
+                if (IsFileExtension(droppedFiles.paths[i], ".mid;.midi")) {
+                    Timeline parsed;
+                    if (loadMidiFile(droppedFiles.paths[i], &parsed)) {
+                        if (selectedMidiPath) free(selectedMidiPath);
+                        selectedMidiPath = strdup(droppedFiles.paths[i]);
+                        freeTimeline(&midiTimeline);
+                        midiTimeline = parsed;
+                        panelDirty |= PANEL_BIT(PANEL_MIDI_PATH) | PANEL_BIT(PANEL_DROP_HINT);
+                    } else {
+                        TraceLog(LOG_WARNING, "Ignoring unreadable MIDI file: %s", droppedFiles.paths[i]);
+                    }
                     break;
                 }
             }
-            UnloadDroppedFiles(droppedFiles);
         }
 
         bool canSave = (pasteAreaInput.textLength > 0 || selectedMidiPath != NULL) && 
@@ -760,7 +616,7 @@ int main(void) {
                        bpmValueInput.textLength > 0 && atoi(bpmValueInput.text) > 0;
 
         if (isUploadVisible) {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            if (inputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                 bool wasEditing = pasteAreaInput.editing || songNameInput.editing || bpmValueInput.editing;
                 pasteAreaInput.editing = CheckCollisionPointRec(mousePosition, pasteAreaInput.bounds);
                 songNameInput.editing = CheckCollisionPointRec(mousePosition, songNameInput.bounds);
@@ -775,32 +631,37 @@ int main(void) {
                     char baseName[256];
                     snprintf(baseName, sizeof(baseName), "%s_%s", songNameInput.text, bpmValueInput.text);
                     char* filename = getUniqueFilename(baseName, noctivoxDir);
-                    FILE* file = fopen(filename, "w");
-                    if (file) {
-                        fprintf(file, "{\n");
-                        fprintf(file, "  \"songName\": \"%s\",\n", songNameInput.text);
-                        fprintf(file, "  \"BPM\": \"%s\",\n", bpmValueInput.text);
-                        fprintf(file, "  \"songInfo\": \"");
-                        for (int i = 0; i < pasteAreaInput.textLength; i++) {
-                            if (pasteAreaInput.text[i] == '\n') fputs("\\n", file);
-                            else if (pasteAreaInput.text[i] == '"') fputs("\\\"", file);
-                            else fputc(pasteAreaInput.text[i], file);
-                        }
-                        fprintf(file, "\"\n}\n");
-                        fclose(file);
-                        if (FileExists(filename)) {
-                            TraceLog(LOG_INFO, "Successfully saved song to: %s", filename);
-                        } else {
-                            TraceLog(LOG_ERROR, "File not found after save: %s", filename);
+
+                    // Keep a copy of the dropped MIDI beside the song so it survives the original moving
+                    char midiFilename[512] = "";
+                    if (selectedMidiPath) {
+                        snprintf(midiFilename, sizeof(midiFilename), "%.*s.mid", (int)strlen(filename) - 5, filename);
+                        int midiSize = 0;
+                        unsigned char* midiData = LoadFileData(selectedMidiPath, &midiSize);
+                        if (!midiData || !SaveFileData(midiFilename, midiData, midiSize)) {
+                            TraceLog(LOG_ERROR, "Failed to copy MIDI file to: %s", midiFilename);
+                            midiFilename[0] = '\0';
                         }
-                    } else {
-                        TraceLog(LOG_ERROR, "Failed to open file for writing: %s", filename);
+                        if (midiData) UnloadFileData(midiData);
+                    }
+
+                    Song written = { songNameInput.text, atoi(bpmValueInput.text), dynamicTextboxText(&pasteAreaInput),
+                                     pasteAreaInput.textLength, midiFilename[0] ? midiFilename : NULL };
+                    double saveStarted = profileBegin();
+                    if (saveSong(filename, &written)) {
+                        TraceLog(LOG_INFO, "Successfully saved song to: %s", filename);
+                        // Compile the .nvx sidecar now so the first open is a page-in, not a parse
+                        writeCompiledSong(filename, &written, &pasteSheet);
                     }
-                    free(filename);
 
-                    // Reload saved songs
-                    freeSavedSongs(savedSongs, songCount);
-                    loadSavedSongs(&savedSongs, &songCount, noctivoxDir);
+                    // Insert the new song in place; the watcher will see the same file and agree
+                    SavedSong saved;
+                    if (readSavedSong(filename, &saved)) {
+                        applySavedSongChanges(&savedSongs, &songCount, &saved, 1);
+                        libraryChanged = true;
+                    }
+                    inputLibraryTime += profileEnd(PROFILE_LIBRARY_IO, saveStarted);
+                    free(filename);
 
                     isUploadVisible = false;
                     sceneTextureNeedsUpdate = true;
@@ -811,15 +672,16 @@ int main(void) {
                 if (bpmValueInput.editing && !wasEditing) bpmValueInput.cursorPos = bpmValueInput.textLength;
             }
 
-            if (IsKeyPressed(KEY_ENTER)) {
+            if (inputKeyPressed(KEY_ENTER)) {
                 pasteAreaInput.editing = false;
                 songNameInput.editing = false;
                 bpmValueInput.editing = false;
             }
 
-            if (pasteAreaInput.editing) handleDynamicTextboxInput(&pasteAreaInput);
-            if (songNameInput.editing) handleTextboxInput(&songNameInput, false);
-            if (bpmValueInput.editing) handleTextboxInput(&bpmValueInput, false);
+            // Keys play notes while recording, so the textboxes ignore them
+            if (pasteAreaInput.editing && !keyRecorder) handleDynamicTextboxInput(&pasteAreaInput);
+            if (songNameInput.editing && !keyRecorder) handleTextboxInput(&songNameInput, false);
+            if (bpmValueInput.editing && !keyRecorder) handleTextboxInput(&bpmValueInput, false);
 
             if (pasteAreaInput.editing || songNameInput.editing || bpmValueInput.editing) {
                 SetMouseCursor(MOUSE_CURSOR_IBEAM);
@@ -837,7 +699,7 @@ int main(void) {
                 SetMouseCursor(MOUSE_CURSOR_DEFAULT);
             }
         } else {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            if (inputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                 bool wasEditing = songSearchInput.editing || bpmValueEdit.editing;
                 songSearchInput.editing = CheckCollisionPointRec(mousePosition, songSearchInput.bounds);
                 bpmValueEdit.editing = CheckCollisionPointRec(mousePosition, bpmValueEdit.bounds);
@@ -845,73 +707,28 @@ int main(void) {
                 if (CheckCollisionPointRec(mousePosition, plusButton)) {
                     isUploadVisible = true;
                     sceneTextureNeedsUpdate = false;
+                    blurTextureNeedsUpdate = true;
+                    panelDirty = PANEL_ALL;
                 }
 
                 // Check for song selection in the scrolling list
-                if (CheckCollisionPointRec(mousePosition, songListBounds)) {
-                    float yOffset = mousePosition.y - songListBounds.y + songListOffset;
-                    int songHeight = 30;
-                    int selectedIndex = (int)(yOffset / songHeight);
-                    if (selectedIndex >= 0 && selectedIndex < songCount) {
-                        char* content = LoadFileText(savedSongs[selectedIndex].filename);
-                        if (content) {
-                            char* songNameStart = strstr(content, "\"songName\": \"");
-                            char* bpmStart = strstr(content, "\"BPM\": \"");
-                            char* songInfoStart = strstr(content, "\"songInfo\": \"");
-                            if (songNameStart && bpmStart && songInfoStart) {
-                                songNameStart += 12;
-                                bpmStart += 7;
-                                songInfoStart += 12;
-                                char* songNameEnd = strchr(songNameStart, '"');
-                                char* bpmEnd = strchr(bpmStart, '"');
-                                char* songInfoEnd = strchr(songInfoStart, '"');
-                                if (songNameEnd && bpmEnd && songInfoEnd) {
-                                    // Load song name
-                                    int songNameLen = songNameEnd - songNameStart;
-                                    strncpy(songSearchInput.text, songNameStart, songNameLen);
-                                    songSearchInput.text[songNameLen] = '\0';
-                                    songSearchInput.textLength = songNameLen;
-
-                                    // Load BPM
-                                    int bpmLen = bpmEnd - bpmStart;
-                                    strncpy(bpmValueEdit.text, bpmStart, bpmLen);
-                                    bpmValueEdit.text[bpmLen] = '\0';
-                                    bpmValueEdit.textLength = bpmLen;
-
-                                    // Load song info into paste area
-                                    int songInfoLen = songInfoEnd - songInfoStart;
-                                    char* tempSongInfo = malloc(songInfoLen + 1);
-                                    strncpy(tempSongInfo, songInfoStart, songInfoLen);
-                                    tempSongInfo[songInfoLen] = '\0';
-
-                                    // Unescape songInfo
-                                    char* unescaped = malloc(songInfoLen + 1);
-                                    int unescapedLen = 0;
-                                    for (int i = 0; i < songInfoLen; i++) {
-                                        if (tempSongInfo[i] == '\\' && i + 1 < songInfoLen) {
-                                            if (tempSongInfo[i + 1] == 'n') unescaped[unescapedLen++] = '\n';
-                                            else if (tempSongInfo[i + 1] == '"') unescaped[unescapedLen++] = '"';
-                                            i++;
-                                        } else {
-                                            unescaped[unescapedLen++] = tempSongInfo[i];
-                                        }
-                                    }
-                                    unescaped[unescapedLen] = '\0';
-
-                                    if (unescapedLen + 1 > pasteAreaInput.textCapacity) {
-                                        pasteAreaInput.textCapacity = unescapedLen + 256;
-                                        pasteAreaInput.text = realloc(pasteAreaInput.text, pasteAreaInput.textCapacity);
-                                    }
-                                    strcpy(pasteAreaInput.text, unescaped);
-                                    pasteAreaInput.textLength = unescapedLen;
-
-                                    free(tempSongInfo);
-                                    free(unescaped);
-                                    sceneTextureNeedsUpdate = true;
-                                    TraceLog(LOG_INFO, "Loaded song: %s", savedSongs[selectedIndex].songName);
-                                }
+                if (CheckCollisionPointRec(mousePosition, songList.bounds)) {
+                    int selectedRow = songListRowAt(&songList, mousePosition, songSearch.resultCount);
+                    if (selectedRow >= 0) {
+                        const char* path = savedSongs[songSearch.results[selectedRow]].filename;
+                        if (songLoader) {
+                            songLoaderRequest(songLoader, path, true);
+                            prefetchSongRows(songLoader, savedSongs, songSearch.results, songSearch.resultCount, selectedRow);
+                        } else {
+                            LoadedSong loaded;
+                            double readStarted = profileBegin();
+                            readLoadedSong(path, &loaded);
+                            inputLibraryTime += profileEnd(PROFILE_LIBRARY_IO, readStarted);
+                            if (showLoadedSong(&loaded, &pasteAreaInput, &pasteSheet, &bpmValueEdit)) {
+                                playerNeedsLoad = true;
+                                loopFirstBar = loopLastBar = -1;    // Loop marks belong to the previous song
+                                sceneTextureNeedsUpdate = true;
                             }
-                            UnloadFileText(content);
                         }
                     }
                 }
@@ -920,21 +737,14 @@ int main(void) {
                 if (bpmValueEdit.editing && !wasEditing) bpmValueEdit.cursorPos = bpmValueEdit.textLength;
             }
 
-            // Handle scrolling in the song list
-            if (CheckCollisionPointRec(mousePosition, songListBounds)) {
-                float wheel = GetMouseWheelMove();
-                if (wheel != 0) {
-                    float totalHeight = songCount * 30; // Each song is 30px tall
-                    float maxHeight = songListBounds.height;
-                    songListOffset -= wheel * 20.0f;
-                    if (songListOffset < 0) songListOffset = 0;
-                    if (totalHeight > maxHeight && songListOffset > totalHeight - maxHeight) {
-                        songListOffset = totalHeight - maxHeight;
-                    }
-                }
+            // Scroll the song list and track the hovered row
+            if (updateSongList(&songList, songSearch.resultCount, mousePosition)) sceneTextureNeedsUpdate = true;
+            if (songList.hoveredRow != prefetchedRow) {
+                prefetchedRow = songList.hoveredRow;
+                if (songLoader) prefetchSongRows(songLoader, savedSongs, songSearch.results, songSearch.resultCount, prefetchedRow);
             }
 
-            if (IsKeyPressed(KEY_ENTER)) {
+            if (inputKeyPressed(KEY_ENTER)) {
                 if (songSearchInput.editing && songSearchInput.textLength == 0) {
                     strcpy(songSearchInput.text, songSearchInput.placeholder);
                     songSearchInput.textLength = strlen(songSearchInput.placeholder);
@@ -953,23 +763,109 @@ int main(void) {
 
             if (songSearchInput.editing) handleTextboxInput(&songSearchInput, false);
             if (bpmValueEdit.editing) handleTextboxInput(&bpmValueEdit, false);
+            if (songSearchInput.editing || bpmValueEdit.editing || wasEditingBase) sceneTextureNeedsUpdate = true;
+            wasEditingBase = songSearchInput.editing || bpmValueEdit.editing;
+
+            // Space plays/pauses the loaded sheet, Home rewinds, left/right
+            // step a bar, [ and ] mark the loop's first and last bar and
+            // backslash clears the loop
+            if (player && !songSearchInput.editing && !bpmValueEdit.editing) {
+                bool loopChanged = false;
+                if (inputKeyPressed(KEY_LEFT_BRACKET)) {
+                    loopFirstBar = playbackBar(player);
+                    if (loopLastBar < loopFirstBar) loopLastBar = loopFirstBar;
+                    loopChanged = true;
+                }
+                if (inputKeyPressed(KEY_RIGHT_BRACKET)) {
+                    loopLastBar = playbackBar(player);
+                    if (loopFirstBar < 0 || loopFirstBar > loopLastBar) loopFirstBar = loopLastBar;
+                    loopChanged = true;
+                }
+                if (inputKeyPressed(KEY_BACKSLASH)) {
+                    loopFirstBar = loopLastBar = -1;
+                    loopChanged = true;
+                }
+
+                bool wantsPlayer = inputKeyPressed(KEY_SPACE) || inputKeyPressed(KEY_LEFT) || inputKeyPressed(KEY_RIGHT);
+                if (wantsPlayer && playerNeedsLoad && !playbackIsPlaying(player)) {
+                    playbackLoad(player, &pasteSheet.timeline);
+                    playerNeedsLoad = false;
+                    loopChanged = true;
+                }
+                if (loopChanged) playbackSetLoop(player, loopFirstBar, loopLastBar);
+
+                if (inputKeyPressed(KEY_SPACE)) {
+                    if (playbackIsPlaying(player)) playbackPause(player);
+                    else playbackPlay(player);
+                }
+                if (inputKeyPressed(KEY_HOME)) playbackSeek(player, 0);
+                if (inputKeyPressed(KEY_LEFT)) playbackSeekBar(player, playbackBar(player) - 1);
+                if (inputKeyPressed(KEY_RIGHT)) playbackSeekBar(player, playbackBar(player) + 1);
+            }
 
             if (songSearchInput.editing || bpmValueEdit.editing) {
                 SetMouseCursor(MOUSE_CURSOR_IBEAM);
             } else if (CheckCollisionPointRec(mousePosition, songSearchInput.bounds) ||
                        CheckCollisionPointRec(mousePosition, bpmValueEdit.bounds) ||
                        CheckCollisionPointRec(mousePosition, plusButton) ||
-                       CheckCollisionPointRec(mousePosition, songListBounds)) {
+                       CheckCollisionPointRec(mousePosition, songList.bounds)) {
                 SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
             } else {
                 SetMouseCursor(MOUSE_CURSOR_DEFAULT);
             }
         }
 
-        if (songSearchInput.textLength > 0 && strcmp(songSearchInput.text, songSearchInput.placeholder) != 0) {
-            strcpy(songName, songSearchInput.text);
-        } else {
-            songName[0] = '\0';
+        profileEndExcluding(PROFILE_INPUT, frameStarted, inputLibraryTime);
+
+        // Work out which upload panel parts changed this frame
+        if (isUploadVisible) {
+            unsigned int hover = 0;
+            for (int i = PANEL_PASTE_AREA; i <= PANEL_SAVE; i++) {
+                if (CheckCollisionPointRec(mousePosition, panelRegions[i])) hover |= PANEL_BIT(i);
+            }
+            panelDirty |= hover ^ panelHover;
+            panelHover = hover;
+            if ((hover & PANEL_BIT(PANEL_PASTE_AREA)) && inputMouseWheelMove() != 0) panelDirty |= PANEL_BIT(PANEL_PASTE_AREA);
+            if (pasteAreaInput.editStart >= 0 ||
+                updateTextboxView(&pasteAreaView, pasteAreaInput.textLength, pasteAreaInput.cursorPos, pasteAreaInput.selectionStart,
+                                  pasteAreaInput.selectionEnd, pasteAreaInput.verticalOffset, pasteAreaInput.editing,
+                                  pasteAreaInput.cursorBlink)) {
+                panelDirty |= PANEL_BIT(PANEL_PASTE_AREA);
+            }
+            if (updateTextboxView(&songNameView, songNameInput.textLength, songNameInput.cursorPos, songNameInput.selectionStart,
+                                  songNameInput.selectionEnd, 0, songNameInput.editing, songNameInput.cursorBlink)) {
+                panelDirty |= PANEL_BIT(PANEL_SONG_NAME);
+            }
+            if (updateTextboxView(&bpmInputView, bpmValueInput.textLength, bpmValueInput.cursorPos, bpmValueInput.selectionStart,
+                                  bpmValueInput.selectionEnd, 0, bpmValueInput.editing, bpmValueInput.cursorBlink)) {
+                panelDirty |= PANEL_BIT(PANEL_BPM);
+            }
+            if (canSave != panelCanSave) {
+                panelCanSave = canSave;
+                panelDirty |= PANEL_BIT(PANEL_SAVE);
+            }
+            int recordedCount = keyRecorder ? keyRecordingNoteCount(keyRecorder) : -1;
+            if (recordedCount != panelRecordedCount) {
+                panelRecordedCount = recordedCount;
+                panelDirty |= PANEL_BIT(PANEL_RECORDING);
+            }
+        }
+
+        // Re-tokenize only the sheet lines touched this frame
+        if (pasteAreaInput.editStart >= 0) {
+            double layoutStarted = profileBegin();
+            const char* text = pasteSheet.lineCount > 0 ? dynamicTextboxThroughLine(&pasteAreaInput, pasteAreaInput.editNewEnd) :
+                               dynamicTextboxText(&pasteAreaInput);
+            sheetUpdate(&pasteSheet, text, pasteAreaInput.textLength,
+                        pasteAreaInput.editStart, pasteAreaInput.editOldEnd, pasteAreaInput.editNewEnd);
+            pasteAreaInput.editStart = -1;
+            playerNeedsLoad = true;
+            profileEnd(PROFILE_LAYOUT, layoutStarted);
+        }
+
+        if (pasteSheet.timeline.eventCount != panelNoteCount) {
+            panelNoteCount = pasteSheet.timeline.eventCount;
+            panelDirty |= PANEL_BIT(PANEL_NOTE_COUNT);
         }
 
         if (bpmValueEdit.textLength > 0 && strcmp(bpmValueEdit.text, bpmValueEdit.placeholder) != 0) {
@@ -978,7 +874,54 @@ int main(void) {
             bpm = atoi(bpmValueEdit.placeholder);
         }
 
+        if (player) {
+            if (bpm > 0 && bpm != playerBpm) {
+                playbackSetBpm(player, bpm);
+                playerBpm = bpm;
+            }
+            playbackUpdate(player);
+        }
+
+        // Songs added, removed or renamed outside the app
+        double watcherStarted = profileBegin();
+        if (applyLibraryWatcherChanges(libraryWatcher, &savedSongs, &songCount, noctivoxDir) != 0) {
+            libraryChanged = true;
+            profileEnd(PROFILE_LIBRARY_IO, watcherStarted);
+        }
+
+        // Swap in the selected song once the loader has parsed and compiled it
+        LoadedSong loadedSong;
+        if (!isUploadVisible && songLoaderTake(songLoader, &loadedSong)) {
+            if (loadedSong.valid) TraceLog(LOG_INFO, "Loaded song: %s", loadedSong.song.name);
+            if (showLoadedSong(&loadedSong, &pasteAreaInput, &pasteSheet, &bpmValueEdit)) {
+                playerNeedsLoad = true;
+                loopFirstBar = loopLastBar = -1;
+                sceneTextureNeedsUpdate = true;
+            }
+        }
+
+        // Filter the song list; the index is rebuilt only when the library changed
+        const char* query = songSearchInput.textLength > 0 && strcmp(songSearchInput.text, songSearchInput.placeholder) != 0 ?
+                            songSearchInput.text : "";
+        if (libraryChanged || strcmp(query, songQuery) != 0) {
+            double searchStarted = profileBegin();
+            if (libraryChanged) {
+                buildSongSearch(&songSearch, savedSongs, songCount);
+                resetSongListLabels(&songList, songCount);
+            }
+            if (strcmp(query, songQuery) != 0) {
+                songList.offset = 0;
+                songList.velocity = 0;
+            }
+            snprintf(songQuery, sizeof(songQuery), "%s", query);
+            runSongSearch(&songSearch, songQuery);
+            libraryChanged = false;
+            sceneTextureNeedsUpdate = true;
+            profileEnd(PROFILE_SEARCH, searchStarted);
+        }
+
         if (sceneTextureNeedsUpdate && !isUploadVisible) {
+            double sceneStarted = profileBegin();
             BeginTextureMode(sceneTexture);
                 DrawTextureRec(backgroundTexture.texture, 
                                (Rectangle){ 0, 0, screenWidth, -screenHeight }, 
@@ -987,82 +930,184 @@ int main(void) {
                 drawTextboxText(&bpmValueEdit, bpmValueEdit.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"), false);
                 drawDynamicTextboxText(&pasteAreaInput, pasteAreaInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"));
 
-                // Draw scrolling song list
-                BeginScissorMode(songListBounds.x, songListBounds.y, songListBounds.width, songListBounds.height);
-                float yPos = songListBounds.y - songListOffset;
-                for (int i = 0; i < songCount; i++) {
-                    Rectangle songRect = { songListBounds.x + 5, yPos, songListBounds.width - 10, 24 };
-                    bool hovered = CheckCollisionPointRec(mousePosition, songRect);
-                    DrawRectangleRounded(songRect, 0.5f, 6, hovered ? toHex("#393F5F") : toHex("#222329"));
-                    DrawTextEx(italicGFS, savedSongs[i].songName, 
-                               (Vector2){ songRect.x + 5, songRect.y + 5 }, 14, 1, toHex("#D0D0D0"));
-                    yPos += 30;
-                }
-                EndScissorMode();
-
-                // Scrollbar for song list
-                float totalHeight = songCount * 30;
-                if (totalHeight > songListBounds.height) {
-                    float scrollBarHeight = songListBounds.height * songListBounds.height / totalHeight;
-                    float scrollBarY = songListBounds.y + (songListOffset * (songListBounds.height - scrollBarHeight) / (totalHeight - songListBounds.height));
-                    DrawRectangle(songListBounds.x + songListBounds.width - 5, scrollBarY, 3, scrollBarHeight, toHex("#494D5A"));
-                }
+                drawSongList(&songList, savedSongs, songSearch.results, songSearch.resultCount);
             EndTextureMode();
             sceneTextureNeedsUpdate = false;
+            profileEnd(PROFILE_SCENE, sceneStarted);
         }
 
-        BeginDrawing();
-            ClearBackground(BLACK);
-            if (isUploadVisible) {
+        // Blur the scene behind the upload panel once per opening
+        if (isUploadVisible && blurTextureNeedsUpdate) {
+            double blurStarted = profileBegin();
+            BeginTextureMode(blurTexture);
                 BeginShaderMode(blurShader);
                     DrawTextureRec(sceneTexture.texture, 
                                    (Rectangle){ 0, 0, screenWidth, -screenHeight }, 
                                    (Vector2){ 0, 0 }, WHITE);
                 EndShaderMode();
-                DrawRectangleRec(uploadPanel, toHex("#272930"));         
-                DrawRectangleRounded(pasteAreaInput.bounds, 0.1f, 6, 
-                    CheckCollisionPointRec(mousePosition, pasteAreaInput.bounds) ? toHex("#33353E") : toHex("#2C2E36"));  
-                DrawRectangleRounded(songNameInput.bounds, 0.5f, 6, 
-                    CheckCollisionPointRec(mousePosition, songNameInput.bounds) ? toHex("#2A2C33") : toHex("#222329"));  
-                DrawRectangleRounded(bpmValueInput.bounds, 0.5f, 6, 
-                    CheckCollisionPointRec(mousePosition, bpmValueInput.bounds) ? toHex("#2A2C33") : toHex("#222329")); 
-                DrawRectangleRounded(cancelButton, 0.5f, 6, 
-                    CheckCollisionPointRec(mousePosition, cancelButton) ? toHex("#2A2C33") : toHex("#222329"));
-                DrawRectangleRounded(saveButton, 0.5f, 6, 
-                    canSave ? (CheckCollisionPointRec(mousePosition, saveButton) ? toHex("#494D5A") : toHex("#393F5F")) : 
-                    (CheckCollisionPointRec(mousePosition, saveButton) ? toHex("#2A2C33") : toHex("#222329")));
-                drawDynamicTextboxText(&pasteAreaInput, pasteAreaInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"));
-                drawTextboxText(&songNameInput, songNameInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"), false);
-                drawTextboxText(&bpmValueInput, bpmValueInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"), false);
-                DrawRectangle(170, 73, 150, 1, toHex("#494D5A"));
-                DrawRectangle(476, 226, 1, 20, toHex("#494D5A"));
-                DrawTextEx(boldGFS_h1, "upload song", (Vector2){ 170, 50 }, 20, 1, toHex("#F0F2FE"));
-                DrawTextEx(italicGFS, "paste music sheet:", (Vector2){ 170, 74 }, 14, 1, toHex("#979EBB"));
-                DrawTextEx(italicGFS, "song name:", (Vector2){ 170, 212 }, 14, 1, toHex("#979EBB"));
-                DrawTextEx(italicGFS, "bpm:", (Vector2){ 486, 212 }, 14, 1, toHex("#979EBB"));
-                DrawTextEx(boldGFS_h2, "cancel", (Vector2){ 375, 284 }, 14, 1, toHex("#F0F2FE"));
-                DrawTextEx(boldGFS_h2, "save", (Vector2){ 491, 284 }, 14, 1, toHex("#F0F2FE"));
-                if (selectedMidiPath) {
-                    DrawTextEx(italicGFS, selectedMidiPath, (Vector2){ 170, 250 }, 14, 1, toHex("#D0D0D0"));
-                    DrawTextEx(italicGFS, "file uploaded", (Vector2){ 480, 74 }, 14, 1, toHex("#D0D0D0"));
-                } else {
-                    DrawTextEx(italicGFS, "or drag and drop a .midi file", (Vector2){ 394, 74 }, 14, 1, toHex("#D0D0D0"));
+            EndTextureMode();
+            blurTextureNeedsUpdate = false;
+            profileEnd(PROFILE_BLUR, blurStarted);
+        }
+
+        // Redraw the upload panel parts that changed; each clears its own region first
+        if (isUploadVisible && panelDirty) {
+            double panelStarted = profileBegin();
+            Color panelColor = toHex("#272930");
+            BeginTextureMode(panelTexture);
+                if (panelDirty & PANEL_BIT(PANEL_BACKGROUND)) {
+                    ClearBackground(BLANK);
+                    DrawRectangleRec(uploadPanel, panelColor);
+                    DrawRectangle(170, 73, 150, 1, toHex("#494D5A"));
+                    DrawRectangle(476, 226, 1, 20, toHex("#494D5A"));
+                    DrawTextEx(boldGFS_h1, "upload song", (Vector2){ 170, 50 }, 20, 1, toHex("#F0F2FE"));
+                    DrawTextEx(italicGFS, "paste music sheet:", (Vector2){ 170, 74 }, 14, 1, toHex("#979EBB"));
+                    DrawTextEx(italicGFS, "song name:", (Vector2){ 170, 212 }, 14, 1, toHex("#979EBB"));
+                    DrawTextEx(italicGFS, "bpm:", (Vector2){ 486, 212 }, 14, 1, toHex("#979EBB"));
+                    panelDirty = PANEL_ALL;
+                }
+                for (int i = PANEL_PASTE_AREA; i < PANEL_WIDGET_COUNT; i++) {
+                    if (panelDirty & PANEL_BIT(i)) DrawRectangleRec(panelRegions[i], panelColor);
+                }
+                if (panelDirty & PANEL_BIT(PANEL_PASTE_AREA)) {
+                    DrawRectangleRounded(pasteAreaInput.bounds, 0.1f, 6, 
+                        (panelHover & PANEL_BIT(PANEL_PASTE_AREA)) ? toHex("#33353E") : toHex("#2C2E36"));  
+                    drawDynamicTextboxText(&pasteAreaInput, pasteAreaInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"));
+                }
+                if (panelDirty & PANEL_BIT(PANEL_SONG_NAME)) {
+                    DrawRectangleRounded(songNameInput.bounds, 0.5f, 6, 
+                        (panelHover & PANEL_BIT(PANEL_SONG_NAME)) ? toHex("#2A2C33") : toHex("#222329"));  
+                    drawTextboxText(&songNameInput, songNameInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"), false);
+                }
+                if (panelDirty & PANEL_BIT(PANEL_BPM)) {
+                    DrawRectangleRounded(bpmValueInput.bounds, 0.5f, 6, 
+                        (panelHover & PANEL_BIT(PANEL_BPM)) ? toHex("#2A2C33") : toHex("#222329")); 
+                    drawTextboxText(&bpmValueInput, bpmValueInput.editing ? toHex("#FFFFFF") : toHex("#D0D0D0"), false);
+                }
+                if (panelDirty & PANEL_BIT(PANEL_CANCEL)) {
+                    DrawRectangleRounded(cancelButton, 0.5f, 6, 
+                        (panelHover & PANEL_BIT(PANEL_CANCEL)) ? toHex("#2A2C33") : toHex("#222329"));
+                    DrawTextEx(boldGFS_h2, "cancel", (Vector2){ 375, 284 }, 14, 1, toHex("#F0F2FE"));
+                }
+                if (panelDirty & PANEL_BIT(PANEL_SAVE)) {
+                    bool hovered = panelHover & PANEL_BIT(PANEL_SAVE);
+                    DrawRectangleRounded(saveButton, 0.5f, 6, 
+                        canSave ? (hovered ? toHex("#494D5A") : toHex("#393F5F")) : 
+                        (hovered ? toHex("#2A2C33") : toHex("#222329")));
+                    DrawTextEx(boldGFS_h2, "save", (Vector2){ 491, 284 }, 14, 1, toHex("#F0F2FE"));
                 }
+                if ((panelDirty & PANEL_BIT(PANEL_NOTE_COUNT)) && pasteSheet.timeline.eventCount > 0) {
+                    BeginScissorMode(394, 212, 84, 14);
+                        DrawTextEx(italicGFS, TextFormat("%d notes", pasteSheet.timeline.eventCount), 
+                                   (Vector2){ 394, 212 }, 14, 1, toHex("#979EBB"));
+                    EndScissorMode();
+                }
+                if ((panelDirty & PANEL_BIT(PANEL_MIDI_PATH)) && selectedMidiPath) {
+                    BeginScissorMode(170, 250, 380, 16);
+                        useFontGlyphs(italicGFS, selectedMidiPath, strlen(selectedMidiPath));
+                        DrawTextEx(italicGFS, selectedMidiPath, (Vector2){ 170, 250 }, 14, 1, toHex("#D0D0D0"));
+                    EndScissorMode();
+                }
+                if (panelDirty & PANEL_BIT(PANEL_DROP_HINT)) {
+                    if (selectedMidiPath) {
+                        DrawTextEx(italicGFS, "file uploaded", (Vector2){ 480, 74 }, 14, 1, toHex("#D0D0D0"));
+                    } else {
+                        DrawTextEx(italicGFS, "or drag and drop a .midi file", (Vector2){ 394, 74 }, 14, 1, toHex("#D0D0D0"));
+                    }
+                }
+                if ((panelDirty & PANEL_BIT(PANEL_RECORDING)) && keyRecorder) {
+                    BeginScissorMode(296, 74, 94, 16);
+                        DrawTextEx(italicGFS, TextFormat("recording: %d", panelRecordedCount),
+                                   (Vector2){ 296, 74 }, 14, 1, toHex("#F0F2FE"));
+                    EndScissorMode();
+                }
+            EndTextureMode();
+            panelDirty = 0;
+            profileEnd(PROFILE_SCENE, panelStarted);
+        }
+
+        // Sleep in EndDrawing until input arrives, unless something is moving.
+        // Blinking carets and the playback clock only need the odd timed wake.
+        bool playing = player && playbackIsPlaying(player);
+        bool anyEditing = pasteAreaInput.editing || songNameInput.editing || bpmValueInput.editing ||
+                          songSearchInput.editing || bpmValueEdit.editing;
+        if (songList.velocity != 0 || inputReplaying()) {
+            DisableEventWaiting();
+        } else {
+            EnableEventWaiting();
+            if (playing) wakeEventLoopAt(nowSeconds() + PLAYBACK_STATUS_WAKE);
+            if (anyEditing) wakeEventLoopAt(nowSeconds() + CARET_BLINK_WAKE);
+            if (showProfiler) wakeEventLoopAt(nowSeconds() + PROFILER_OVERLAY_WAKE);
+        }
+
+        BeginDrawing();
+            ClearBackground(BLACK);
+            if (isUploadVisible) {
+                DrawTextureRec(blurTexture.texture, 
+                               (Rectangle){ 0, 0, screenWidth, -screenHeight }, 
+                               (Vector2){ 0, 0 }, WHITE);
+                DrawTextureRec(panelTexture.texture, 
+                               (Rectangle){ 0, 0, screenWidth, -screenHeight }, 
+                               (Vector2){ 0, 0 }, WHITE);
             } else {
                 DrawTextureRec(sceneTexture.texture, 
                                (Rectangle){ 0, 0, screenWidth, -screenHeight }, 
                                (Vector2){ 0, 0 }, WHITE);
+
+                // Playback status beside the bpm box
+                if (player && pasteSheet.timeline.eventCount > 0) {
+                    float tempoScale = bpm > 0 ? timelineNativeBpm(&pasteSheet.timeline) / bpm : 1.0f;
+                    int elapsed = (int)(playbackPosition(player) * tempoScale);
+                    int total = (int)(timelineTickToSeconds(&pasteSheet.timeline, pasteSheet.timeline.endTick, bpm));
+                    int bar = playbackBar(player) + 1;
+                    const char* loop = loopFirstBar >= 0 ? TextFormat("   loop %d-%d", loopFirstBar + 1, loopLastBar + 1) : "";
+                    const char* status;
+                    if (playbackIsPlaying(player)) {
+                        PlaybackJitter jitter;
+                        playbackGetJitter(player, &jitter);
+                        AudioStats audioStats = { 0 };
+                        if (audio) audioGetStats(audio, &audioStats);
+                        status = TextFormat("playing %d:%02d / %d:%02d   bar %d%s   late p99 %.2f ms   %d voices", 
+                                            elapsed / 60, elapsed % 60, total / 60, total % 60, bar, loop, jitter.p99Ms, 
+                                            audioStats.activeVoices);
+                    } else if (elapsed > 0 || loopFirstBar >= 0) {
+                        status = TextFormat("paused %d:%02d / %d:%02d   bar %d%s", elapsed / 60, elapsed % 60, total / 60, total % 60,
+                                            bar, loop);
+                    } else {
+                        status = "press space to play";
+                    }
+                    DrawTextEx(italicGFS, status, (Vector2){ 365, 322 }, 14, 1, toHex("#979EBB"));
+                }
             }
+            if (showProfiler) drawProfilerOverlay((Vector2){ screenWidth - 380, 8 });
+            profileEnd(PROFILE_FRAME, frameStarted);
+            endInputFrame();
         EndDrawing();
     }
 
+    if (keyRecorder) {
+        int length = 0;
+        free(finishKeyRecording(keyRecorder, &bpm, 1, &length));
+    }
     if (selectedMidiPath) free(selectedMidiPath);
-    free(pasteAreaInput.text);
+    freeTimeline(&midiTimeline);
+    freeDynamicTextbox(&pasteAreaInput);
+    destroyPlayback(player);
+    destroyAudioEngine(audio);
+    freeSheet(&pasteSheet);
+    destroyLibraryWatcher(libraryWatcher);
+    destroySongLoader(songLoader);
+    stopEventWake();
+    freeSongSearch(&songSearch);
+    free(songList.labelFit);
     freeSavedSongs(savedSongs, songCount);
     UnloadRenderTexture(backgroundTexture);
     UnloadRenderTexture(sceneTexture);
+    UnloadRenderTexture(blurTexture);
+    UnloadRenderTexture(panelTexture);
     UnloadShader(blurShader);
     unloadFonts();
+    stopInputLog();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "midi.h"
+
+#define MIDI_DEFAULT_TEMPO 500000 // 120 bpm, the SMF default
+
+// One MTrk chunk and where its notes land in the event array
+typedef struct {
+    const unsigned char* start; // First byte of track data
+    const unsigned char* end;   // One past the last byte of track data
+    int firstEvent;             // Index of this track's first note in the scratch array
+    int noteCount;              // Number of notes emitted by this track
+} MidiTrack;
+
+// Totals gathered by the counting pass
+typedef struct {
+    int notes;
+    int tempos;
+    int timeSignatures;
+} MidiCounts;
+
+static uint32_t readBE32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t readBE16(const unsigned char* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Read a variable-length quantity (at most 4 bytes)
+static bool readVarLen(const unsigned char** pos, const unsigned char* end, uint32_t* value) {
+    uint32_t result = 0;
+    for (int i = 0; i < 4; i++) {
+        if (*pos >= end) return false;
+        unsigned char byte = *(*pos)++;
+        result = (result << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Walk one track. With timeline == NULL only counts events; otherwise writes notes
+// into timeline->events starting at track->firstEvent and appends tempo/time
+// signature changes. Truncated tracks stop at the last complete event, which is
+// deterministic so both passes agree.
+static void walkTrack(MidiTrack* track, int trackIndex, bool useTempo, Timeline* timeline, MidiCounts* counts) {
+    const unsigned char* pos = track->start;
+    const unsigned char* end = track->end;
+    uint32_t tick = 0;
+    unsigned char status = 0;
+    int32_t openNotes[16][128];
+    int notes = 0;
+
+    if (timeline) memset(openNotes, 0xFF, sizeof(openNotes));
+
+    while (pos < end) {
+        uint32_t delta;
+        if (!readVarLen(&pos, end, &delta) || delta > UINT32_MAX - tick || pos >= end) break;
+        tick += delta;
+
+        unsigned char byte = *pos;
+        if (byte & 0x80) {
+            pos++;
+            status = (byte < 0xF0) ? byte : 0; // Sysex and meta events cancel running status
+        } else if (status) {
+            byte = status; // Running status: reuse the previous channel status byte
+        } else {
+            break;
+        }
+
+        if (byte == 0xFF) {
+            uint32_t length;
+            if (pos >= end) break;
+            unsigned char type = *pos++;
+            if (!readVarLen(&pos, end, &length) || length > (uint32_t)(end - pos)) break;
+            const unsigned char* data = pos;
+            pos += length;
+
+            if (type == 0x2F) break; // End of track
+            if (type == 0x51 && length >= 3 && useTempo) {
+                if (timeline) {
+                    TempoChange* tempo = &timeline->tempos[timeline->tempoCount++];
+                    tempo->tick = tick;
+                    tempo->usPerQuarter = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+                    if (tempo->usPerQuarter == 0) tempo->usPerQuarter = MIDI_DEFAULT_TEMPO;
+                } else {
+                    counts->tempos++;
+                }
+            } else if (type == 0x58 && length >= 2) {
+                if (timeline) {
+                    TimeSignature* signature = &timeline->timeSignatures[timeline->timeSignatureCount++];
+                    signature->tick = tick;
+                    signature->numerator = data[0] ? data[0] : 4;
+                    signature->denominator = (uint8_t)(1 << (data[1] < 6 ? data[1] : 6));
+                } else {
+                    counts->timeSignatures++;
+                }
+            }
+        } else if (byte == 0xF0 || byte == 0xF7) {
+            uint32_t length;
+            if (!readVarLen(&pos, end, &length) || length > (uint32_t)(end - pos)) break;
+            pos += length;
+        } else if (byte >= 0xF0) {
+            break; // System common/realtime messages are not valid inside a file
+        } else {
+            int type = byte & 0xF0;
+            int channel = byte & 0x0F;
+            int dataLength = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+            if (end - pos < dataLength) break;
+            int note = pos[0] & 0x7F;
+            int velocity = (dataLength == 2) ? (pos[1] & 0x7F) : 0;
+            pos += dataLength;
+
+            if (type == 0x90 && velocity > 0) {
+                if (timeline) {
+                    int32_t open = openNotes[channel][note];
+                    if (open >= 0) timeline->events[open].duration = tick - timeline->events[open].tick;
+
+                    int32_t index = track->firstEvent + notes;
+                    NoteEvent* event = &timeline->events[index];
+                    event->tick = tick;
+                    event->duration = 0;
+                    event->note = (uint8_t)note;
+                    event->velocity = (uint8_t)velocity;
+                    event->channel = (uint8_t)channel;
+                    event->track = (uint8_t)(trackIndex < 255 ? trackIndex : 255);
+                    openNotes[channel][note] = index;
+                }
+                notes++;
+            } else if ((type == 0x80 || type == 0x90) && timeline) {
+                int32_t open = openNotes[channel][note];
+                if (open >= 0) {
+                    timeline->events[open].duration = tick - timeline->events[open].tick;
+                    openNotes[channel][note] = -1;
+                }
+            }
+        }
+    }
+
+    if (timeline) {
+        // Notes still held at the end of the track last until the track ends
+        for (int channel = 0; channel < 16; channel++) {
+            for (int note = 0; note < 128; note++) {
+                int32_t open = openNotes[channel][note];
+                if (open >= 0) timeline->events[open].duration = tick - timeline->events[open].tick;
+            }
+        }
+    } else {
+        counts->notes += notes;
+    }
+    track->noteCount = notes;
+}
+
+// Heap ordering for the k-way merge: earlier tick first, then lower track index
+static bool trackHeadBefore(const Timeline* scratch, const int* cursors, int a, int b) {
+    uint32_t tickA = scratch->events[cursors[a]].tick;
+    uint32_t tickB = scratch->events[cursors[b]].tick;
+    return tickA < tickB || (tickA == tickB && a < b);
+}
+
+static void siftDown(int* heap, int heapSize, int index, const Timeline* scratch, const int* cursors) {
+    for (;;) {
+        int smallest = index;
+        int left = index * 2 + 1;
+        int right = left + 1;
+        if (left < heapSize && trackHeadBefore(scratch, cursors, heap[left], heap[smallest])) smallest = left;
+        if (right < heapSize && trackHeadBefore(scratch, cursors, heap[right], heap[smallest])) smallest = right;
+        if (smallest == index) return;
+        int temp = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = temp;
+        index = smallest;
+    }
+}
+
+// Merge the per-track sorted runs in scratch into one time-sorted array
+static NoteEvent* mergeTracks(const Timeline* scratch, MidiTrack* tracks, int trackCount) {
+    NoteEvent* merged = malloc(sizeof(NoteEvent) * scratch->eventCount);
+    int* cursors = malloc(sizeof(int) * trackCount * 2);
+    if (!merged || !cursors) {
+        free(merged);
+        free(cursors);
+        return NULL;
+    }
+    int* heap = cursors + trackCount;
+    int heapSize = 0;
+
+    for (int i = 0; i < trackCount; i++) {
+        cursors[i] = tracks[i].firstEvent;
+        if (tracks[i].noteCount > 0) heap[heapSize++] = i;
+    }
+    for (int i = heapSize / 2 - 1; i >= 0; i--) siftDown(heap, heapSize, i, scratch, cursors);
+
+    for (int out = 0; heapSize > 0; out++) {
+        int track = heap[0];
+        merged[out] = scratch->events[cursors[track]++];
+        if (cursors[track] == tracks[track].firstEvent + tracks[track].noteCount) heap[0] = heap[--heapSize];
+        siftDown(heap, heapSize, 0, scratch, cursors);
+    }
+
+    free(cursors);
+    return merged;
+}
+
+// Stable insertion sort; tempo and signature lists are tiny
+static void sortTempos(TempoChange* tempos, int count) {
+    for (int i = 1; i < count; i++) {
+        TempoChange value = tempos[i];
+        int j = i - 1;
+        while (j >= 0 && tempos[j].tick > value.tick) {
+            tempos[j + 1] = tempos[j];
+            j--;
+        }
+        tempos[j + 1] = value;
+    }
+}
+
+static void sortTimeSignatures(TimeSignature* signatures, int count) {
+    for (int i = 1; i < count; i++) {
+        TimeSignature value = signatures[i];
+        int j = i - 1;
+        while (j >= 0 && signatures[j].tick > value.tick) {
+            signatures[j + 1] = signatures[j];
+            j--;
+        }
+        signatures[j + 1] = value;
+    }
+}
+
+// Parse a Standard MIDI File (format 0 or 1) into a time-sorted timeline.
+// Two passes over the data: count, then fill exactly-sized arrays.
+bool parseMidi(const unsigned char* data, size_t size, Timeline* timeline) {
+    memset(timeline, 0, sizeof(*timeline));
+
+    if (size < 14 || memcmp(data, "MThd", 4) != 0 || readBE32(data + 4) < 6) {
+        TraceLog(LOG_WARNING, "MIDI: Missing MThd header");
+        return false;
+    }
+    int format = readBE16(data + 8);
+    int declaredTracks = readBE16(data + 10);
+    uint16_t division = readBE16(data + 12);
+    if (format > 1) {
+        TraceLog(LOG_WARNING, "MIDI: Format %d is not supported", format);
+        return false;
+    }
+    if (division == 0 || declaredTracks == 0) {
+        TraceLog(LOG_WARNING, "MIDI: Invalid header (division %d, %d tracks)", division, declaredTracks);
+        return false;
+    }
+
+    // SMPTE division: ticks are fixed fractions of a second, so use a
+    // one-second "quarter" and ignore tempo events
+    bool smpte = (division & 0x8000) != 0;
+    int ppq = division;
+    if (smpte) {
+        int framesPerSecond = -(int8_t)(division >> 8);
+        int ticksPerFrame = division & 0xFF;
+        ppq = framesPerSecond * ticksPerFrame;
+        if (ppq <= 0) {
+            TraceLog(LOG_WARNING, "MIDI: Invalid SMPTE division");
+            return false;
+        }
+    }
+
+    MidiTrack* tracks = malloc(sizeof(MidiTrack) * declaredTracks);
+    if (!tracks) return false;
+
+    // Locate track chunks, skipping unknown chunk types
+    int trackCount = 0;
+    size_t offset = 8 + readBE32(data + 4);
+    while (offset + 8 <= size && trackCount < declaredTracks) {
+        uint32_t length = readBE32(data + offset + 4);
+        const unsigned char* start = data + offset + 8;
+        size_t available = size - offset - 8;
+        if (length > available) length = (uint32_t)available; // Tolerate a truncated last chunk
+        if (memcmp(data + offset, "MTrk", 4) == 0) {
+            tracks[trackCount].start = start;
+            tracks[trackCount].end = start + length;
+            trackCount++;
+        }
+        offset += 8 + (size_t)length;
+    }
+
+    MidiCounts counts = { 0 };
+    for (int i = 0; i < trackCount; i++) {
+        tracks[i].firstEvent = counts.notes;
+        walkTrack(&tracks[i], i, !smpte, NULL, &counts);
+    }
+
+    Timeline scratch = { 0 };
+    scratch.events = malloc(sizeof(NoteEvent) * (counts.notes ? counts.notes : 1));
+    scratch.tempos = malloc(sizeof(TempoChange) * (counts.tempos + 1));
+    scratch.timeSignatures = malloc(sizeof(TimeSignature) * (counts.timeSignatures ? counts.timeSignatures : 1));
+    scratch.eventCount = counts.notes;
+    scratch.ppq = ppq;
+    if (!scratch.events || !scratch.tempos || !scratch.timeSignatures) {
+        freeTimeline(&scratch);
+        free(tracks);
+        return false;
+    }
+
+    for (int i = 0; i < trackCount; i++) walkTrack(&tracks[i], i, !smpte, &scratch, &counts);
+
+    if (trackCount > 1) {
+        NoteEvent* merged = mergeTracks(&scratch, tracks, trackCount);
+        if (!merged) {
+            freeTimeline(&scratch);
+            free(tracks);
+            return false;
+        }
+        free(scratch.events);
+        scratch.events = merged;
+    }
+    free(tracks);
+
+    // Make sure the tempo map starts at tick 0
+    sortTempos(scratch.tempos, scratch.tempoCount);
+    if (scratch.tempoCount == 0 || scratch.tempos[0].tick > 0) {
+        memmove(scratch.tempos + 1, scratch.tempos, sizeof(TempoChange) * scratch.tempoCount);
+        scratch.tempos[0].tick = 0;
+        scratch.tempos[0].usPerQuarter = smpte ? 1000000 : MIDI_DEFAULT_TEMPO;
+        scratch.tempoCount++;
+    }
+    sortTimeSignatures(scratch.timeSignatures, scratch.timeSignatureCount);
+
+    for (int i = 0; i < scratch.eventCount; i++) {
+        uint32_t noteEnd = scratch.events[i].tick + scratch.events[i].duration;
+        if (noteEnd > scratch.endTick) scratch.endTick = noteEnd;
+    }
+
+    *timeline = scratch;
+    return true;
+}
+
+// Memory-map and parse a .mid file
+bool loadMidiFile(const char* path, Timeline* timeline) {
+    MappedFile file;
+    if (!mapFile(path, &file)) {
+        TraceLog(LOG_WARNING, "MIDI: Failed to open %s", path);
+        memset(timeline, 0, sizeof(*timeline));
+        return false;
+    }
+    bool result = file.data && parseMidi(file.data, file.size, timeline);
+    unmapFile(&file);
+    if (result) {
+        TraceLog(LOG_INFO, "MIDI: Loaded %d notes from %s", timeline->eventCount, path);
+    }
+    return result;
+}
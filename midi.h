@@ -0,0 +1,10 @@
+#ifndef MIDI_H
+#define MIDI_H
+
+#include <stddef.h>
+#include "timeline.h"
+
+bool parseMidi(const unsigned char* data, size_t size, Timeline* timeline);
+bool loadMidiFile(const char* path, Timeline* timeline);
+
+#endif
@@ -0,0 +1,220 @@
+#include <stdlib.h>
+#include <string.h>
+#include "performance.h"
+
+// Note-off waiting to be merged, still in ticks
+typedef struct {
+    uint32_t tick;
+    uint8_t note;
+} PendingOff;
+
+static int comparePendingOffs(const void* a, const void* b) {
+    const PendingOff* left = a;
+    const PendingOff* right = b;
+    if (left->tick != right->tick) return left->tick < right->tick ? -1 : 1;
+    return (int)left->note - (int)right->note;
+}
+
+// Forward-only tick to seconds conversion over the tempo map
+typedef struct {
+    const Timeline* timeline;
+    int tempoIndex;
+    uint64_t segmentTick;       // Tick the current tempo took effect
+    double segmentSeconds;      // Time of segmentTick
+    double secondsPerTick;
+} TempoCursor;
+
+static void startTempoCursor(TempoCursor* cursor, const Timeline* timeline) {
+    cursor->timeline = timeline;
+    cursor->tempoIndex = 0;
+    cursor->segmentTick = 0;
+    cursor->segmentSeconds = 0.0;
+    double secondsPerBeat = timeline->tempoCount ? timeline->tempos[0].usPerQuarter / 1000000.0 : 60.0 / timelineNativeBpm(timeline);
+    cursor->secondsPerTick = secondsPerBeat / timeline->ppq;
+}
+
+// Ticks must not decrease from one call to the next
+static double tempoCursorSeconds(TempoCursor* cursor, uint64_t tick) {
+    const Timeline* timeline = cursor->timeline;
+    const TempoChange* tempos = timeline->tempos;
+    while (cursor->tempoIndex + 1 < timeline->tempoCount && tempos[cursor->tempoIndex + 1].tick <= tick) {
+        cursor->tempoIndex++;
+        cursor->segmentSeconds += (double)(tempos[cursor->tempoIndex].tick - cursor->segmentTick) * cursor->secondsPerTick;
+        cursor->segmentTick = tempos[cursor->tempoIndex].tick;
+        cursor->secondsPerTick = tempos[cursor->tempoIndex].usPerQuarter / 1000000.0 / timeline->ppq;
+    }
+    return cursor->segmentSeconds + (double)(tick - cursor->segmentTick) * cursor->secondsPerTick;
+}
+
+// Apply one event to a set of held notes, the way playback counts them
+static void holdEvent(HeldNotes* held, const PerformanceEvent* event) {
+    if (event->velocity > 0) {
+        if (held->held[event->note] < 255) held->held[event->note]++;
+        held->velocity[event->note] = event->velocity;
+    } else if (held->held[event->note] > 0) {
+        held->held[event->note]--;
+    }
+}
+
+// Snapshot the held notes every PERFORMANCE_CHECKPOINT_EVENTS events, so the
+// notes sounding at any event are a copy and a short walk away
+static bool buildCheckpoints(Performance* performance) {
+    int count = performance->eventCount / PERFORMANCE_CHECKPOINT_EVENTS + 1;
+    performance->checkpoints = malloc(sizeof(HeldNotes) * count);
+    if (!performance->checkpoints) return false;
+    HeldNotes held = { 0 };
+    for (int i = 0; i < performance->eventCount; i++) {
+        if (i % PERFORMANCE_CHECKPOINT_EVENTS == 0) performance->checkpoints[i / PERFORMANCE_CHECKPOINT_EVENTS] = held;
+        holdEvent(&held, &performance->events[i]);
+    }
+    if (performance->eventCount % PERFORMANCE_CHECKPOINT_EVENTS == 0) performance->checkpoints[count - 1] = held;
+    return true;
+}
+
+static uint64_t barTicks(const Timeline* timeline, const TimeSignature* signature) {
+    uint64_t ticks = signature ? (uint64_t)timeline->ppq * 4 * signature->numerator / (signature->denominator ? signature->denominator : 4) : 0;
+    return ticks > 0 ? ticks : (uint64_t)timeline->ppq * 4;
+}
+
+// Bar start times up to the end of the song. Bars are 4/4 until the first
+// time signature; a signature that lands mid-bar starts a new bar.
+static bool buildBars(const Timeline* timeline, Performance* performance) {
+    const TimeSignature* signatures = timeline->timeSignatures;
+    int signature = -1;
+    int capacity = 64;
+    performance->bars = malloc(sizeof(double) * capacity);
+    if (!performance->bars) return false;
+
+    TempoCursor tempo;
+    startTempoCursor(&tempo, timeline);
+    uint64_t tick = 0;
+    do {
+        while (signature + 1 < timeline->timeSignatureCount && signatures[signature + 1].tick <= tick) signature++;
+        if (performance->barCount == capacity) {
+            capacity *= 2;
+            double* bars = realloc(performance->bars, sizeof(double) * capacity);
+            if (!bars) return false;
+            performance->bars = bars;
+        }
+        performance->bars[performance->barCount++] = tempoCursorSeconds(&tempo, tick);
+
+        uint64_t next = tick + barTicks(timeline, signature >= 0 ? &signatures[signature] : NULL);
+        if (signature + 1 < timeline->timeSignatureCount && signatures[signature + 1].tick < next) next = signatures[signature + 1].tick;
+        tick = next;
+    } while (tempoCursorSeconds(&tempo, tick) < performance->duration);
+    return true;
+}
+
+// Flatten a timeline into note-on/note-off events with times in seconds.
+// Onsets are already sorted; offsets are sorted once and merged in, and a
+// single forward walk over the tempo map converts ticks to seconds. The
+// result carries an index of held notes and bar times for seeking.
+bool buildPerformance(const Timeline* timeline, Performance* performance) {
+    memset(performance, 0, sizeof(*performance));
+    if (timeline->ppq <= 0) return false;
+
+    int count = timeline->eventCount;
+    performance->nativeBpm = timelineNativeBpm(timeline);
+    performance->events = malloc(sizeof(PerformanceEvent) * (count ? count * 2 : 1));
+    PendingOff* offs = malloc(sizeof(PendingOff) * (count ? count : 1));
+    if (!performance->events || !offs) {
+        free(offs);
+        freePerformance(performance);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const NoteEvent* event = &timeline->events[i];
+        offs[i].tick = event->tick + (event->duration ? event->duration : 1);
+        offs[i].note = event->note;
+    }
+    qsort(offs, count, sizeof(PendingOff), comparePendingOffs);
+
+    TempoCursor tempo;
+    startTempoCursor(&tempo, timeline);
+    int on = 0;
+    int off = 0;
+    int out = 0;
+    while (on < count || off < count) {
+        bool takeOff = off < count && (on >= count || offs[off].tick <= timeline->events[on].tick);
+        uint32_t tick = takeOff ? offs[off].tick : timeline->events[on].tick;
+
+        PerformanceEvent* event = &performance->events[out++];
+        event->time = tempoCursorSeconds(&tempo, tick);
+        if (takeOff) {
+            event->note = offs[off++].note;
+            event->velocity = 0;
+        } else {
+            event->note = timeline->events[on].note;
+            event->velocity = timeline->events[on].velocity ? timeline->events[on].velocity : 1;
+            on++;
+        }
+    }
+    free(offs);
+
+    performance->eventCount = out;
+    performance->duration = timelineTickToSeconds(timeline, timeline->endTick, 0);
+    if (out > 0 && performance->events[out - 1].time > performance->duration) {
+        performance->duration = performance->events[out - 1].time;
+    }
+    if (!buildCheckpoints(performance) || !buildBars(timeline, performance)) {
+        freePerformance(performance);
+        return false;
+    }
+    return true;
+}
+
+void freePerformance(Performance* performance) {
+    free(performance->events);
+    free(performance->checkpoints);
+    free(performance->bars);
+    memset(performance, 0, sizeof(*performance));
+}
+
+// Index of the first event to play when starting at time (eventCount if
+// none). Note-offs at exactly time count as played already: they end notes
+// that stop on that beat, which must not be struck again. Offs sort first
+// on ties, so this is the first event after time or a note-on at it.
+int performanceFindEvent(const Performance* performance, double time) {
+    int low = 0;
+    int high = performance->eventCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        const PerformanceEvent* event = &performance->events[mid];
+        if (event->time < time || (event->time == time && event->velocity == 0)) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Notes held just before an event: the nearest checkpoint at or before it,
+// brought forward by at most PERFORMANCE_CHECKPOINT_EVENTS - 1 events
+void performanceHeldNotes(const Performance* performance, int event, HeldNotes* held) {
+    if (!performance->checkpoints) {
+        memset(held, 0, sizeof(*held));
+        return;
+    }
+    if (event < 0) event = 0;
+    if (event > performance->eventCount) event = performance->eventCount;
+    int checkpoint = event / PERFORMANCE_CHECKPOINT_EVENTS;
+    *held = performance->checkpoints[checkpoint];
+    for (int i = checkpoint * PERFORMANCE_CHECKPOINT_EVENTS; i < event; i++) holdEvent(held, &performance->events[i]);
+}
+
+// Index of the bar playing at time (0 before the first bar)
+int performanceFindBar(const Performance* performance, double time) {
+    int low = 0;
+    int high = performance->barCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (performance->bars[mid] <= time) low = mid + 1;
+        else high = mid;
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+// Start time of a bar; bars past the last one start at the end of the song
+double performanceBarTime(const Performance* performance, int bar) {
+    if (bar <= 0 || performance->barCount == 0) return 0.0;
+    return bar < performance->barCount ? performance->bars[bar] : performance->duration;
+}
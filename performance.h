@@ -0,0 +1,39 @@
+#ifndef PERFORMANCE_H
+#define PERFORMANCE_H
+
+#include "timeline.h"
+
+#define PERFORMANCE_CHECKPOINT_EVENTS 256   // Events between snapshots of the held notes
+
+// A note-on or note-off at an absolute time
+typedef struct {
+    double time;                // Seconds from the song start at the native tempo
+    uint8_t note;               // MIDI note number
+    uint8_t velocity;           // Note-on velocity, 0 for note-off
+} PerformanceEvent;
+
+// Notes held at some point of a performance
+typedef struct {
+    uint8_t held[128];          // Open note-ons per note
+    uint8_t velocity[128];      // Velocity of each note's latest note-on
+} HeldNotes;
+
+// A timeline flattened into time-sorted note-on/note-off events, ready to play
+typedef struct {
+    PerformanceEvent* events;   // Note-ons and note-offs sorted by time (offs first on ties)
+    int eventCount;             // Number of events
+    double duration;            // Length of the song in seconds at the native tempo
+    double nativeBpm;           // Tempo the times are expressed in
+    HeldNotes* checkpoints;     // Notes held before every PERFORMANCE_CHECKPOINT_EVENTS-th event
+    double* bars;               // Start time of each bar, ascending
+    int barCount;               // Number of bars (at least one)
+} Performance;
+
+bool buildPerformance(const Timeline* timeline, Performance* performance);
+void freePerformance(Performance* performance);
+int performanceFindEvent(const Performance* performance, double time);
+void performanceHeldNotes(const Performance* performance, int event, HeldNotes* held);
+int performanceFindBar(const Performance* performance, double time);
+double performanceBarTime(const Performance* performance, int bar);
+
+#endif
@@ -0,0 +1,469 @@
+// Platform layer. Kept apart from raylib.h because windows.h clashes with it.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <mmsystem.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <errno.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Map a whole file; empty files succeed with a NULL data pointer. A
+// copy-on-write view may be written to, and the writes stay private.
+static bool mapFileView(const char* path, MappedFile* file, bool copyOnWrite) {
+    memset(file, 0, sizeof(*file));
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle); // The mapping keeps the file open
+    if (!mapping) return false;
+
+    const void* view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    file->data = view;
+    file->size = (size_t)size.QuadPart;
+    file->handle = mapping;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* view = mmap(NULL, (size_t)info.st_size, protection, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (view == MAP_FAILED) return false;
+
+    if (!copyOnWrite) madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+    file->data = view;
+    file->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+// Map a whole file read-only; empty files succeed with a NULL data pointer
+bool mapFile(const char* path, MappedFile* file) {
+    return mapFileView(path, file, false);
+}
+
+// Map a whole file for random access with writable private pages. Only the
+// pages written to are copied; the file itself never changes.
+bool mapFileCopyOnWrite(const char* path, MappedFile* file) {
+    return mapFileView(path, file, true);
+}
+
+// Release a mapping created by mapFile
+void unmapFile(MappedFile* file) {
+    if (file->data) {
+#ifdef _WIN32
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->handle);
+#else
+        munmap((void*)file->data, file->size);
+#endif
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+// Monotonic clock in seconds, unaffected by wall-clock changes
+double nowSeconds(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// Sleep until an absolute nowSeconds() deadline. May wake a little late;
+// callers needing precision stop short and spin for the remainder.
+void sleepUntil(double deadline) {
+#ifdef _WIN32
+    double remaining = deadline - nowSeconds();
+    if (remaining > 0.001) Sleep((DWORD)((remaining - 0.001) * 1000.0));
+#elif defined(__APPLE__)
+    double remaining = deadline - nowSeconds();
+    if (remaining > 0) {
+        struct timespec duration = { (time_t)remaining, (long)((remaining - (time_t)remaining) * 1e9) };
+        nanosleep(&duration, NULL);
+    }
+#else
+    struct timespec target;
+    target.tv_sec = (time_t)deadline;
+    target.tv_nsec = (long)((deadline - (double)target.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) != 0) {
+        // Interrupted by a signal: keep sleeping toward the same deadline
+    }
+#endif
+}
+
+// Hint to the CPU that we are busy-waiting
+void spinPause(void) {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+// Give the calling thread real-time scheduling where the OS allows it
+void raiseThreadPriority(void) {
+#ifdef _WIN32
+    timeBeginPeriod(1);
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+    struct sched_param param = { 0 };
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        // No real-time privilege: fall back to the highest normal priority we may set
+        nice(-10);
+    }
+#endif
+}
+
+// Number of CPU cores available to this process (at least 1)
+int processorCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+#ifdef _WIN32
+// FILETIME counts 100 ns ticks since 1601
+static int64_t fileTimeToNanoseconds(FILETIME time) {
+    int64_t ticks = ((int64_t)time.dwHighDateTime << 32) | time.dwLowDateTime;
+    return (ticks - 116444736000000000LL) * 100;
+}
+#else
+static int64_t statModifiedTime(const struct stat* info) {
+#ifdef __APPLE__
+    return (int64_t)info->st_mtimespec.tv_sec * 1000000000LL + info->st_mtimespec.tv_nsec;
+#else
+    return (int64_t)info->st_mtim.tv_sec * 1000000000LL + info->st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+// Call visit for every regular file in a directory (not recursive), with its
+// size and modification time taken from the directory listing where possible
+bool scanDirectory(const char* path, DirectoryVisitor visit, void* userData) {
+#ifdef _WIN32
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*", path);
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileExA(pattern, FindExInfoBasic, &found, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    if (search == INVALID_HANDLE_VALUE) return false;
+    do {
+        if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        DirectoryEntry entry = {
+            found.cFileName,
+            ((int64_t)found.nFileSizeHigh << 32) | found.nFileSizeLow,
+            fileTimeToNanoseconds(found.ftLastWriteTime)
+        };
+        visit(userData, &entry);
+    } while (FindNextFileA(search, &found));
+    FindClose(search);
+    return true;
+#else
+    DIR* directory = opendir(path);
+    if (!directory) return false;
+    int fd = dirfd(directory);
+    struct dirent* item;
+    while ((item = readdir(directory)) != NULL) {
+        struct stat info;
+        if (fstatat(fd, item->d_name, &info, 0) != 0 || !S_ISREG(info.st_mode)) continue;
+        DirectoryEntry entry = { item->d_name, (int64_t)info.st_size, statModifiedTime(&info) };
+        visit(userData, &entry);
+    }
+    closedir(directory);
+    return true;
+#endif
+}
+
+// Size and modification time of a file, in the same units as scanDirectory
+bool getFileInfo(const char* path, int64_t* size, int64_t* modifiedTime) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+    *size = ((int64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    *modifiedTime = fileTimeToNanoseconds(data.ftLastWriteTime);
+    return true;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) return false;
+    *size = (int64_t)info.st_size;
+    *modifiedTime = statModifiedTime(&info);
+    return true;
+#endif
+}
+
+// Path of a file named name in the same directory as path (malloc'd, NULL
+// on failure). Unlike raylib's path helpers this keeps no static buffer, so
+// any thread may call it.
+// Path of name inside directory (malloc'd, NULL without memory). Every
+// song path is built here with '/', which Windows accepts too, so the
+// same file always gets the same string from the scan, the watcher and
+// the save.
+char* joinPath(const char* directory, const char* name) {
+    size_t directoryLength = strlen(directory);
+    size_t nameLength = strlen(name);
+    char* path = malloc(directoryLength + nameLength + 2);
+    if (!path) return NULL;
+    memcpy(path, directory, directoryLength);
+    path[directoryLength] = '/';
+    memcpy(path + directoryLength + 1, name, nameLength + 1);
+    return path;
+}
+
+char* siblingPath(const char* path, const char* name) {
+    const char* slash = strrchr(path, '/');
+    const char* backslash = strrchr(path, '\\');
+    if (backslash && (!slash || backslash > slash)) slash = backslash;
+    size_t directoryLength = slash ? (size_t)(slash - path) + 1 : 0;
+    size_t nameLength = strlen(name);
+    char* sibling = malloc(directoryLength + nameLength + 1);
+    if (!sibling) return NULL;
+    memcpy(sibling, path, directoryLength);
+    memcpy(sibling + directoryLength, name, nameLength + 1);
+    return sibling;
+}
+
+#define KEY_HOOK_DEVICES 16             // Keyboards read at once (Linux)
+
+// The one system-wide key hook
+static struct {
+    KeyHookCallback callback;
+    void* userData;
+    bool active;
+#ifdef _WIN32
+    HANDLE thread;
+    DWORD threadId;
+    HANDLE ready;
+    HHOOK hook;
+#elif defined(__linux__)
+    pthread_t thread;
+    int devices[KEY_HOOK_DEVICES];
+    int deviceCount;
+    int wakePipe[2];            // Written to stop the thread
+#endif
+} keyHook;
+
+#ifdef _WIN32
+// Low-level hooks run on the installing thread as it pumps messages, ahead
+// of the window's own input handling
+static LRESULT CALLBACK keyHookProc(int code, WPARAM message, LPARAM data) {
+    if (code == HC_ACTION) {
+        const KBDLLHOOKSTRUCT* info = (const KBDLLHOOKSTRUCT*)data;
+        DWORD virtualKey = info->vkCode;
+        int key = 0;
+        if (virtualKey >= '0' && virtualKey <= '9') key = (int)virtualKey;
+        else if (virtualKey >= 'A' && virtualKey <= 'Z') key = (int)(virtualKey - 'A' + 'a');
+        else if (virtualKey == VK_SHIFT || virtualKey == VK_LSHIFT || virtualKey == VK_RSHIFT) key = KEY_HOOK_SHIFT;
+        bool down = message == WM_KEYDOWN || message == WM_SYSKEYDOWN;
+        if (key) keyHook.callback(keyHook.userData, key, down, nowSeconds());
+    }
+    return CallNextHookEx(NULL, code, message, data);
+}
+
+static DWORD WINAPI keyHookThread(LPVOID argument) {
+    (void)argument;
+    MSG message;
+    PeekMessageA(&message, NULL, WM_USER, WM_USER, PM_NOREMOVE); // Create the queue stopKeyHook posts to
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    keyHook.hook = SetWindowsHookExA(WH_KEYBOARD_LL, keyHookProc, GetModuleHandleA(NULL), 0);
+    SetEvent(keyHook.ready);
+    if (!keyHook.hook) return 0;
+    while (GetMessageA(&message, NULL, 0, 0) > 0) {}
+    UnhookWindowsHookEx(keyHook.hook);
+    return 0;
+}
+#elif defined(__linux__)
+// Letter or digit at an evdev key code's US layout position, 0 for others
+static int evdevKey(int code) {
+    if (code >= KEY_1 && code <= KEY_9) return '1' + code - KEY_1;
+    if (code == KEY_0) return '0';
+    if (code >= KEY_Q && code <= KEY_P) return "qwertyuiop"[code - KEY_Q];
+    if (code >= KEY_A && code <= KEY_L) return "asdfghjkl"[code - KEY_A];
+    if (code >= KEY_Z && code <= KEY_M) return "zxcvbnm"[code - KEY_Z];
+    if (code == KEY_LEFTSHIFT || code == KEY_RIGHTSHIFT) return KEY_HOOK_SHIFT;
+    return 0;
+}
+
+static bool isKeyboard(int fd) {
+    unsigned long keys[KEY_MAX / (8 * sizeof(long)) + 1] = { 0 };
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0) return false;
+    int bits = 8 * sizeof(long);
+    return ((keys[KEY_Q / bits] >> (KEY_Q % bits)) & 1) && ((keys[KEY_A / bits] >> (KEY_A % bits)) & 1);
+}
+
+// Events carry the kernel's timestamp from when the key was read, switched
+// to CLOCK_MONOTONIC so they compare with nowSeconds()
+static void* keyHookThread(void* argument) {
+    (void)argument;
+    struct pollfd fds[KEY_HOOK_DEVICES + 1];
+    for (int i = 0; i < keyHook.deviceCount; i++) fds[i] = (struct pollfd){ keyHook.devices[i], POLLIN, 0 };
+    fds[keyHook.deviceCount] = (struct pollfd){ keyHook.wakePipe[0], POLLIN, 0 };
+
+    for (;;) {
+        if (poll(fds, keyHook.deviceCount + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[keyHook.deviceCount].revents) break;
+        for (int i = 0; i < keyHook.deviceCount; i++) {
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                fds[i].fd = -1;         // Unplugged; poll skips negative descriptors
+                continue;
+            }
+            if (!(fds[i].revents & POLLIN)) continue;
+            struct input_event events[64];
+            ssize_t size = read(fds[i].fd, events, sizeof(events));
+            for (int e = 0; e < (int)(size > 0 ? size / sizeof(struct input_event) : 0); e++) {
+                const struct input_event* event = &events[e];
+                if (event->type != EV_KEY || event->value == 2) continue; // 2 is auto-repeat
+                int key = evdevKey(event->code);
+                if (!key) continue;
+#ifdef input_event_sec
+                double time = event->input_event_sec + event->input_event_usec * 1e-6;
+#else
+                double time = event->time.tv_sec + event->time.tv_usec * 1e-6;
+#endif
+                keyHook.callback(keyHook.userData, key, event->value != 0, time);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void closeKeyDevices(void) {
+    for (int i = 0; i < keyHook.deviceCount; i++) close(keyHook.devices[i]);
+    keyHook.deviceCount = 0;
+}
+#endif
+
+// Report key presses and releases from a thread of their own, timestamped
+// as they happen rather than when the UI next polls. Windows uses a
+// low-level keyboard hook; Linux reads the evdev keyboards directly, which
+// needs read access to /dev/input (usually the input group). Returns false
+// where neither is available, or a hook is already running.
+bool startKeyHook(KeyHookCallback callback, void* userData) {
+    if (keyHook.active) return false;
+    keyHook.callback = callback;
+    keyHook.userData = userData;
+#ifdef _WIN32
+    keyHook.hook = NULL;
+    keyHook.ready = CreateEventA(NULL, TRUE, FALSE, NULL);
+    if (!keyHook.ready) return false;
+    keyHook.thread = CreateThread(NULL, 0, keyHookThread, NULL, 0, &keyHook.threadId);
+    if (keyHook.thread) WaitForSingleObject(keyHook.ready, INFINITE);
+    CloseHandle(keyHook.ready);
+    if (!keyHook.thread) return false;
+    if (!keyHook.hook) {
+        WaitForSingleObject(keyHook.thread, INFINITE);
+        CloseHandle(keyHook.thread);
+        return false;
+    }
+    keyHook.active = true;
+    return true;
+#elif defined(__linux__)
+    keyHook.deviceCount = 0;
+    for (int i = 0; i < 64 && keyHook.deviceCount < KEY_HOOK_DEVICES; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/input/event%d", i);
+        int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) continue;
+        int clock = CLOCK_MONOTONIC;
+        if (!isKeyboard(fd) || ioctl(fd, EVIOCSCLOCKID, &clock) != 0) {
+            close(fd);
+            continue;
+        }
+        keyHook.devices[keyHook.deviceCount++] = fd;
+    }
+    if (keyHook.deviceCount == 0) return false;
+    if (pipe(keyHook.wakePipe) != 0) {
+        closeKeyDevices();
+        return false;
+    }
+    if (pthread_create(&keyHook.thread, NULL, keyHookThread, NULL) != 0) {
+        close(keyHook.wakePipe[0]);
+        close(keyHook.wakePipe[1]);
+        closeKeyDevices();
+        return false;
+    }
+    keyHook.active = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void stopKeyHook(void) {
+    if (!keyHook.active) return;
+#ifdef _WIN32
+    PostThreadMessageA(keyHook.threadId, WM_QUIT, 0, 0);
+    WaitForSingleObject(keyHook.thread, INFINITE);
+    CloseHandle(keyHook.thread);
+#elif defined(__linux__)
+    char stop = 0;
+    ssize_t written = write(keyHook.wakePipe[1], &stop, 1);
+    (void)written;              // A full pipe already holds a wake-up
+    pthread_join(keyHook.thread, NULL);
+    close(keyHook.wakePipe[0]);
+    close(keyHook.wakePipe[1]);
+    closeKeyDevices();
+#endif
+    keyHook.active = false;
+}
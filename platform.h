@@ -0,0 +1,47 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Read-only view of a whole file mapped into memory
+typedef struct {
+    const unsigned char* data;  // Start of the mapped bytes (NULL for empty files)
+    size_t size;                // Size of the mapping in bytes
+    void* handle;               // Platform mapping handle (Windows only)
+} MappedFile;
+
+// File found by scanDirectory
+typedef struct {
+    const char* name;           // File name without the directory
+    int64_t size;               // Size in bytes
+    int64_t modifiedTime;       // Last modification in nanoseconds since the epoch
+} DirectoryEntry;
+
+typedef void (*DirectoryVisitor)(void* userData, const DirectoryEntry* entry);
+
+#define KEY_HOOK_SHIFT 1                // Key the hook reports for either shift key
+
+// Called on the hook's thread for every press and release of a letter, digit
+// or shift key, stamped on the nowSeconds() clock. key is a lowercase ASCII
+// letter or digit (US layout positions) or KEY_HOOK_SHIFT. Must return quickly.
+typedef void (*KeyHookCallback)(void* userData, int key, bool down, double time);
+
+bool mapFile(const char* path, MappedFile* file);
+bool mapFileCopyOnWrite(const char* path, MappedFile* file);
+void unmapFile(MappedFile* file);
+
+double nowSeconds(void);
+void sleepUntil(double deadline);
+void spinPause(void);
+void raiseThreadPriority(void);
+int processorCount(void);
+bool scanDirectory(const char* path, DirectoryVisitor visit, void* userData);
+bool getFileInfo(const char* path, int64_t* size, int64_t* modifiedTime);
+char* joinPath(const char* directory, const char* name);
+char* siblingPath(const char* path, const char* name);
+bool startKeyHook(KeyHookCallback callback, void* userData);
+void stopKeyHook(void);
+
+#endif
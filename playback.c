@@ -0,0 +1,471 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "performance.h"
+#include "spsc.h"
+#include "playback.h"
+
+#ifdef _WIN32
+#define SPIN_WINDOW 0.002       // Sleep overshoot on Windows even with a 1 ms timer period
+#else
+#define SPIN_WINDOW 0.0005      // Sleep overshoot on Linux/macOS
+#endif
+#define COMMAND_POLL 0.002      // Longest sleep while playing before re-checking commands
+
+typedef enum {
+    COMMAND_LOAD,
+    COMMAND_PLAY,
+    COMMAND_PAUSE,
+    COMMAND_SEEK,
+    COMMAND_SEEK_BAR,
+    COMMAND_SET_LOOP,
+    COMMAND_SET_BPM
+} PlaybackCommandType;
+
+// Message from the UI thread to the playback thread
+typedef struct {
+    PlaybackCommandType type;   // What to do
+    double value;               // Seek target in seconds, new bpm, or (first) bar
+    int lastBar;                // Last bar of the loop (COMMAND_SET_LOOP)
+    Performance* performance;   // Song to take ownership of (COMMAND_LOAD)
+} PlaybackCommand;
+
+struct Playback {
+    pthread_t thread;           // Scheduler thread
+    SpscQueue commands;         // UI -> playback commands
+    SpscQueue retired;          // Playback -> UI: performances to free
+    pthread_mutex_t doorbellLock; // Wakes the thread while paused
+    pthread_cond_t doorbell;
+    bool doorbellRung;
+    atomic_bool quit;           // Set once by destroyPlayback; never queued, so never dropped
+    NoteSink sink;              // Where scheduled notes go (may be NULL)
+    void* userData;             // Passed back to sink
+
+    // Owned by the playback thread
+    Performance* performance;   // Song being played
+    int nextEvent;              // Next event to dispatch
+    bool playing;               // Is the clock running?
+    double bpm;                 // Requested tempo (0 = native)
+    double rate;                // Song seconds per wall-clock second
+    double position;            // Song time while paused
+    double anchorWall;          // Wall time at which the song was at anchorSong
+    double anchorSong;          // Song time at anchorWall
+    uint8_t sounding[128];      // Open note-ons per note, for silencing on pause/seek
+    double loopStart;           // A/B loop in song seconds (off when loopEnd <= loopStart)
+    double loopEnd;
+    int loopEvent;              // First event at loopStart
+    HeldNotes loopHeld;         // Notes held across loopStart
+
+    // Published to the UI thread
+    atomic_bool publishedPlaying;
+    _Atomic int64_t publishedPositionUs;
+    atomic_int publishedBar;
+    _Atomic uint32_t jitterBuckets[PLAYBACK_JITTER_BUCKETS];
+    _Atomic uint32_t jitterMaxUs;
+    _Atomic uint32_t jitterCount;
+};
+
+static double songTimeAt(const Playback* playback, double wall) {
+    return playback->anchorSong + (wall - playback->anchorWall) * playback->rate;
+}
+
+static double wallTimeOf(const Playback* playback, double song) {
+    return playback->anchorWall + (song - playback->anchorSong) / playback->rate;
+}
+
+static void updateRate(Playback* playback) {
+    double nativeBpm = playback->performance ? playback->performance->nativeBpm : 120.0;
+    playback->rate = playback->bpm > 0 ? playback->bpm / nativeBpm : 1.0;
+}
+
+static void publishPosition(Playback* playback, double position) {
+    atomic_store_explicit(&playback->publishedPositionUs, (int64_t)(position * 1000000.0), memory_order_relaxed);
+    int bar = playback->performance ? performanceFindBar(playback->performance, position) : 0;
+    atomic_store_explicit(&playback->publishedBar, bar, memory_order_relaxed);
+}
+
+// Send note-offs for every note still sounding
+static void silence(Playback* playback, double now) {
+    for (int note = 0; note < 128; note++) {
+        while (playback->sounding[note] > 0) {
+            if (playback->sink) playback->sink(playback->userData, note, 0, now);
+            playback->sounding[note]--;
+        }
+    }
+}
+
+// Send note-ons for notes that began before the play head and are still held
+static void strike(Playback* playback, const HeldNotes* held, double now) {
+    for (int note = 0; note < 128; note++) {
+        for (int i = 0; i < held->held[note] && playback->sounding[note] < 255; i++) {
+            if (playback->sink) playback->sink(playback->userData, note, held->velocity[note], now);
+            playback->sounding[note]++;
+        }
+    }
+}
+
+// Move the play head, sounding the notes held across the new position when playing
+static void moveTo(Playback* playback, double position, double now) {
+    silence(playback, now);
+    playback->position = position > 0 ? position : 0.0;
+    playback->nextEvent = playback->performance ? performanceFindEvent(playback->performance, playback->position) : 0;
+    playback->anchorWall = now;
+    playback->anchorSong = playback->position;
+    if (playback->playing) {
+        HeldNotes held;
+        performanceHeldNotes(playback->performance, playback->nextEvent, &held);
+        strike(playback, &held, now);
+    }
+}
+
+// Jump from the loop end back to its start at the same instant. Everything
+// needed was worked out when the loop was set, so the wrap costs no more
+// than an ordinary event.
+static void wrapLoop(Playback* playback, double wall) {
+    silence(playback, wall);
+    playback->anchorWall = wall;
+    playback->anchorSong = playback->loopStart;
+    playback->nextEvent = playback->loopEvent;
+    strike(playback, &playback->loopHeld, wall);
+}
+
+static void resetJitter(Playback* playback) {
+    for (int i = 0; i < PLAYBACK_JITTER_BUCKETS; i++) {
+        atomic_store_explicit(&playback->jitterBuckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&playback->jitterMaxUs, 0, memory_order_relaxed);
+    atomic_store_explicit(&playback->jitterCount, 0, memory_order_relaxed);
+}
+
+static void recordJitter(Playback* playback, double lateness) {
+    uint32_t micros = lateness > 0 ? (uint32_t)(lateness * 1000000.0) : 0;
+    uint32_t bucket = micros / 10;
+    if (bucket >= PLAYBACK_JITTER_BUCKETS) bucket = PLAYBACK_JITTER_BUCKETS - 1;
+    atomic_fetch_add_explicit(&playback->jitterBuckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&playback->jitterCount, 1, memory_order_relaxed);
+    if (micros > atomic_load_explicit(&playback->jitterMaxUs, memory_order_relaxed)) {
+        atomic_store_explicit(&playback->jitterMaxUs, micros, memory_order_relaxed);
+    }
+}
+
+// Apply one command on the playback thread
+static void handleCommand(Playback* playback, const PlaybackCommand* command) {
+    double now = nowSeconds();
+    double current = playback->playing ? songTimeAt(playback, now) : playback->position;
+
+    switch (command->type) {
+        case COMMAND_LOAD:
+            silence(playback, now);
+            if (playback->performance && !spscPush(&playback->retired, &playback->performance)) {
+                freePerformance(playback->performance); // UI is not draining; free here rather than leak
+                free(playback->performance);
+            }
+            playback->performance = command->performance;
+            playback->nextEvent = 0;
+            playback->position = 0.0;
+            playback->playing = false;
+            playback->loopStart = playback->loopEnd = 0.0;
+            updateRate(playback);
+            break;
+        case COMMAND_PLAY:
+            if (!playback->performance || playback->playing) break;
+            if (playback->nextEvent >= playback->performance->eventCount) {
+                playback->position = 0.0;
+                playback->nextEvent = 0;
+            }
+            resetJitter(playback);
+            playback->playing = true;
+            moveTo(playback, playback->position, now);
+            break;
+        case COMMAND_PAUSE:
+            if (!playback->playing) break;
+            silence(playback, now);
+            playback->position = current;
+            playback->playing = false;
+            break;
+        case COMMAND_SEEK:
+            moveTo(playback, command->value, now);
+            break;
+        case COMMAND_SEEK_BAR:
+            if (playback->performance) moveTo(playback, performanceBarTime(playback->performance, (int)command->value), now);
+            break;
+        case COMMAND_SET_LOOP: {
+            const Performance* performance = playback->performance;
+            playback->loopStart = playback->loopEnd = 0.0;
+            if (!performance || command->value < 0 || command->lastBar < command->value) break;
+            playback->loopStart = performanceBarTime(performance, (int)command->value);
+            playback->loopEnd = performanceBarTime(performance, command->lastBar + 1);
+            if (playback->loopEnd <= playback->loopStart) {
+                playback->loopStart = playback->loopEnd = 0.0;
+                break;
+            }
+            playback->loopEvent = performanceFindEvent(performance, playback->loopStart);
+            performanceHeldNotes(performance, playback->loopEvent, &playback->loopHeld);
+            // Past the loop: go to its start. Otherwise play on into it.
+            if (current >= playback->loopEnd) {
+                moveTo(playback, playback->loopStart, now);
+            } else {
+                playback->anchorWall = now;
+                playback->anchorSong = current;
+                playback->position = current;
+            }
+            break;
+        }
+        case COMMAND_SET_BPM:
+            playback->anchorWall = now;
+            playback->anchorSong = current;
+            playback->position = current;
+            playback->bpm = command->value;
+            updateRate(playback);
+            break;
+    }
+
+    atomic_store_explicit(&playback->publishedPlaying, playback->playing, memory_order_relaxed);
+    publishPosition(playback, playback->playing ? songTimeAt(playback, now) : playback->position);
+}
+
+static void waitForDoorbell(Playback* playback) {
+    pthread_mutex_lock(&playback->doorbellLock);
+    while (!playback->doorbellRung) pthread_cond_wait(&playback->doorbell, &playback->doorbellLock);
+    playback->doorbellRung = false;
+    pthread_mutex_unlock(&playback->doorbellLock);
+}
+
+// Scheduler: sleep toward the next event's absolute deadline, spin the last
+// stretch, then dispatch everything that is due
+static void* playbackThread(void* arg) {
+    Playback* playback = arg;
+    raiseThreadPriority();
+
+    for (;;) {
+        if (atomic_load_explicit(&playback->quit, memory_order_acquire)) {
+            silence(playback, nowSeconds());
+            return NULL;
+        }
+        PlaybackCommand command;
+        while (spscPop(&playback->commands, &command)) handleCommand(playback, &command);
+
+        if (!playback->playing) {
+            waitForDoorbell(playback);
+            continue;
+        }
+
+        // A loop wraps once nothing before its end is left to play, unless
+        // playback was moved past it
+        const Performance* performance = playback->performance;
+        double now = nowSeconds();
+        bool wraps = playback->loopEnd > playback->loopStart && playback->anchorSong < playback->loopEnd &&
+                     (playback->nextEvent >= performance->eventCount ||
+                      performance->events[playback->nextEvent].time >= playback->loopEnd);
+        if (!wraps && playback->nextEvent >= performance->eventCount) {
+            playback->position = performance->duration;
+            playback->playing = false;
+            atomic_store_explicit(&playback->publishedPlaying, false, memory_order_relaxed);
+            publishPosition(playback, playback->position);
+            continue;
+        }
+
+        double deadline = wallTimeOf(playback, wraps ? playback->loopEnd : performance->events[playback->nextEvent].time);
+        publishPosition(playback, songTimeAt(playback, now));
+        if (deadline - now > SPIN_WINDOW) {
+            double wake = deadline - SPIN_WINDOW;
+            if (wake > now + COMMAND_POLL) wake = now + COMMAND_POLL;
+            sleepUntil(wake);
+            continue;
+        }
+
+        while ((now = nowSeconds()) < deadline) spinPause();
+        if (wraps) {
+            wrapLoop(playback, deadline);
+            continue;
+        }
+
+        double songNow = songTimeAt(playback, now);
+        while (playback->nextEvent < performance->eventCount && performance->events[playback->nextEvent].time <= songNow) {
+            const PerformanceEvent* event = &performance->events[playback->nextEvent++];
+            double eventDeadline = wallTimeOf(playback, event->time);
+            recordJitter(playback, now - eventDeadline);
+
+            if (event->velocity > 0) {
+                if (playback->sounding[event->note] < 255) playback->sounding[event->note]++;
+            } else if (playback->sounding[event->note] > 0) {
+                playback->sounding[event->note]--;
+            } else {
+                continue; // Note-off for a note we never started (e.g. after a seek)
+            }
+            if (playback->sink) playback->sink(playback->userData, event->note, event->velocity, eventDeadline);
+        }
+    }
+}
+
+static void ringDoorbell(Playback* playback) {
+    pthread_mutex_lock(&playback->doorbellLock);
+    playback->doorbellRung = true;
+    pthread_cond_signal(&playback->doorbell);
+    pthread_mutex_unlock(&playback->doorbellLock);
+}
+
+static void pushCommand(Playback* playback, const PlaybackCommand* command) {
+    if (!spscPush(&playback->commands, command)) {
+        TraceLog(LOG_WARNING, "PLAYBACK: Command queue full, dropping command %d", command->type);
+        if (command->performance) {
+            freePerformance(command->performance);
+            free(command->performance);
+        }
+        return;
+    }
+    ringDoorbell(playback);
+}
+
+static void sendCommand(Playback* playback, PlaybackCommandType type, double value, Performance* performance) {
+    PlaybackCommand command = { type, value, 0, performance };
+    pushCommand(playback, &command);
+}
+
+// Start the playback thread. sink receives every scheduled note.
+Playback* createPlayback(NoteSink sink, void* userData) {
+    Playback* playback = calloc(1, sizeof(Playback));
+    if (!playback) return NULL;
+    playback->sink = sink;
+    playback->userData = userData;
+    playback->rate = 1.0;
+
+    if (!initSpscQueue(&playback->commands, sizeof(PlaybackCommand), 64) ||
+        !initSpscQueue(&playback->retired, sizeof(Performance*), 64)) {
+        freeSpscQueue(&playback->commands);
+        free(playback);
+        return NULL;
+    }
+    pthread_mutex_init(&playback->doorbellLock, NULL);
+    pthread_cond_init(&playback->doorbell, NULL);
+
+    if (pthread_create(&playback->thread, NULL, playbackThread, playback) != 0) {
+        TraceLog(LOG_ERROR, "PLAYBACK: Failed to start playback thread");
+        freeSpscQueue(&playback->commands);
+        freeSpscQueue(&playback->retired);
+        free(playback);
+        return NULL;
+    }
+    return playback;
+}
+
+// Stop the thread and free everything it owned. The stop is a flag rather
+// than a command, so a full queue cannot lose it and leave the join waiting.
+void destroyPlayback(Playback* playback) {
+    if (!playback) return;
+    atomic_store_explicit(&playback->quit, true, memory_order_release);
+    ringDoorbell(playback);
+    pthread_join(playback->thread, NULL);
+
+    PlaybackCommand command;
+    while (spscPop(&playback->commands, &command)) {
+        if (command.performance) {
+            freePerformance(command.performance);
+            free(command.performance);
+        }
+    }
+    if (playback->performance) {
+        freePerformance(playback->performance);
+        free(playback->performance);
+    }
+    playbackUpdate(playback);
+    freeSpscQueue(&playback->commands);
+    freeSpscQueue(&playback->retired);
+    pthread_mutex_destroy(&playback->doorbellLock);
+    pthread_cond_destroy(&playback->doorbell);
+    free(playback);
+}
+
+// Snapshot a timeline and hand it to the playback thread
+void playbackLoad(Playback* playback, const Timeline* timeline) {
+    Performance* performance = malloc(sizeof(Performance));
+    if (!performance) return;
+    if (!buildPerformance(timeline, performance)) {
+        free(performance);
+        return;
+    }
+    sendCommand(playback, COMMAND_LOAD, 0, performance);
+}
+
+void playbackPlay(Playback* playback) {
+    sendCommand(playback, COMMAND_PLAY, 0, NULL);
+}
+
+void playbackPause(Playback* playback) {
+    sendCommand(playback, COMMAND_PAUSE, 0, NULL);
+}
+
+// Jump to a song time in seconds at the native tempo
+void playbackSeek(Playback* playback, double seconds) {
+    sendCommand(playback, COMMAND_SEEK, seconds, NULL);
+}
+
+// Jump to the start of a bar (0-based), sounding notes held across it
+void playbackSeekBar(Playback* playback, int bar) {
+    sendCommand(playback, COMMAND_SEEK_BAR, bar < 0 ? 0 : bar, NULL);
+}
+
+// Repeat bars firstBar through lastBar without a gap; a negative firstBar
+// turns the loop off. Cleared when another song is loaded.
+void playbackSetLoop(Playback* playback, int firstBar, int lastBar) {
+    PlaybackCommand command = { COMMAND_SET_LOOP, firstBar, lastBar, NULL };
+    pushCommand(playback, &command);
+}
+
+void playbackSetBpm(Playback* playback, float bpm) {
+    sendCommand(playback, COMMAND_SET_BPM, bpm, NULL);
+}
+
+// Call once per frame on the UI thread: frees performances the player is done with
+void playbackUpdate(Playback* playback) {
+    Performance* performance;
+    while (spscPop(&playback->retired, &performance)) {
+        freePerformance(performance);
+        free(performance);
+    }
+}
+
+bool playbackIsPlaying(Playback* playback) {
+    return atomic_load_explicit(&playback->publishedPlaying, memory_order_relaxed);
+}
+
+// Current song time in seconds at the native tempo
+double playbackPosition(Playback* playback) {
+    return atomic_load_explicit(&playback->publishedPositionUs, memory_order_relaxed) / 1000000.0;
+}
+
+// Bar (0-based) at the current position
+int playbackBar(Playback* playback) {
+    return atomic_load_explicit(&playback->publishedBar, memory_order_relaxed);
+}
+
+// Summarize the lateness histogram
+void playbackGetJitter(Playback* playback, PlaybackJitter* jitter) {
+    uint32_t counts[PLAYBACK_JITTER_BUCKETS];
+    uint32_t total = 0;
+    for (int i = 0; i < PLAYBACK_JITTER_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&playback->jitterBuckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+
+    memset(jitter, 0, sizeof(*jitter));
+    jitter->count = (int)total;
+    jitter->maxMs = atomic_load_explicit(&playback->jitterMaxUs, memory_order_relaxed) / 1000.0f;
+    if (total == 0) return;
+
+    uint32_t seen = 0;
+    uint32_t p50 = (total + 1) / 2;
+    uint32_t p99 = total - total / 100;
+    for (int i = 0; i < PLAYBACK_JITTER_BUCKETS; i++) {
+        uint32_t before = seen;
+        seen += counts[i];
+        if (before < p50 && seen >= p50) jitter->p50Ms = i * 0.01f;
+        if (before < p99 && seen >= p99) {
+            jitter->p99Ms = i * 0.01f;
+            break;
+        }
+    }
+}
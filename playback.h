@@ -0,0 +1,38 @@
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include <stdbool.h>
+#include "timeline.h"
+
+#define PLAYBACK_JITTER_BUCKETS 2000    // 10 us histogram buckets, up to 20 ms late
+
+// Receives scheduled notes on the playback thread. velocity 0 is a note-off;
+// time is the nowSeconds() deadline the note was scheduled for.
+typedef void (*NoteSink)(void* userData, int note, int velocity, double time);
+
+// Scheduling lateness measured since playback last started
+typedef struct {
+    int count;                  // Events dispatched
+    float p50Ms;                // Median lateness in milliseconds
+    float p99Ms;                // 99th percentile lateness in milliseconds
+    float maxMs;                // Worst lateness in milliseconds
+} PlaybackJitter;
+
+typedef struct Playback Playback;
+
+Playback* createPlayback(NoteSink sink, void* userData);
+void destroyPlayback(Playback* playback);
+void playbackLoad(Playback* playback, const Timeline* timeline);
+void playbackPlay(Playback* playback);
+void playbackPause(Playback* playback);
+void playbackSeek(Playback* playback, double seconds);
+void playbackSeekBar(Playback* playback, int bar);
+void playbackSetLoop(Playback* playback, int firstBar, int lastBar);
+void playbackSetBpm(Playback* playback, float bpm);
+void playbackUpdate(Playback* playback);
+bool playbackIsPlaying(Playback* playback);
+double playbackPosition(Playback* playback);
+int playbackBar(Playback* playback);
+void playbackGetJitter(Playback* playback, PlaybackJitter* jitter);
+
+#endif
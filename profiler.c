@@ -0,0 +1,123 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "profiler.h"
+
+#define SAMPLE_DURATION_BITS 24         // Duration in 100 ns units; the rest is the start time in us
+#define SAMPLE_DURATION_MAX ((1u << SAMPLE_DURATION_BITS) - 1)
+
+// Lossy ring any thread may write to. A sample is one 64-bit word, so a
+// reader racing a writer sees the old sample or the new one, never a mix,
+// and writers only contend on the head counter.
+typedef struct {
+    _Atomic uint32_t head;      // Samples ever written; the next slot is head % PROFILE_RING_SIZE
+    _Atomic uint64_t samples[PROFILE_RING_SIZE];
+} ProfileRing;
+
+static ProfileRing rings[PROFILE_SCOPE_COUNT];
+static double origin;           // nowSeconds() at initProfiler
+
+static const char* scopeNames[PROFILE_SCOPE_COUNT] = {
+    [PROFILE_FRAME] = "frame",
+    [PROFILE_INPUT] = "input",
+    [PROFILE_LAYOUT] = "layout",
+    [PROFILE_SEARCH] = "search",
+    [PROFILE_SCENE] = "scene",
+    [PROFILE_BLUR] = "blur",
+    [PROFILE_LIBRARY_IO] = "library io",
+    [PROFILE_AUDIO_RENDER] = "audio render",
+    [PROFILE_AUDIO_EFFECTS] = "audio effects",
+    [PROFILE_AUDIO_CALLBACK] = "audio callback",
+};
+
+// Call once before any thread records
+void initProfiler(void) {
+    origin = nowSeconds();
+}
+
+// Start of a timed region; pass the result to profileEnd
+double profileBegin(void) {
+    return nowSeconds();
+}
+
+// Record a region; returns its length in seconds
+double profileEnd(ProfileScope scope, double started) {
+    return profileEndExcluding(scope, started, 0.0);
+}
+
+// Record a region minus the seconds spent in other scopes nested inside it,
+// so no time is counted twice
+double profileEndExcluding(ProfileScope scope, double started, double excluded) {
+    double now = nowSeconds();
+    double seconds = now - started - excluded;
+    double duration = (seconds > 0 ? seconds : 0.0) * 1e7;
+    uint64_t ticks = duration < SAMPLE_DURATION_MAX ? (uint64_t)duration : SAMPLE_DURATION_MAX;
+    uint64_t start = started > origin ? (uint64_t)((started - origin) * 1e6) : 0;
+    ProfileRing* ring = &rings[scope];
+    uint32_t slot = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed) % PROFILE_RING_SIZE;
+    atomic_store_explicit(&ring->samples[slot], (start << SAMPLE_DURATION_BITS) | ticks, memory_order_relaxed);
+    return now - started;
+}
+
+const char* profileScopeName(ProfileScope scope) {
+    return scopeNames[scope];
+}
+
+static int compareTicks(const void* a, const void* b) {
+    uint32_t left = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    return left < right ? -1 : left > right;
+}
+
+// Oldest-first copy of a ring's samples; returns how many
+static int copyRing(ProfileScope scope, uint64_t* samples) {
+    ProfileRing* ring = &rings[scope];
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    int count = head < PROFILE_RING_SIZE ? (int)head : PROFILE_RING_SIZE;
+    for (int i = 0; i < count; i++) {
+        uint32_t slot = (head - count + i) % PROFILE_RING_SIZE;
+        samples[i] = atomic_load_explicit(&ring->samples[slot], memory_order_relaxed);
+    }
+    return count;
+}
+
+// Percentiles and histogram of a scope's ring. Uses static scratch, so only
+// one thread (the UI) may summarize or write CSV.
+void profileSummarize(ProfileScope scope, ProfileSummary* summary) {
+    static uint64_t samples[PROFILE_RING_SIZE];
+    static uint32_t ticks[PROFILE_RING_SIZE];
+    memset(summary, 0, sizeof(*summary));
+    int count = copyRing(scope, samples);
+    if (count == 0) return;
+
+    for (int i = 0; i < count; i++) {
+        ticks[i] = (uint32_t)(samples[i] & SAMPLE_DURATION_MAX);
+        uint32_t micros = ticks[i] / 10;
+        int bucket = 0;
+        while (bucket < PROFILE_HISTOGRAM_BUCKETS - 1 && micros >= (1u << bucket)) bucket++;
+        summary->histogram[bucket]++;
+    }
+    qsort(ticks, count, sizeof(uint32_t), compareTicks);
+    summary->count = count;
+    summary->p50Ms = ticks[(count + 1) / 2 - 1] / 1e4f;
+    summary->p99Ms = ticks[(count * 99 + 99) / 100 - 1] / 1e4f;
+    summary->maxMs = ticks[count - 1] / 1e4f;
+}
+
+// Every sample in the rings, one row each, oldest first within a scope
+bool writeProfileCsv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    static uint64_t samples[PROFILE_RING_SIZE];
+    fprintf(file, "scope,start_ms,duration_ms\n");
+    for (int scope = 0; scope < PROFILE_SCOPE_COUNT; scope++) {
+        int count = copyRing(scope, samples);
+        for (int i = 0; i < count; i++) {
+            fprintf(file, "%s,%.3f,%.4f\n", scopeNames[scope],
+                    (samples[i] >> SAMPLE_DURATION_BITS) / 1e3, (samples[i] & SAMPLE_DURATION_MAX) / 1e4);
+        }
+    }
+    return fclose(file) == 0;
+}
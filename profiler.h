@@ -0,0 +1,42 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILE_RING_SIZE 4096          // Samples kept per scope (power of two)
+#define PROFILE_HISTOGRAM_BUCKETS 24    // Power-of-two buckets from 1 us up
+
+// Timed regions. Each has its own ring, written from whichever thread runs it.
+typedef enum {
+    PROFILE_FRAME,              // Everything the UI thread does per frame, minus the wait for events
+    PROFILE_INPUT,              // Polling and applying mouse and keyboard input, minus the library I/O it starts
+    PROFILE_LAYOUT,             // Re-tokenizing the sheet after edits
+    PROFILE_SEARCH,             // Rebuilding and running the song search
+    PROFILE_SCENE,              // Redrawing the scene and upload panel textures
+    PROFILE_BLUR,               // Blurring the scene behind the upload panel
+    PROFILE_LIBRARY_IO,         // Reading and writing songs (UI and loader threads)
+    PROFILE_AUDIO_RENDER,       // Synthesizing one block on the render thread
+    PROFILE_AUDIO_EFFECTS,      // Running the effect chain over that block
+    PROFILE_AUDIO_CALLBACK,     // Copying audio out in the device callback
+    PROFILE_SCOPE_COUNT
+} ProfileScope;
+
+// Durations currently held in a scope's ring
+typedef struct {
+    int count;                  // Samples in the ring
+    float p50Ms;                // Median duration in milliseconds
+    float p99Ms;                // 99th percentile duration in milliseconds
+    float maxMs;                // Longest duration in milliseconds
+    uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS]; // Bucket i counts durations below 2^i us
+} ProfileSummary;
+
+void initProfiler(void);
+double profileBegin(void);
+double profileEnd(ProfileScope scope, double started);
+double profileEndExcluding(ProfileScope scope, double started, double excluded);
+const char* profileScopeName(ProfileScope scope);
+void profileSummarize(ProfileScope scope, ProfileSummary* summary);
+bool writeProfileCsv(const char* path);
+
+#endif
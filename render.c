@@ -0,0 +1,239 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "song.h"
+#include "songcache.h"
+#include "synth.h"
+#include "effects.h"
+#include "audio.h"
+#include "render.h"
+
+#ifdef _WIN32
+#define seekFile _fseeki64
+#else
+#define seekFile fseeko
+#endif
+
+#define WAV_HEADER_SIZE 44
+#define WAV_FRAME_SIZE 4                // 16-bit stereo
+
+// One worker's contiguous, chunk-aligned slice of the output
+typedef struct {
+    const Performance* performance;
+    double rate;                        // Song seconds per rendered second
+    uint64_t totalFrames;               // Length of the whole render
+    uint64_t spanStart;                 // First frame this worker writes
+    uint64_t spanEnd;                   // One past the last frame it writes
+    EffectChain effects;                // This worker's own chain
+    const char* wavPath;
+    pthread_t thread;
+    bool ok;
+} RenderSpan;
+
+static void putLittleEndian(unsigned char* out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static bool writeWavHeader(FILE* file, uint64_t frames) {
+    uint32_t dataSize = (uint32_t)(frames * WAV_FRAME_SIZE);
+    unsigned char header[WAV_HEADER_SIZE];
+    memcpy(header, "RIFF", 4);
+    putLittleEndian(header + 4, 36 + dataSize, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    putLittleEndian(header + 16, 16, 4);                        // fmt chunk size
+    putLittleEndian(header + 20, 1, 2);                         // PCM
+    putLittleEndian(header + 22, 2, 2);                         // Channels
+    putLittleEndian(header + 24, AUDIO_SAMPLE_RATE, 4);
+    putLittleEndian(header + 28, AUDIO_SAMPLE_RATE * WAV_FRAME_SIZE, 4);
+    putLittleEndian(header + 32, WAV_FRAME_SIZE, 2);
+    putLittleEndian(header + 34, 16, 2);                        // Bits per sample
+    memcpy(header + 36, "data", 4);
+    putLittleEndian(header + 40, dataSize, 4);
+    return fwrite(header, 1, WAV_HEADER_SIZE, file) == WAV_HEADER_SIZE;
+}
+
+static uint64_t eventFrame(const RenderSpan* span, int index) {
+    return (uint64_t)(span->performance->events[index].time / span->rate * AUDIO_SAMPLE_RATE + 0.5);
+}
+
+// Render a span with its own synth and effects. Everything before the span is
+// fast-forwarded through the same chunk and event boundaries, so voices still
+// ringing at the span start sound exactly as they would in a single-threaded
+// render. The last chunks before it are rendered and run through the effects
+// unheard, enough to cover their tails, so reverb carries over the same way.
+static void* renderWorker(void* argument) {
+    RenderSpan* span = argument;
+    const Performance* performance = span->performance;
+    FILE* file = fopen(span->wavPath, "r+b");
+    Synth* synth = malloc(sizeof(Synth));
+    float* mix = malloc(sizeof(float) * 2 * RENDER_CHUNK_FRAMES);
+    int16_t* pcm = malloc(sizeof(int16_t) * 2 * RENDER_CHUNK_FRAMES);
+    if (!file || !synth || !mix || !pcm) goto done;
+    initSynth(synth, AUDIO_SAMPLE_RATE);
+
+    uint64_t tail = (uint64_t)effectChainTailFrames(&span->effects);
+    uint64_t warmStart = span->spanStart > tail ? (span->spanStart - tail) / RENDER_CHUNK_FRAMES * RENDER_CHUNK_FRAMES : 0;
+    int next = 0;
+    for (uint64_t chunk = 0; chunk < span->spanEnd; chunk += RENDER_CHUNK_FRAMES) {
+        uint64_t end = chunk + RENDER_CHUNK_FRAMES < span->totalFrames ? chunk + RENDER_CHUNK_FRAMES : span->totalFrames;
+        bool audible = chunk >= warmStart;
+
+        uint64_t frame = chunk;
+        while (frame < end) {
+            while (next < performance->eventCount && eventFrame(span, next) <= frame) {
+                const PerformanceEvent* event = &performance->events[next++];
+                if (event->velocity) synthNoteOn(synth, event->note, event->velocity);
+                else synthNoteOff(synth, event->note);
+            }
+            uint64_t stop = end;
+            if (next < performance->eventCount && eventFrame(span, next) < end) stop = eventFrame(span, next);
+            synthRender(synth, audible ? mix + (frame - chunk) * 2 : NULL, (int)(stop - frame));
+            frame = stop;
+        }
+        if (!audible) continue;
+        processEffectChain(&span->effects, mix, (int)(end - chunk));
+        if (chunk < span->spanStart) continue;
+
+        int samples = (int)(end - chunk) * 2;
+        for (int i = 0; i < samples; i++) {
+            float value = mix[i] > 1.0f ? 1.0f : (mix[i] < -1.0f ? -1.0f : mix[i]);
+            pcm[i] = (int16_t)lrintf(value * 32767.0f);
+        }
+        // Little-endian hosts only, like raylib's own WAV export
+        if (seekFile(file, WAV_HEADER_SIZE + chunk * WAV_FRAME_SIZE, SEEK_SET) != 0 ||
+            fwrite(pcm, sizeof(int16_t), samples, file) != (size_t)samples) goto done;
+    }
+    span->ok = true;
+
+done:
+    if (file && fclose(file) != 0) span->ok = false;
+    free(synth);
+    free(mix);
+    free(pcm);
+    return NULL;
+}
+
+// Render a performance to a 48 kHz 16-bit stereo WAV file, split into one
+// contiguous span per core. Each worker writes straight to its own region of
+// the file, so memory use is a few chunks per core whatever the song length.
+bool renderPerformance(const Performance* performance, float bpm, const char* wavPath) {
+    // Built first for its tail; worker 0 takes it
+    EffectChain effects;
+    createEffectChain(&effects, AUDIO_SAMPLE_RATE);
+    double rate = bpm > 0 ? bpm / performance->nativeBpm : 1.0;
+    uint64_t totalFrames = (uint64_t)((performance->duration / rate + RENDER_TAIL) * AUDIO_SAMPLE_RATE) + effectChainTailFrames(&effects);
+    if (totalFrames * WAV_FRAME_SIZE > UINT32_MAX - 36) {
+        TraceLog(LOG_ERROR, "RENDER: Song is too long for a WAV file");
+        freeEffectChain(&effects);
+        return false;
+    }
+
+    FILE* file = fopen(wavPath, "wb");
+    if (!file) {
+        TraceLog(LOG_ERROR, "RENDER: Failed to open %s for writing", wavPath);
+        freeEffectChain(&effects);
+        return false;
+    }
+    bool headerWritten = writeWavHeader(file, totalFrames);
+    if (fclose(file) != 0 || !headerWritten) {
+        TraceLog(LOG_ERROR, "RENDER: Failed to write %s", wavPath);
+        freeEffectChain(&effects);
+        return false;
+    }
+
+    // Fewer workers for short songs: every span repeats the fast-forward before it
+    uint64_t chunks = (totalFrames + RENDER_CHUNK_FRAMES - 1) / RENDER_CHUNK_FRAMES;
+    int workers = processorCount();
+    if ((uint64_t)workers > chunks / 4) workers = chunks / 4 > 0 ? (int)(chunks / 4) : 1;
+
+    RenderSpan* spans = calloc(workers, sizeof(RenderSpan));
+    if (!spans) {
+        freeEffectChain(&effects);
+        return false;
+    }
+    double start = nowSeconds();
+    for (int i = 0; i < workers; i++) {
+        RenderSpan* span = &spans[i];
+        span->performance = performance;
+        span->rate = rate;
+        span->totalFrames = totalFrames;
+        span->spanStart = chunks * i / workers * RENDER_CHUNK_FRAMES;
+        span->spanEnd = i + 1 < workers ? chunks * (i + 1) / workers * RENDER_CHUNK_FRAMES : totalFrames;
+        span->wavPath = wavPath;
+        if (i == 0) span->effects = effects;
+        else createEffectChain(&span->effects, AUDIO_SAMPLE_RATE);
+    }
+    // Worker 0 runs on this thread
+    int started = 1;
+    for (int i = 1; i < workers; i++, started++) {
+        if (pthread_create(&spans[i].thread, NULL, renderWorker, &spans[i]) != 0) break;
+    }
+    for (int i = started; i < workers; i++) renderWorker(&spans[i]);
+    renderWorker(&spans[0]);
+
+    bool ok = true;
+    for (int i = 1; i < started; i++) pthread_join(spans[i].thread, NULL);
+    for (int i = 0; i < workers; i++) {
+        ok = ok && spans[i].ok;
+        freeEffectChain(&spans[i].effects);
+    }
+    free(spans);
+
+    double elapsed = nowSeconds() - start;
+    double seconds = (double)totalFrames / AUDIO_SAMPLE_RATE;
+    if (ok) {
+        TraceLog(LOG_INFO, "RENDER: %s: %.1f s of audio in %.2f s (%.0fx realtime, %d threads)",
+                 wavPath, seconds, elapsed, elapsed > 0 ? seconds / elapsed : 0.0, workers);
+    } else {
+        TraceLog(LOG_ERROR, "RENDER: Failed while writing %s", wavPath);
+    }
+    return ok;
+}
+
+static bool renderTimeline(const Timeline* timeline, float bpm, const char* songPath, const char* wavPath) {
+    Performance performance;
+    if (timeline->eventCount == 0 || !buildPerformance(timeline, &performance)) {
+        TraceLog(LOG_ERROR, "RENDER: %s has no playable notes", songPath);
+        return false;
+    }
+    bool ok = renderPerformance(&performance, bpm, wavPath);
+    freePerformance(&performance);
+    return ok;
+}
+
+// Render a saved song at its stored BPM without opening a window. The notes
+// come straight from the song's .nvx sidecar; a song without a current one
+// is compiled and gets its sidecar written first.
+bool renderSong(const char* songPath, const char* wavPath) {
+    CompiledSong compiled;
+    if (!openCompiledSong(songPath, &compiled)) {
+        Song song;
+        if (!loadSong(songPath, &song)) {
+            TraceLog(LOG_ERROR, "RENDER: Failed to load %s", songPath);
+            return false;
+        }
+        Sheet sheet = { 0 };
+        sheetCompile(&sheet, song.sheet, song.sheetLength);
+        bool cached = writeCompiledSong(songPath, &song, &sheet) && openCompiledSong(songPath, &compiled);
+        freeSheet(&sheet);
+        if (!cached) {
+            // Unwritable directory: compile in memory. A song without notes
+            // leaves the timeline empty, which renderTimeline reports.
+            Timeline timeline;
+            loadSongTimeline(&song, &timeline);
+            bool ok = renderTimeline(&timeline, song.bpm, songPath, wavPath);
+            freeTimeline(&timeline);
+            freeSong(&song);
+            return ok;
+        }
+        freeSong(&song);
+    }
+    bool ok = renderTimeline(&compiled.timeline, compiled.bpm, songPath, wavPath);
+    closeCompiledSong(&compiled);
+    return ok;
+}
@@ -0,0 +1,13 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include "performance.h"
+
+#define RENDER_CHUNK_FRAMES 16384       // Frames rendered and written per step
+#define RENDER_TAIL 3.0                 // Seconds rendered past the end for releases
+
+bool renderPerformance(const Performance* performance, float bpm, const char* wavPath);
+bool renderSong(const char* songPath, const char* wavPath);
+
+#endif
@@ -0,0 +1,390 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "synth.h"
+#include "reverb.h"
+
+#define TWO_PI 6.283185307179586
+#define FFT_SIZE (REVERB_BLOCK * 2)
+#define BINS (REVERB_BLOCK + 1)                                 // DC up to Nyquist
+#define BIN_VECS ((BINS + SYNTH_LANES - 1) / SYNTH_LANES)
+#define HEAD_VECS (REVERB_BLOCK / SYNTH_LANES)
+
+// Left and right spectra of one block, split into real and imaginary
+// vectors. Bins past Nyquist stay zero.
+typedef struct {
+    SynthVec leftRe[BIN_VECS];
+    SynthVec leftIm[BIN_VECS];
+    SynthVec rightRe[BIN_VECS];
+    SynthVec rightIm[BIN_VECS];
+} Spectrum;
+
+// Uniformly partitioned convolution. The impulse's first block is applied
+// directly, sample by sample; the rest is cut into REVERB_BLOCK partitions
+// whose spectra are multiplied against the spectra of past input blocks
+// once per block (overlap-save). The tail computed when a block fills is
+// heard during the next one, which is the one block it is offset by, so
+// the reverb adds no latency.
+struct Reverb {
+    Spectrum* impulse;                  // Tail partitions, scaled by 1/FFT_SIZE
+    Spectrum* history;                  // Spectra of past input blocks, a ring
+    int partitions;                     // Tail partitions (and history slots)
+    int newest;                         // History slot of the last full block
+    int impulseFrames;
+    SynthVec headLeft[HEAD_VECS];       // First block of the impulse, reversed
+    SynthVec headRight[HEAD_VECS];
+    float inputLeft[FFT_SIZE];          // Previous block, then the block being filled
+    float inputRight[FFT_SIZE];
+    float tailLeft[REVERB_BLOCK];       // Tail output for the block being filled
+    float tailRight[REVERB_BLOCK];
+    int fill;                           // Frames in the block being filled
+    float wet;
+    float dry;
+    float twiddleRe[FFT_SIZE];          // Stage with half-size h starts at h - 1
+    float twiddleIm[FFT_SIZE];
+    uint16_t bitReverse[FFT_SIZE];
+    float workRe[FFT_SIZE];
+    float workIm[FFT_SIZE];
+    Spectrum sum;
+    bool wideVectors;                   // CPU has AVX, use the 8-lane paths
+};
+
+static float sumLanes(const SynthVec* vector) {
+    float sum = 0.0f;
+    for (int lane = 0; lane < SYNTH_LANES; lane++) sum += (*vector)[lane];
+    return sum;
+}
+
+// Radix-2 butterflies over bit-reversed input. Stages with eight or more
+// butterflies per group run in SynthVec lanes.
+static void fftStages(const Reverb* reverb, float* re, float* im) {
+    for (int half = 1; half < FFT_SIZE; half *= 2) {
+        const float* twiddleRe = &reverb->twiddleRe[half - 1];
+        const float* twiddleIm = &reverb->twiddleIm[half - 1];
+        for (int start = 0; start < FFT_SIZE; start += half * 2) {
+            float* aRe = re + start;
+            float* aIm = im + start;
+            float* bRe = aRe + half;
+            float* bIm = aIm + half;
+            if (half < SYNTH_LANES) {
+                for (int j = 0; j < half; j++) {
+                    float tRe = bRe[j] * twiddleRe[j] - bIm[j] * twiddleIm[j];
+                    float tIm = bRe[j] * twiddleIm[j] + bIm[j] * twiddleRe[j];
+                    bRe[j] = aRe[j] - tRe;
+                    bIm[j] = aIm[j] - tIm;
+                    aRe[j] += tRe;
+                    aIm[j] += tIm;
+                }
+                continue;
+            }
+            for (int j = 0; j < half; j += SYNTH_LANES) {
+                SynthVec xRe, xIm, yRe, yIm, wRe, wIm;
+                memcpy(&xRe, aRe + j, sizeof(xRe));
+                memcpy(&xIm, aIm + j, sizeof(xIm));
+                memcpy(&yRe, bRe + j, sizeof(yRe));
+                memcpy(&yIm, bIm + j, sizeof(yIm));
+                memcpy(&wRe, twiddleRe + j, sizeof(wRe));
+                memcpy(&wIm, twiddleIm + j, sizeof(wIm));
+                SynthVec tRe = yRe * wRe - yIm * wIm;
+                SynthVec tIm = yRe * wIm + yIm * wRe;
+                SynthVec sumRe = xRe + tRe, sumIm = xIm + tIm;
+                SynthVec differenceRe = xRe - tRe, differenceIm = xIm - tIm;
+                memcpy(aRe + j, &sumRe, sizeof(sumRe));
+                memcpy(aIm + j, &sumIm, sizeof(sumIm));
+                memcpy(bRe + j, &differenceRe, sizeof(differenceRe));
+                memcpy(bIm + j, &differenceIm, sizeof(differenceIm));
+            }
+        }
+    }
+}
+
+// Multiply-accumulate every tail partition against its input block
+static void accumulatePartitions(Reverb* reverb) {
+    Spectrum* sum = &reverb->sum;
+    memset(sum, 0, sizeof(*sum));
+    for (int p = 0; p < reverb->partitions; p++) {
+        int slot = reverb->newest - p;
+        if (slot < 0) slot += reverb->partitions;
+        const Spectrum* x = &reverb->history[slot];
+        const Spectrum* h = &reverb->impulse[p];
+        for (int v = 0; v < BIN_VECS; v++) {
+            sum->leftRe[v] += x->leftRe[v] * h->leftRe[v] - x->leftIm[v] * h->leftIm[v];
+            sum->leftIm[v] += x->leftRe[v] * h->leftIm[v] + x->leftIm[v] * h->leftRe[v];
+            sum->rightRe[v] += x->rightRe[v] * h->rightRe[v] - x->rightIm[v] * h->rightIm[v];
+            sum->rightIm[v] += x->rightRe[v] * h->rightIm[v] + x->rightIm[v] * h->rightRe[v];
+        }
+    }
+}
+
+// Direct convolution with the impulse's first block for the frames just
+// added at fill
+static void convolveHead(const Reverb* reverb, int frames, float* left, float* right) {
+    for (int f = 0; f < frames; f++) {
+        const float* inputLeft = &reverb->inputLeft[reverb->fill + f + 1];
+        const float* inputRight = &reverb->inputRight[reverb->fill + f + 1];
+        SynthVec sumLeft = { 0 };
+        SynthVec sumRight = { 0 };
+        for (int v = 0; v < HEAD_VECS; v++) {
+            SynthVec sampleLeft, sampleRight;
+            memcpy(&sampleLeft, inputLeft + v * SYNTH_LANES, sizeof(sampleLeft));
+            memcpy(&sampleRight, inputRight + v * SYNTH_LANES, sizeof(sampleRight));
+            sumLeft += sampleLeft * reverb->headLeft[v];
+            sumRight += sampleRight * reverb->headRight[v];
+        }
+        left[f] = sumLanes(&sumLeft);
+        right[f] = sumLanes(&sumRight);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Same loops compiled for AVX, picked at runtime when the CPU supports it
+__attribute__((target("avx"))) static void fftStagesAvx(const Reverb* reverb, float* re, float* im) {
+    fftStages(reverb, re, im);
+}
+
+__attribute__((target("avx"))) static void accumulatePartitionsAvx(Reverb* reverb) {
+    accumulatePartitions(reverb);
+}
+
+__attribute__((target("avx"))) static void convolveHeadAvx(const Reverb* reverb, int frames, float* left, float* right) {
+    convolveHead(reverb, frames, left, right);
+}
+#endif
+
+static void fft(Reverb* reverb, float* re, float* im) {
+    for (int i = 0; i < FFT_SIZE; i++) {
+        int j = reverb->bitReverse[i];
+        if (i >= j) continue;
+        float swap = re[i];
+        re[i] = re[j];
+        re[j] = swap;
+        swap = im[i];
+        im[i] = im[j];
+        im[j] = swap;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (reverb->wideVectors) fftStagesAvx(reverb, re, im);
+    else fftStages(reverb, re, im);
+#else
+    fftStages(reverb, re, im);
+#endif
+}
+
+// Spectra of two real blocks from one complex FFT of left + i*right
+static void forwardSpectrum(Reverb* reverb, const float* left, const float* right, Spectrum* out) {
+    float* re = reverb->workRe;
+    float* im = reverb->workIm;
+    memcpy(re, left, sizeof(float) * FFT_SIZE);
+    memcpy(im, right, sizeof(float) * FFT_SIZE);
+    fft(reverb, re, im);
+
+    memset(out, 0, sizeof(*out));
+    for (int k = 0; k < BINS; k++) {
+        int mirror = (FFT_SIZE - k) & (FFT_SIZE - 1);
+        float a = re[k], b = im[k], c = re[mirror], d = im[mirror];
+        int v = k / SYNTH_LANES, lane = k % SYNTH_LANES;
+        out->leftRe[v][lane] = 0.5f * (a + c);
+        out->leftIm[v][lane] = 0.5f * (b - d);
+        out->rightRe[v][lane] = 0.5f * (b + d);
+        out->rightIm[v][lane] = 0.5f * (c - a);
+    }
+}
+
+// Back to two real blocks through one inverse FFT, keeping the last
+// REVERB_BLOCK samples (the ones overlap-save leaves uncorrupted)
+static void inverseSpectrum(Reverb* reverb, const Spectrum* in, float* left, float* right) {
+    float* re = reverb->workRe;
+    float* im = reverb->workIm;
+    // Conjugated, so the forward transform runs the inverse
+    for (int k = 0; k < BINS; k++) {
+        int v = k / SYNTH_LANES, lane = k % SYNTH_LANES;
+        float leftRe = in->leftRe[v][lane], leftIm = in->leftIm[v][lane];
+        float rightRe = in->rightRe[v][lane], rightIm = in->rightIm[v][lane];
+        re[k] = leftRe - rightIm;
+        im[k] = -(leftIm + rightRe);
+        if (k > 0 && k < REVERB_BLOCK) {
+            re[FFT_SIZE - k] = leftRe + rightIm;
+            im[FFT_SIZE - k] = -(rightRe - leftIm);
+        }
+    }
+    fft(reverb, re, im);
+    for (int i = 0; i < REVERB_BLOCK; i++) {
+        left[i] = re[REVERB_BLOCK + i];
+        right[i] = -im[REVERB_BLOCK + i];
+    }
+}
+
+// A block has filled: add its spectrum to the history and work out the
+// tail for the next block
+static void finishBlock(Reverb* reverb) {
+    if (reverb->partitions > 0) {
+        reverb->newest = (reverb->newest + 1) % reverb->partitions;
+        forwardSpectrum(reverb, reverb->inputLeft, reverb->inputRight, &reverb->history[reverb->newest]);
+#if defined(__x86_64__) || defined(__i386__)
+        if (reverb->wideVectors) accumulatePartitionsAvx(reverb);
+        else accumulatePartitions(reverb);
+#else
+        accumulatePartitions(reverb);
+#endif
+        inverseSpectrum(reverb, &reverb->sum, reverb->tailLeft, reverb->tailRight);
+    }
+    memmove(reverb->inputLeft, reverb->inputLeft + REVERB_BLOCK, sizeof(float) * REVERB_BLOCK);
+    memmove(reverb->inputRight, reverb->inputRight + REVERB_BLOCK, sizeof(float) * REVERB_BLOCK);
+}
+
+// Impulse is interleaved with one or two channels; a mono impulse is used
+// for both sides. It is normalized to unit energy on its louder side, so mix
+// trades level evenly between dry and wet.
+Reverb* createReverb(const float* impulse, int frames, int channels, float mix) {
+    if (!impulse || frames <= 0 || channels < 1) return NULL;
+    int right = channels > 1 ? 1 : 0;
+    double energyLeft = 0.0, energyRight = 0.0;
+    for (int i = 0; i < frames; i++) {
+        energyLeft += (double)impulse[i * channels] * impulse[i * channels];
+        energyRight += (double)impulse[i * channels + right] * impulse[i * channels + right];
+    }
+    double energy = energyLeft > energyRight ? energyLeft : energyRight;
+    if (energy <= 0.0) return NULL;
+    float scale = (float)(1.0 / sqrt(energy));
+
+    Reverb* reverb = calloc(1, sizeof(Reverb));
+    if (!reverb) return NULL;
+    reverb->impulseFrames = frames;
+    reverb->partitions = frames > REVERB_BLOCK ? (frames - 1) / REVERB_BLOCK : 0;
+    if (reverb->partitions > 0) {
+        reverb->impulse = malloc(sizeof(Spectrum) * reverb->partitions);
+        reverb->history = calloc(reverb->partitions, sizeof(Spectrum));
+        if (!reverb->impulse || !reverb->history) {
+            destroyReverb(reverb);
+            return NULL;
+        }
+    }
+    if (mix < 0.0f) mix = 0.0f;
+    if (mix > 1.0f) mix = 1.0f;
+    reverb->wet = mix;
+    reverb->dry = 1.0f - mix;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    reverb->wideVectors = __builtin_cpu_supports("avx");
+#endif
+
+    int bits = 0;
+    while ((1 << bits) < FFT_SIZE) bits++;
+    for (int i = 0; i < FFT_SIZE; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        reverb->bitReverse[i] = (uint16_t)reversed;
+    }
+    for (int half = 1; half < FFT_SIZE; half *= 2) {
+        for (int j = 0; j < half; j++) {
+            double angle = -TWO_PI * j / (half * 2);
+            reverb->twiddleRe[half - 1 + j] = (float)cos(angle);
+            reverb->twiddleIm[half - 1 + j] = (float)sin(angle);
+        }
+    }
+
+    for (int i = 0; i < REVERB_BLOCK; i++) {
+        int tap = REVERB_BLOCK - 1 - i;
+        if (tap >= frames) continue;
+        reverb->headLeft[i / SYNTH_LANES][i % SYNTH_LANES] = impulse[tap * channels] * scale;
+        reverb->headRight[i / SYNTH_LANES][i % SYNTH_LANES] = impulse[tap * channels + right] * scale;
+    }
+
+    // The input buffers are free until the first block, so partitions are
+    // zero-padded in them
+    for (int p = 0; p < reverb->partitions; p++) {
+        memset(reverb->inputLeft, 0, sizeof(reverb->inputLeft));
+        memset(reverb->inputRight, 0, sizeof(reverb->inputRight));
+        for (int i = 0; i < REVERB_BLOCK; i++) {
+            int tap = (p + 1) * REVERB_BLOCK + i;
+            if (tap >= frames) break;
+            reverb->inputLeft[i] = impulse[tap * channels] * scale / FFT_SIZE;
+            reverb->inputRight[i] = impulse[tap * channels + right] * scale / FFT_SIZE;
+        }
+        forwardSpectrum(reverb, reverb->inputLeft, reverb->inputRight, &reverb->impulse[p]);
+    }
+    memset(reverb->inputLeft, 0, sizeof(reverb->inputLeft));
+    memset(reverb->inputRight, 0, sizeof(reverb->inputRight));
+    return reverb;
+}
+
+// Load an impulse response through raylib, converted to the output rate and
+// cut to REVERB_MAX_SECONDS
+Reverb* loadReverb(const char* impulsePath, float sampleRate, float mix) {
+    Wave wave = LoadWave(impulsePath);
+    if (!wave.data || wave.frameCount == 0) {
+        TraceLog(LOG_WARNING, "REVERB: Failed to load %s", impulsePath);
+        return NULL;
+    }
+    int channels = wave.channels > 1 ? 2 : 1;
+    WaveFormat(&wave, (int)sampleRate, 32, channels);
+    float* samples = LoadWaveSamples(wave);
+    int frames = (int)wave.frameCount;
+    int maxFrames = (int)(REVERB_MAX_SECONDS * sampleRate);
+    if (frames > maxFrames) {
+        TraceLog(LOG_WARNING, "REVERB: Cutting %s to %.0f seconds", impulsePath, REVERB_MAX_SECONDS);
+        frames = maxFrames;
+    }
+    Reverb* reverb = samples ? createReverb(samples, frames, channels, mix) : NULL;
+    if (samples) UnloadWaveSamples(samples);
+    UnloadWave(wave);
+
+    if (reverb) {
+        TraceLog(LOG_INFO, "REVERB: Loaded %s (%.2f s, %d partitions)", impulsePath, frames / sampleRate, reverb->partitions);
+    } else {
+        TraceLog(LOG_WARNING, "REVERB: %s is silent or could not be prepared", impulsePath);
+    }
+    return reverb;
+}
+
+void destroyReverb(Reverb* reverb) {
+    if (!reverb) return;
+    free(reverb->impulse);
+    free(reverb->history);
+    free(reverb);
+}
+
+// Convolve interleaved stereo frames in place, mixing wet over dry. Any
+// frame count works; the FFT runs each time REVERB_BLOCK frames have
+// arrived. Never allocates or blocks.
+void reverbProcess(Reverb* reverb, float* buffer, int frames) {
+    float headLeft[REVERB_BLOCK];
+    float headRight[REVERB_BLOCK];
+    while (frames > 0) {
+        int fill = reverb->fill;
+        int count = frames < REVERB_BLOCK - fill ? frames : REVERB_BLOCK - fill;
+        for (int f = 0; f < count; f++) {
+            reverb->inputLeft[REVERB_BLOCK + fill + f] = buffer[f * 2];
+            reverb->inputRight[REVERB_BLOCK + fill + f] = buffer[f * 2 + 1];
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        if (reverb->wideVectors) convolveHeadAvx(reverb, count, headLeft, headRight);
+        else convolveHead(reverb, count, headLeft, headRight);
+#else
+        convolveHead(reverb, count, headLeft, headRight);
+#endif
+        for (int f = 0; f < count; f++) {
+            float wetLeft = headLeft[f] + reverb->tailLeft[fill + f];
+            float wetRight = headRight[f] + reverb->tailRight[fill + f];
+            buffer[f * 2] = buffer[f * 2] * reverb->dry + wetLeft * reverb->wet;
+            buffer[f * 2 + 1] = buffer[f * 2 + 1] * reverb->dry + wetRight * reverb->wet;
+        }
+
+        reverb->fill += count;
+        if (reverb->fill == REVERB_BLOCK) {
+            finishBlock(reverb);
+            reverb->fill = 0;
+        }
+        buffer += count * 2;
+        frames -= count;
+    }
+}
+
+// Frames of past input that still reach the output, including the blocks
+// the partitions need to settle. Rendering this much before a point leaves
+// the reverb exactly as a render from the start would.
+int reverbTailFrames(const Reverb* reverb) {
+    return reverb->impulseFrames + 2 * REVERB_BLOCK;
+}
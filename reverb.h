@@ -0,0 +1,16 @@
+#ifndef REVERB_H
+#define REVERB_H
+
+#define REVERB_BLOCK 512                // Partition size; the first partition is convolved directly
+#define REVERB_MAX_SECONDS 10.0f        // Longer impulse responses are cut
+#define REVERB_DEFAULT_MIX 0.25f        // Wet share of the output
+
+typedef struct Reverb Reverb;
+
+Reverb* createReverb(const float* impulse, int frames, int channels, float mix);
+Reverb* loadReverb(const char* impulsePath, float sampleRate, float mix);
+void destroyReverb(Reverb* reverb);
+void reverbProcess(Reverb* reverb, float* buffer, int frames);
+int reverbTailFrames(const Reverb* reverb);
+
+#endif
@@ -0,0 +1,698 @@
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "synth.h"
+#include "sampler.h"
+
+#define MIN_ATTACK_FRAMES 4096          // Shortest attack kept however small the budget
+#define MAX_STEP 4.0                    // Fastest a sample is played back (two octaves up)
+#define SCRATCH_FRAMES (SYNTH_BLOCK * 4 + 16) // Source frames one block can read at MAX_STEP
+#define PREFETCH_PERIOD 0.002           // Seconds the prefetch thread sleeps when all streams are full
+#define PREFETCH_CHUNK 4096             // Frames decoded per stream before moving to the next
+#define DEFAULT_RELEASE 0.25f           // Damper release in seconds when the SFZ gives none
+#define SILENCE 0.0001f                 // Release level at which a voice is freed
+#define SAMPLER_GAIN 0.5f               // Headroom for chords before the soft clip
+
+// One WAV file, mapped. Frames past attackFrames are only read by the
+// prefetch thread.
+typedef struct {
+    char* path;
+    MappedFile file;
+    const unsigned char* data;  // First frame of the data chunk
+    int format;                 // 1 = integer PCM, 3 = float
+    int bits;
+    int channels;
+    int frameBytes;
+    uint32_t frames;
+    float rate;
+    float* attack;              // First attackFrames frames decoded, interleaved stereo
+    uint32_t attackFrames;
+} SampleFile;
+
+// Key and velocity range a sample plays, from an SFZ <region>
+typedef struct {
+    int sample;                 // Index into samples
+    int loKey;
+    int hiKey;
+    int keyCenter;              // Key the sample was recorded at
+    int loVel;
+    int hiVel;
+    float gain;                 // volume opcode as a factor
+    float tune;                 // Cents
+    float release;              // Seconds
+} SamplerRegion;
+
+// Tail of one voice's sample, decoded ahead by the prefetch thread into a
+// ring indexed by source frame. Each value carries the voice generation in
+// its top 32 bits, so data for a note that has since been replaced is never
+// used.
+typedef struct {
+    float* ring;                // SAMPLER_STREAM_FRAMES interleaved stereo frames
+    _Atomic int sample;         // Sample being streamed (-1 when the voice is free); render thread writes
+    _Atomic uint64_t position;  // Lowest source frame still needed; render thread writes
+    _Atomic uint64_t filled;    // Source frames decoded up to; prefetch thread writes
+} VoiceStream;
+
+typedef struct {
+    bool active;
+    bool releasing;
+    int note;
+    int sample;
+    uint32_t generation;
+    uint64_t startFrame;        // For stealing the oldest
+    double position;            // Source frame of the next output frame
+    double step;                // Source frames per output frame
+    float gain;                 // Velocity and region volume
+    float level;                // Release envelope, 1 while held
+    float releaseFactor;        // Per-frame release multiplier
+} SamplerVoice;
+
+struct Sampler {
+    SampleFile* samples;
+    int sampleCount;
+    SamplerRegion* regions;
+    int regionCount;
+    float sampleRate;
+    uint64_t frame;
+    int activeVoices;
+    bool wideVectors;           // CPU has AVX, use the 8-lane resampler
+    SamplerVoice voices[SAMPLER_MAX_VOICES];
+    VoiceStream streams[SAMPLER_MAX_VOICES];
+    atomic_bool running;
+    pthread_t prefetchThread;
+    bool threadStarted;
+    _Atomic uint32_t starved;   // Voice blocks that ran ahead of their stream
+};
+
+static uint32_t readLe16(const unsigned char* p) {
+    return p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t readLe32(const unsigned char* p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static float decodeValue(const SampleFile* sample, const unsigned char* p) {
+    switch (sample->bits) {
+        case 16: return (int16_t)readLe16(p) / 32768.0f;
+        case 24: return (int32_t)(readLe32(p - 1) & 0xFFFFFF00u) / 2147483648.0f;
+        default:
+            if (sample->format == 3) {
+                uint32_t bits = readLe32(p);
+                float value;
+                memcpy(&value, &bits, sizeof(float));
+                return value;
+            }
+            return (int32_t)readLe32(p) / 2147483648.0f;
+    }
+}
+
+// Decode count frames from first into interleaved stereo; mono is doubled
+static void decodeFrames(const SampleFile* sample, uint32_t first, uint32_t count, float* output) {
+    int valueBytes = sample->bits / 8;
+    const unsigned char* p = sample->data + (size_t)first * sample->frameBytes;
+    for (uint32_t i = 0; i < count; i++, p += sample->frameBytes) {
+        float left = decodeValue(sample, p);
+        output[i * 2] = left;
+        output[i * 2 + 1] = sample->channels > 1 ? decodeValue(sample, p + valueBytes) : left;
+    }
+}
+
+// Map a WAV file and find its format and data chunk. 24-bit values are read
+// as the 32-bit word ending at them, so the data must not start the mapping.
+static bool openSampleFile(SampleFile* sample, const char* path) {
+    if (!mapFile(path, &sample->file)) return false;
+    const unsigned char* data = sample->file.data;
+    size_t size = sample->file.size;
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+    bool haveFormat = false;
+    for (size_t offset = 12; offset + 8 <= size; ) {
+        const unsigned char* chunk = data + offset;
+        uint32_t chunkSize = readLe32(chunk + 4);
+        size_t available = size - offset - 8;
+        if (chunkSize > available) chunkSize = (uint32_t)available;
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+            sample->format = (int)readLe16(chunk + 8);
+            sample->channels = (int)readLe16(chunk + 10);
+            sample->rate = (float)readLe32(chunk + 12);
+            sample->bits = (int)readLe16(chunk + 22);
+            if (sample->format == 0xFFFE && chunkSize >= 40) sample->format = (int)readLe16(chunk + 32);
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && haveFormat) {
+            bool supported = sample->channels >= 1 && sample->channels <= 2 && sample->rate > 0 &&
+                             ((sample->format == 1 && (sample->bits == 16 || sample->bits == 24 || sample->bits == 32)) ||
+                              (sample->format == 3 && sample->bits == 32));
+            if (!supported) return false;
+            sample->frameBytes = sample->channels * sample->bits / 8;
+            sample->data = chunk + 8;
+            sample->frames = chunkSize / sample->frameBytes;
+            return sample->frames > 0;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+// Note number from a number or a name like c4, f#3 or eb5 (c4 is 60)
+static int parseKey(const char* value) {
+    if (isdigit((unsigned char)value[0]) || value[0] == '-') return atoi(value);
+    static const int semitones[] = { 9, 11, 0, 2, 4, 5, 7 };    // a b c d e f g
+    char letter = (char)tolower((unsigned char)value[0]);
+    if (letter < 'a' || letter > 'g') return -1;
+    int note = semitones[letter - 'a'];
+    value++;
+    if (*value == '#') { note++; value++; }
+    else if (*value == 'b') { note--; value++; }
+    return note + (atoi(value) + 1) * 12;
+}
+
+// Header levels, outermost first. Each level starts from the nearest open
+// level above it; opening a level closes the ones below.
+enum { SFZ_GLOBAL, SFZ_MASTER, SFZ_GROUP, SFZ_REGION, SFZ_LEVELS };
+
+// Opcodes in effect for a region: <global>, then <master>, then <group>,
+// then its own
+typedef struct {
+    char sample[512];
+    int loKey;
+    int hiKey;
+    int keyCenter;
+    int loVel;
+    int hiVel;
+    float volume;
+    float tune;
+    float release;
+} SfzRegion;
+
+static void applyOpcode(SfzRegion* region, char* defaultPath, const char* name, const char* value) {
+    if (strcmp(name, "sample") == 0) snprintf(region->sample, sizeof(region->sample), "%s", value);
+    else if (strcmp(name, "default_path") == 0) snprintf(defaultPath, 512, "%s", value);
+    else if (strcmp(name, "key") == 0) region->loKey = region->hiKey = region->keyCenter = parseKey(value);
+    else if (strcmp(name, "lokey") == 0) region->loKey = parseKey(value);
+    else if (strcmp(name, "hikey") == 0) region->hiKey = parseKey(value);
+    else if (strcmp(name, "pitch_keycenter") == 0) region->keyCenter = parseKey(value);
+    else if (strcmp(name, "lovel") == 0) region->loVel = atoi(value);
+    else if (strcmp(name, "hivel") == 0) region->hiVel = atoi(value);
+    else if (strcmp(name, "volume") == 0) region->volume = (float)atof(value);
+    else if (strcmp(name, "tune") == 0) region->tune = (float)atof(value);
+    else if (strcmp(name, "ampeg_release") == 0) region->release = (float)atof(value);
+}
+
+// Sample, shared by every region that names the same file
+static int findSample(Sampler* sampler, const char* path) {
+    for (int i = 0; i < sampler->sampleCount; i++) {
+        if (strcmp(sampler->samples[i].path, path) == 0) return i;
+    }
+    SampleFile* samples = realloc(sampler->samples, sizeof(SampleFile) * (sampler->sampleCount + 1));
+    if (!samples) return -1;
+    sampler->samples = samples;
+    SampleFile* sample = &samples[sampler->sampleCount];
+    memset(sample, 0, sizeof(*sample));
+    if (!openSampleFile(sample, path) || !(sample->path = strdup(path))) {
+        TraceLog(LOG_WARNING, "SAMPLER: Skipping unreadable sample %s", path);
+        unmapFile(&sample->file);
+        return -1;
+    }
+    return sampler->sampleCount++;
+}
+
+static void addRegion(Sampler* sampler, const SfzRegion* spec, const char* directory, const char* defaultPath) {
+    if (!spec->sample[0]) return;
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s%s", directory, defaultPath, spec->sample);
+    for (char* c = path; *c; c++) {
+        if (*c == '\\') *c = '/';
+    }
+    int sample = findSample(sampler, path);
+    if (sample < 0) return;
+
+    SamplerRegion* regions = realloc(sampler->regions, sizeof(SamplerRegion) * (sampler->regionCount + 1));
+    if (!regions) return;
+    sampler->regions = regions;
+    SamplerRegion* region = &regions[sampler->regionCount++];
+    region->sample = sample;
+    region->loKey = spec->loKey;
+    region->hiKey = spec->hiKey;
+    region->keyCenter = spec->keyCenter >= 0 ? spec->keyCenter : spec->loKey;
+    region->loVel = spec->loVel;
+    region->hiVel = spec->hiVel;
+    region->gain = powf(10.0f, spec->volume / 20.0f);
+    region->tune = spec->tune;
+    region->release = spec->release > 0 ? spec->release : DEFAULT_RELEASE;
+}
+
+// Read the subset of SFZ a multisampled piano needs: sample, key ranges,
+// key centre, velocity layers, volume, tune and release. Values run to the
+// end of the line or the next opcode, so sample names may hold spaces.
+// Regions inherit from <global>, <master> and <group>, whichever are open.
+static bool loadSfz(Sampler* sampler, const char* path) {
+    MappedFile file;
+    if (!mapFile(path, &file)) return false;
+    char* text = malloc(file.size + 1);
+    if (!text) {
+        unmapFile(&file);
+        return false;
+    }
+    memcpy(text, file.data, file.size);
+    text[file.size] = '\0';
+    unmapFile(&file);
+
+    char directory[1024];
+    snprintf(directory, sizeof(directory), "%s", path);
+    char* slash = strrchr(directory, '/');
+    char* backslash = strrchr(directory, '\\');
+    if (backslash > slash) slash = backslash;
+    if (slash) *slash = '\0';
+    else strcpy(directory, ".");
+
+    const SfzRegion defaults = { "", 0, 127, -1, 1, 127, 0, 0, 0 };
+    SfzRegion levels[SFZ_LEVELS];
+    bool open[SFZ_LEVELS] = { false };
+    SfzRegion scratch;          // Opcodes of <control> and unknown headers
+    SfzRegion* current = &levels[SFZ_GLOBAL];
+    levels[SFZ_GLOBAL] = defaults;
+    open[SFZ_GLOBAL] = true;
+    char defaultPath[512] = "";
+    bool inRegion = false;
+
+    char* c = text;
+    while (*c) {
+        if (isspace((unsigned char)*c)) {
+            c++;
+        } else if (c[0] == '/' && c[1] == '/') {
+            while (*c && *c != '\n') c++;
+        } else if (*c == '<') {
+            char* end = strchr(c, '>');
+            if (!end) break;
+            if (inRegion) addRegion(sampler, &levels[SFZ_REGION], directory, defaultPath);
+            inRegion = false;
+            size_t length = (size_t)(end - c - 1);
+            int level = -1;
+            if (length == 6 && strncmp(c + 1, "global", 6) == 0) level = SFZ_GLOBAL;
+            else if (length == 6 && strncmp(c + 1, "master", 6) == 0) level = SFZ_MASTER;
+            else if (length == 5 && strncmp(c + 1, "group", 5) == 0) level = SFZ_GROUP;
+            else if (length == 6 && strncmp(c + 1, "region", 6) == 0) level = SFZ_REGION;
+            if (level >= 0) {
+                int parent = level - 1;
+                while (parent >= 0 && !open[parent]) parent--;
+                levels[level] = parent >= 0 ? levels[parent] : defaults;
+                for (int i = level; i < SFZ_LEVELS; i++) open[i] = i == level;
+                current = &levels[level];
+                inRegion = level == SFZ_REGION;
+            } else {
+                // <control> (default_path still applies) and headers this
+                // sampler ignores; their opcodes must not reach regions
+                scratch = defaults;
+                current = &scratch;
+            }
+            c = end + 1;
+        } else {
+            char* equals = c;
+            while (*equals && *equals != '=' && !isspace((unsigned char)*equals)) equals++;
+            if (*equals != '=') {
+                c = equals;
+                continue;
+            }
+            char* value = equals + 1;
+            char* end = value;
+            while (*end && *end != '\n' && *end != '\r' && *end != '<' && !(end[0] == '/' && end[1] == '/')) {
+                if (isspace((unsigned char)*end)) {
+                    // A following name= starts the next opcode
+                    char* next = end;
+                    while (*next == ' ' || *next == '\t') next++;
+                    char* name = next;
+                    while (isalnum((unsigned char)*name) || *name == '_') name++;
+                    if (name > next && *name == '=') break;
+                }
+                end++;
+            }
+            char* valueEnd = end;
+            while (valueEnd > value && isspace((unsigned char)valueEnd[-1])) valueEnd--;
+            char saved = *valueEnd;
+            *equals = '\0';
+            *valueEnd = '\0';
+            applyOpcode(current, defaultPath, c, value);
+            *valueEnd = saved;
+            c = end;
+        }
+    }
+    if (inRegion) addRegion(sampler, &levels[SFZ_REGION], directory, defaultPath);
+    free(text);
+    return sampler->regionCount > 0;
+}
+
+// Decode the start of every sample, as long as the budget allows
+static bool decodeAttacks(Sampler* sampler, size_t memoryBudget) {
+    size_t streamBytes = sizeof(float) * 2 * SAMPLER_STREAM_FRAMES * SAMPLER_MAX_VOICES;
+    size_t attackBytes = memoryBudget > streamBytes ? memoryBudget - streamBytes : 0;
+    uint64_t perSample = attackBytes / (sizeof(float) * 2 * sampler->sampleCount);
+    if (perSample < MIN_ATTACK_FRAMES) {
+        TraceLog(LOG_WARNING, "SAMPLER: Memory budget too small, keeping %d frames of each sample", MIN_ATTACK_FRAMES);
+        perSample = MIN_ATTACK_FRAMES;
+    }
+    for (int i = 0; i < sampler->sampleCount; i++) {
+        SampleFile* sample = &sampler->samples[i];
+        uint64_t frames = (uint64_t)(SAMPLER_ATTACK_SECONDS * sample->rate);
+        if (frames > perSample) frames = perSample;
+        if (frames > sample->frames) frames = sample->frames;
+        sample->attack = malloc(sizeof(float) * 2 * frames);
+        if (!sample->attack) return false;
+        sample->attackFrames = (uint32_t)frames;
+        decodeFrames(sample, 0, sample->attackFrames, sample->attack);
+    }
+    return true;
+}
+
+// Keeps every playing voice's stream up to SAMPLER_STREAM_FRAMES ahead of
+// where it is reading. Page faults on the mapped files land here, never on
+// the render thread.
+static void* prefetchThread(void* argument) {
+    Sampler* sampler = argument;
+    while (atomic_load_explicit(&sampler->running, memory_order_acquire)) {
+        bool busy = false;
+        for (int v = 0; v < SAMPLER_MAX_VOICES; v++) {
+            VoiceStream* stream = &sampler->streams[v];
+            uint64_t position = atomic_load_explicit(&stream->position, memory_order_acquire);
+            int index = atomic_load_explicit(&stream->sample, memory_order_relaxed);
+            if (index < 0) continue;
+            const SampleFile* sample = &sampler->samples[index];
+            uint32_t generation = (uint32_t)(position >> 32);
+            uint64_t filled = atomic_load_explicit(&stream->filled, memory_order_relaxed);
+            uint32_t first = (uint32_t)(filled >> 32) == generation ? (uint32_t)filled : sample->attackFrames;
+            uint64_t limit = (uint32_t)position + (uint64_t)SAMPLER_STREAM_FRAMES;
+            if (limit > sample->frames) limit = sample->frames;
+            if (first >= limit) continue;
+
+            uint32_t end = limit - first > PREFETCH_CHUNK ? first + PREFETCH_CHUNK : (uint32_t)limit;
+            for (uint32_t frame = first; frame < end; ) {
+                uint32_t slot = frame & (SAMPLER_STREAM_FRAMES - 1);
+                uint32_t run = SAMPLER_STREAM_FRAMES - slot < end - frame ? SAMPLER_STREAM_FRAMES - slot : end - frame;
+                decodeFrames(sample, frame, run, &stream->ring[slot * 2]);
+                frame += run;
+            }
+            atomic_store_explicit(&stream->filled, (uint64_t)generation << 32 | end, memory_order_release);
+            busy = true;
+        }
+        if (!busy) sleepUntil(nowSeconds() + PREFETCH_PERIOD);
+    }
+    return NULL;
+}
+
+// Load an SFZ multisample set and start its prefetch thread. NULL if no
+// region has a usable sample.
+Sampler* createSampler(const char* sfzPath, float sampleRate, size_t memoryBudget) {
+    Sampler* sampler = calloc(1, sizeof(Sampler));
+    if (!sampler) return NULL;
+    sampler->sampleRate = sampleRate;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    sampler->wideVectors = __builtin_cpu_supports("avx");
+#endif
+    for (int v = 0; v < SAMPLER_MAX_VOICES; v++) atomic_init(&sampler->streams[v].sample, -1);
+
+    bool ok = loadSfz(sampler, sfzPath) && decodeAttacks(sampler, memoryBudget);
+    for (int v = 0; ok && v < SAMPLER_MAX_VOICES; v++) {
+        sampler->streams[v].ring = malloc(sizeof(float) * 2 * SAMPLER_STREAM_FRAMES);
+        ok = sampler->streams[v].ring != NULL;
+    }
+    if (ok) {
+        atomic_store(&sampler->running, true);
+        sampler->threadStarted = pthread_create(&sampler->prefetchThread, NULL, prefetchThread, sampler) == 0;
+        ok = sampler->threadStarted;
+    }
+    if (!ok) {
+        TraceLog(LOG_WARNING, "SAMPLER: Failed to load %s", sfzPath);
+        destroySampler(sampler);
+        return NULL;
+    }
+    TraceLog(LOG_INFO, "SAMPLER: Loaded %d regions over %d samples from %s", sampler->regionCount, sampler->sampleCount, sfzPath);
+    return sampler;
+}
+
+void destroySampler(Sampler* sampler) {
+    if (!sampler) return;
+    if (sampler->threadStarted) {
+        atomic_store(&sampler->running, false);
+        pthread_join(sampler->prefetchThread, NULL);
+    }
+    uint32_t starved = atomic_load(&sampler->starved);
+    if (starved > 0) TraceLog(LOG_WARNING, "SAMPLER: %u voice blocks ran ahead of their stream", starved);
+    for (int v = 0; v < SAMPLER_MAX_VOICES; v++) free(sampler->streams[v].ring);
+    for (int i = 0; i < sampler->sampleCount; i++) {
+        free(sampler->samples[i].attack);
+        free(sampler->samples[i].path);
+        unmapFile(&sampler->samples[i].file);
+    }
+    free(sampler->samples);
+    free(sampler->regions);
+    free(sampler);
+}
+
+// Region for a note: one whose key and velocity ranges hold it, otherwise
+// the nearest key range in its velocity layer, pitched from there
+static int findRegion(const Sampler* sampler, int note, int velocity) {
+    int best = -1;
+    int bestDistance = 0;
+    for (int pass = 0; pass < 2 && best < 0; pass++) {
+        for (int i = 0; i < sampler->regionCount; i++) {
+            const SamplerRegion* region = &sampler->regions[i];
+            if (pass == 0 && (velocity < region->loVel || velocity > region->hiVel)) continue;
+            int distance = note < region->loKey ? region->loKey - note : note > region->hiKey ? note - region->hiKey : 0;
+            distance = distance * 256 + abs(note - region->keyCenter);
+            if (best < 0 || distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+    }
+    return best;
+}
+
+// Free voice if there is one, otherwise the quietest releasing voice,
+// otherwise the oldest voice
+static int allocateVoice(const Sampler* sampler) {
+    int quietest = -1;
+    int oldest = 0;
+    for (int v = 0; v < SAMPLER_MAX_VOICES; v++) {
+        const SamplerVoice* voice = &sampler->voices[v];
+        if (!voice->active) return v;
+        if (voice->releasing && (quietest < 0 || voice->level < sampler->voices[quietest].level)) quietest = v;
+        if (voice->startFrame < sampler->voices[oldest].startFrame) oldest = v;
+    }
+    return quietest >= 0 ? quietest : oldest;
+}
+
+static void freeVoice(Sampler* sampler, int index) {
+    sampler->voices[index].active = false;
+    sampler->activeVoices--;
+    atomic_store_explicit(&sampler->streams[index].sample, -1, memory_order_relaxed);
+}
+
+void samplerNoteOn(Sampler* sampler, int note, int velocity) {
+    if (note < 0 || note > 127) return;
+    if (velocity <= 0) {
+        samplerNoteOff(sampler, note);
+        return;
+    }
+    int regionIndex = findRegion(sampler, note, velocity);
+    if (regionIndex < 0) return;
+    const SamplerRegion* region = &sampler->regions[regionIndex];
+    const SampleFile* sample = &sampler->samples[region->sample];
+
+    int index = allocateVoice(sampler);
+    SamplerVoice* voice = &sampler->voices[index];
+    if (!voice->active) sampler->activeVoices++;
+    double step = pow(2.0, (note - region->keyCenter) / 12.0 + region->tune / 1200.0) * sample->rate / sampler->sampleRate;
+    float loudness = velocity > 127 ? 1.0f : velocity / 127.0f;
+    float gain = SAMPLER_GAIN * region->gain * loudness * loudness;
+
+    voice->active = true;
+    voice->releasing = false;
+    voice->note = note;
+    voice->sample = region->sample;
+    voice->generation++;
+    voice->startFrame = sampler->frame;
+    voice->position = 0;
+    voice->step = step < MAX_STEP ? step : MAX_STEP;
+    voice->gain = gain;
+    voice->level = 1.0f;
+    voice->releaseFactor = expf(-4.6f / (region->release * sampler->sampleRate));
+
+    VoiceStream* stream = &sampler->streams[index];
+    atomic_store_explicit(&stream->sample, region->sample, memory_order_relaxed);
+    atomic_store_explicit(&stream->position, (uint64_t)voice->generation << 32, memory_order_release);
+}
+
+// Release the oldest held voice playing this note
+void samplerNoteOff(Sampler* sampler, int note) {
+    int found = -1;
+    for (int v = 0; v < SAMPLER_MAX_VOICES; v++) {
+        const SamplerVoice* voice = &sampler->voices[v];
+        if (!voice->active || voice->releasing || voice->note != note) continue;
+        if (found < 0 || voice->startFrame < sampler->voices[found].startFrame) found = v;
+    }
+    if (found >= 0) sampler->voices[found].releasing = true;
+}
+
+void samplerAllNotesOff(Sampler* sampler) {
+    for (int v = 0; v < SAMPLER_MAX_VOICES; v++) {
+        if (sampler->voices[v].active) sampler->voices[v].releasing = true;
+    }
+}
+
+int samplerActiveVoices(const Sampler* sampler) {
+    return sampler->activeVoices;
+}
+
+// Catmull-Rom interpolation of SYNTH_LANES output frames at a time. The taps
+// are gathered lane by lane; the polynomial runs on whole vectors. source
+// holds the voice's frames from one before its position.
+static inline __attribute__((always_inline)) void resampleVoice(const float* sourceLeft, const float* sourceRight, double offset,
+                                                                double step, const float* gain, int frames, float* left, float* right) {
+    for (int f = 0; f < frames; f += SYNTH_LANES) {
+        SynthVec frac, l0, l1, l2, l3, r0, r1, r2, r3, g, outLeft, outRight;
+        for (int lane = 0; lane < SYNTH_LANES; lane++) {
+            double position = offset + (f + lane) * step;
+            int i = (int)position;
+            frac[lane] = (float)(position - i);
+            l0[lane] = sourceLeft[i - 1];
+            l1[lane] = sourceLeft[i];
+            l2[lane] = sourceLeft[i + 1];
+            l3[lane] = sourceLeft[i + 2];
+            r0[lane] = sourceRight[i - 1];
+            r1[lane] = sourceRight[i];
+            r2[lane] = sourceRight[i + 1];
+            r3[lane] = sourceRight[i + 2];
+        }
+        memcpy(&g, &gain[f], sizeof(g));
+        memcpy(&outLeft, &left[f], sizeof(outLeft));
+        memcpy(&outRight, &right[f], sizeof(outRight));
+        SynthVec a = (l3 - l0) * 0.5f + (l1 - l2) * 1.5f;
+        SynthVec b = l0 - l1 * 2.5f + l2 * 2.0f - l3 * 0.5f;
+        SynthVec c = (l2 - l0) * 0.5f;
+        outLeft += (((a * frac + b) * frac + c) * frac + l1) * g;
+        a = (r3 - r0) * 0.5f + (r1 - r2) * 1.5f;
+        b = r0 - r1 * 2.5f + r2 * 2.0f - r3 * 0.5f;
+        c = (r2 - r0) * 0.5f;
+        outRight += (((a * frac + b) * frac + c) * frac + r1) * g;
+        memcpy(&left[f], &outLeft, sizeof(outLeft));
+        memcpy(&right[f], &outRight, sizeof(outRight));
+    }
+}
+
+static void resampleVoiceBaseline(const float* sourceLeft, const float* sourceRight, double offset, double step,
+                                  const float* gain, int frames, float* left, float* right) {
+    resampleVoice(sourceLeft, sourceRight, offset, step, gain, frames, left, right);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx"))) static void resampleVoiceAvx(const float* sourceLeft, const float* sourceRight, double offset, double step,
+                                                            const float* gain, int frames, float* left, float* right) {
+    resampleVoice(sourceLeft, sourceRight, offset, step, gain, frames, left, right);
+}
+#endif
+
+// Move a voice past frames it has rendered, freeing it at the end of its
+// sample or release, and tell the prefetch thread where it now reads from
+static void advanceVoice(Sampler* sampler, int index, int frames) {
+    SamplerVoice* voice = &sampler->voices[index];
+    voice->position += frames * voice->step;
+    if (voice->position >= sampler->samples[voice->sample].frames || voice->level < SILENCE) {
+        freeVoice(sampler, index);
+        return;
+    }
+    uint64_t needed = voice->position >= 1 ? (uint64_t)voice->position - 1 : 0;
+    atomic_store_explicit(&sampler->streams[index].position, (uint64_t)voice->generation << 32 | needed, memory_order_release);
+}
+
+// Mix one voice's next frames into left and right. Source frames come from
+// the decoded attack, then the stream; frames the stream has not reached
+// yet play as silence rather than wait.
+static void renderVoice(Sampler* sampler, int index, int frames, float* left, float* right) {
+    SamplerVoice* voice = &sampler->voices[index];
+    VoiceStream* stream = &sampler->streams[index];
+    const SampleFile* sample = &sampler->samples[voice->sample];
+    int lanes = (frames + SYNTH_LANES - 1) / SYNTH_LANES * SYNTH_LANES;
+
+    int64_t first = (int64_t)voice->position - 1;
+    int span = (int)(voice->position + (lanes - 1) * voice->step) - (int)first + 3;
+    uint64_t filled = atomic_load_explicit(&stream->filled, memory_order_acquire);
+    uint32_t streamed = (uint32_t)(filled >> 32) == voice->generation ? (uint32_t)filled : sample->attackFrames;
+
+    float sourceLeft[SCRATCH_FRAMES];
+    float sourceRight[SCRATCH_FRAMES];
+    bool starved = false;
+    for (int i = 0; i < span; i++) {
+        int64_t frame = first + i;
+        const float* source = NULL;
+        if (frame < 0 || frame >= sample->frames) source = NULL;
+        else if (frame < sample->attackFrames) source = &sample->attack[frame * 2];
+        else if (frame < streamed) source = &stream->ring[(frame & (SAMPLER_STREAM_FRAMES - 1)) * 2];
+        else starved = true;
+        sourceLeft[i] = source ? source[0] : 0.0f;
+        sourceRight[i] = source ? source[1] : 0.0f;
+    }
+    if (starved) atomic_fetch_add_explicit(&sampler->starved, 1, memory_order_relaxed);
+
+    float gain[SYNTH_BLOCK];
+    for (int f = 0; f < lanes; f++) {
+        if (voice->releasing && f < frames) voice->level *= voice->releaseFactor;
+        gain[f] = f < frames ? voice->level * voice->gain : 0.0f;
+    }
+    double offset = voice->position - (double)first;
+#if defined(__x86_64__) || defined(__i386__)
+    if (sampler->wideVectors) resampleVoiceAvx(sourceLeft, sourceRight, offset, voice->step, gain, lanes, left, right);
+    else resampleVoiceBaseline(sourceLeft, sourceRight, offset, voice->step, gain, lanes, left, right);
+#else
+    resampleVoiceBaseline(sourceLeft, sourceRight, offset, voice->step, gain, lanes, left, right);
+#endif
+    advanceVoice(sampler, index, frames);
+}
+
+// Soft clip that is transparent at normal levels and saturates past full scale
+static float softClip(float x) {
+    if (x > 3.0f) return 1.0f;
+    if (x < -3.0f) return -1.0f;
+    return x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+}
+
+// Render interleaved stereo frames, overwriting output. Never allocates or
+// blocks. A NULL output fast-forwards the voices without producing audio.
+void samplerRender(Sampler* sampler, float* output, int frames) {
+    float left[SYNTH_BLOCK];
+    float right[SYNTH_BLOCK];
+    while (frames > 0) {
+        int count = frames < SYNTH_BLOCK ? frames : SYNTH_BLOCK;
+        if (output) {
+            memset(left, 0, sizeof(left));
+            memset(right, 0, sizeof(right));
+        }
+        for (int v = 0; v < SAMPLER_MAX_VOICES; v++) {
+            if (!sampler->voices[v].active) continue;
+            if (output) {
+                renderVoice(sampler, v, count, left, right);
+            } else {
+                SamplerVoice* voice = &sampler->voices[v];
+                if (voice->releasing) voice->level *= powf(voice->releaseFactor, (float)count);
+                advanceVoice(sampler, v, count);
+            }
+        }
+        if (output) {
+            for (int f = 0; f < count; f++) {
+                output[f * 2] = softClip(left[f]);
+                output[f * 2 + 1] = softClip(right[f]);
+            }
+            output += count * 2;
+        }
+        sampler->frame += count;
+        frames -= count;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SAMPLER_MAX_VOICES 64
+#define SAMPLER_STREAM_FRAMES 16384         // Tail frames buffered ahead per voice (power of two)
+#define SAMPLER_ATTACK_SECONDS 0.5f         // Start of each sample kept decoded in memory
+#define SAMPLER_DEFAULT_BUDGET_MB 256       // Decoded attacks plus stream buffers
+
+typedef struct Sampler Sampler;
+
+Sampler* createSampler(const char* sfzPath, float sampleRate, size_t memoryBudget);
+void destroySampler(Sampler* sampler);
+void samplerNoteOn(Sampler* sampler, int note, int velocity);
+void samplerNoteOff(Sampler* sampler, int note);
+void samplerAllNotesOff(Sampler* sampler);
+void samplerRender(Sampler* sampler, float* output, int frames);
+int samplerActiveVoices(const Sampler* sampler);
+
+#endif
@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "search.h"
+
+#define SPACE_SYMBOL 36
+#define OTHER_SYMBOL 37
+#define MAX_QUERY_TRIGRAMS 250  // Keeps per-song hit counts within a byte
+#define SCORE_LEVELS 256
+
+// Score bands, best first. Within the trigram band the score grows with overlap.
+#define SCORE_PREFIX 250        // Query starts the song name
+#define SCORE_WORD 200          // Query starts a word
+#define SCORE_SUBSTRING 150     // Query appears inside a word
+#define SCORE_FUZZY 20          // Enough trigrams match to forgive a typo
+
+static int symbolOf(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= '0' && c <= '9') return 26 + c - '0';
+    if (c == ' ') return SPACE_SYMBOL;
+    return OTHER_SYMBOL;
+}
+
+static int trigramOf(const char* text) {
+    return (symbolOf(text[0]) * SEARCH_SYMBOLS + symbolOf(text[1])) * SEARCH_SYMBOLS + symbolOf(text[2]);
+}
+
+// Latin-1 letters (U+00C0 to U+00FF, UTF-8 "\xc3" + 0x80..0xbf) folded to ASCII
+static const char latinFold[] = "aaaaaaaceeeeiiiidnooooo ouuuuyts" "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+// Lowercase ASCII letters and digits, fold accented Latin letters, turn
+// punctuation and whitespace into single spaces and keep other UTF-8 bytes
+// as they are. Returns the output length.
+static int normalize(const char* input, char* output, int capacity, bool trimEnd) {
+    int length = 0;
+    for (const unsigned char* c = (const unsigned char*)input; *c && length < capacity - 1; c++) {
+        unsigned char out = *c;
+        if (out >= 'A' && out <= 'Z') out = out - 'A' + 'a';
+        else if (out == 0xc3 && c[1] >= 0x80 && c[1] <= 0xbf) out = (unsigned char)latinFold[*++c - 0x80];
+        else if (out < 128 && !((out >= 'a' && out <= 'z') || (out >= '0' && out <= '9'))) out = ' ';
+        if (out == ' ' && (length == 0 || output[length - 1] == ' ')) continue;
+        output[length++] = (char)out;
+    }
+    if (trimEnd && length > 0 && output[length - 1] == ' ') length--;
+    output[length] = '\0';
+    return length;
+}
+
+// Build the index: each song becomes " name bpm " and every distinct trigram
+// of it is posted once, in song order, in a flat CSR table
+void buildSongSearch(SongSearch* search, const SavedSong* songs, int songCount) {
+    freeSongSearch(search);
+    search->songCount = songCount;
+
+    size_t textSize = 1;
+    for (int i = 0; i < songCount; i++) textSize += strlen(songs[i].songName) + 16;
+    int slots = songCount ? songCount : 1;
+    search->text = malloc(textSize);
+    search->textStart = malloc(sizeof(int) * slots);
+    search->symbolMask = calloc(slots, sizeof(uint64_t));
+    search->wordStartMask = calloc(slots, sizeof(uint64_t));
+    search->postingStart = calloc(SEARCH_TRIGRAMS + 1, sizeof(int));
+    search->hits = calloc(slots, 1);
+    search->scores = calloc(slots, 1);
+    search->firstLetter = malloc(slots);
+    search->touched = malloc(sizeof(int) * slots);
+    search->results = malloc(sizeof(int) * slots);
+    search->scratch = malloc(sizeof(int) * slots);
+    int* lastSong = malloc(sizeof(int) * SEARCH_TRIGRAMS);
+    if (!search->text || !search->textStart || !search->symbolMask || !search->wordStartMask ||
+        !search->firstLetter || !search->postingStart || !search->hits || !search->scores || !search->touched ||
+        !search->results || !search->scratch || !lastSong) {
+        free(lastSong);
+        freeSongSearch(search);
+        return;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < songCount; i++) {
+        char* doc = search->text + offset;
+        size_t room = strlen(songs[i].songName) + 16;
+        doc[0] = ' ';
+        int length = 1 + normalize(songs[i].songName, doc + 1, (int)room - 1, true);
+        if (songs[i].bpm > 0) length += snprintf(doc + length, room - length, " %d", songs[i].bpm);
+        doc[length++] = ' ';
+        doc[length] = '\0';
+        search->textStart[i] = (int)offset;
+        search->firstLetter[i] = doc[1];
+        offset += length + 1;
+
+        for (int c = 0; c < length; c++) {
+            uint64_t bit = 1ull << symbolOf((unsigned char)doc[c]);
+            search->symbolMask[i] |= bit;
+            if (c > 0 && doc[c - 1] == ' ') search->wordStartMask[i] |= bit;
+        }
+    }
+    search->text[offset] = '\0';
+
+    // Count, then fill, skipping trigrams a song repeats
+    for (int pass = 0; pass < 2; pass++) {
+        memset(lastSong, 0xff, sizeof(int) * SEARCH_TRIGRAMS);
+        for (int i = 0; i < songCount; i++) {
+            const char* doc = search->text + search->textStart[i];
+            for (int c = 0; doc[c + 1] && doc[c + 2]; c++) {
+                int trigram = trigramOf(doc + c);
+                if (lastSong[trigram] == i) continue;
+                lastSong[trigram] = i;
+                if (pass == 0) search->postingStart[trigram + 1]++;
+                else search->postings[search->touched[trigram]++] = i;
+            }
+        }
+        if (pass == 0) {
+            for (int t = 0; t < SEARCH_TRIGRAMS; t++) search->postingStart[t + 1] += search->postingStart[t];
+            int total = search->postingStart[SEARCH_TRIGRAMS];
+            search->postings = malloc(sizeof(int) * (total ? total : 1));
+            // touched doubles as the per-trigram fill cursor while building
+            free(search->touched);
+            search->touched = malloc(sizeof(int) * (SEARCH_TRIGRAMS > slots ? SEARCH_TRIGRAMS : slots));
+            if (!search->postings || !search->touched) {
+                free(lastSong);
+                freeSongSearch(search);
+                return;
+            }
+            memcpy(search->touched, search->postingStart, sizeof(int) * SEARCH_TRIGRAMS);
+        }
+    }
+    free(lastSong);
+
+    for (int i = 0; i < songCount; i++) search->results[i] = i;
+    search->resultCount = songCount;
+    search->queryLength = 0;
+    search->query[0] = '\0';
+}
+
+// Query pieces shared by every candidate in a run
+typedef struct {
+    const char* text;           // Normalized query
+    int length;
+    char padded[SEARCH_QUERY_MAX + 1]; // " " + query, source of the trigrams
+    int trigrams[MAX_QUERY_TRIGRAMS]; // Offsets into padded of distinct trigrams
+    int trigramCount;
+    int needed;                 // Trigram hits required for a fuzzy match
+    int candidate;              // Trigram hits worth scoring at all
+    uint64_t mask;              // Symbols the query contains
+} Query;
+
+static void prepareQuery(Query* query, const char* text, int length) {
+    query->text = text;
+    query->length = length;
+    query->padded[0] = ' ';
+    memcpy(query->padded + 1, text, length + 1);
+    query->trigramCount = 0;
+    query->mask = 0;
+    for (int c = 0; c < length; c++) query->mask |= 1ull << symbolOf((unsigned char)text[c]);
+    for (int c = 0; c + 2 <= length && query->trigramCount < MAX_QUERY_TRIGRAMS; c++) {
+        bool repeated = false;
+        for (int j = 0; j < query->trigramCount && !repeated; j++) {
+            repeated = memcmp(query->padded + query->trigrams[j], query->padded + c, 3) == 0;
+        }
+        if (!repeated) query->trigrams[query->trigramCount++] = c;
+    }
+    // Short queries must match exactly; longer ones may miss a third of
+    // their trigrams. A substring misses at most the leading " ab" trigram.
+    int count = query->trigramCount;
+    query->needed = count < 3 ? count : count - (count + 1) / 3;
+    query->candidate = query->needed < count - 1 ? query->needed : count - 1;
+    if (query->candidate < 1) query->candidate = 1;
+}
+
+// Rank one song against the query; 0 means no match. hits is how many of
+// the query's trigrams the song contains.
+static int scoreSong(const SongSearch* search, int song, const Query* query, int hits) {
+    const char* doc = search->text + search->textStart[song];
+    uint64_t mask = search->symbolMask[song];
+
+    // A substring contains every query trigram but perhaps the leading " ab"
+    if ((mask & query->mask) == query->mask && hits >= query->trigramCount - 1) {
+        const char* found = strstr(doc, query->text);
+        if (found) {
+            if (found == doc + 1) return SCORE_PREFIX;
+            if (found[-1] == ' ') return SCORE_WORD;
+            return SCORE_SUBSTRING;
+        }
+    }
+    if (query->length < 3 || query->trigramCount == 0 || hits < query->needed) return 0;
+    return SCORE_FUZZY + (SCORE_SUBSTRING - SCORE_FUZZY - 1) * hits / query->trigramCount;
+}
+
+static int compareInts(const void* a, const void* b) {
+    int left = *(const int*)a;
+    int right = *(const int*)b;
+    return (left > right) - (left < right);
+}
+
+// Order scored candidates best first, ties in library order. Scores are
+// bytes, so this is a counting sort rather than a comparison sort.
+static void rankCandidates(SongSearch* search, int candidateCount) {
+    int* candidates = search->scratch;
+    if (candidateCount > search->songCount / 8) {
+        candidateCount = 0;
+        for (int i = 0; i < search->songCount; i++) {
+            candidates[candidateCount] = i;
+            candidateCount += search->scores[i] != 0;
+        }
+    } else if (candidateCount > 1) {
+        qsort(candidates, candidateCount, sizeof(int), compareInts);
+    }
+
+    int start[SCORE_LEVELS + 1] = { 0 };
+    for (int i = 0; i < candidateCount; i++) start[SCORE_LEVELS - search->scores[candidates[i]]]++;
+    for (int level = 0, sum = 0; level <= SCORE_LEVELS; level++) {
+        int count = start[level];
+        start[level] = sum;
+        sum += count;
+    }
+    for (int i = 0; i < candidateCount; i++) {
+        int song = candidates[i];
+        search->results[start[SCORE_LEVELS - search->scores[song]]++] = song;
+        search->scores[song] = 0;
+    }
+    search->resultCount = candidateCount;
+}
+
+static void clearHits(SongSearch* search) {
+    for (int i = 0; i < search->touchedCount; i++) search->hits[search->touched[i]] = 0;
+    search->touchedCount = 0;
+    search->countedTrigrams = 0;
+}
+
+// Score one candidate and queue it for ranking
+static int addCandidate(SongSearch* search, int song, const Query* query, int hits, int candidateCount) {
+    int score = scoreSong(search, song, query, hits);
+    if (!score) return candidateCount;
+    search->scores[song] = (uint8_t)score;
+    search->scratch[candidateCount] = song;
+    return candidateCount + 1;
+}
+
+// Filter and rank songs for a query. Trigram hit counts survive between
+// runs, so typing one more letter only walks the postings of the one new
+// trigram. Two-letter queries gather every trigram ending in them and
+// single letters are answered from the symbol masks.
+int runSongSearch(SongSearch* search, const char* rawQuery) {
+    if (!search->results) return 0;
+    char text[SEARCH_QUERY_MAX];
+    int length = normalize(rawQuery, text, sizeof(text), false);
+    if (length == 1 && text[0] == ' ') length = 0;
+
+    bool extends = search->queryLength > 0 && length >= search->queryLength &&
+                   memcmp(text, search->query, search->queryLength) == 0;
+    if (extends && length == search->queryLength) return search->resultCount;
+    if (!extends || length < 3) clearHits(search);
+    memcpy(search->query, text, length + 1);
+    search->queryLength = length;
+
+    if (length == 0) {
+        for (int i = 0; i < search->songCount; i++) search->results[i] = i;
+        search->resultCount = search->songCount;
+        return search->resultCount;
+    }
+
+    Query query;
+    prepareQuery(&query, search->query, length);
+    int candidateCount = 0;
+    if (length >= 3) {
+        for (int t = search->countedTrigrams; t < query.trigramCount; t++) {
+            int trigram = trigramOf(query.padded + query.trigrams[t]);
+            for (int p = search->postingStart[trigram]; p < search->postingStart[trigram + 1]; p++) {
+                int song = search->postings[p];
+                if (search->hits[song]++ == 0) search->touched[search->touchedCount++] = song;
+            }
+        }
+        search->countedTrigrams = query.trigramCount;
+        for (int i = 0; i < search->touchedCount; i++) {
+            int song = search->touched[i];
+            if (search->hits[song] >= query.candidate) {
+                candidateCount = addCandidate(search, song, &query, search->hits[song], candidateCount);
+            }
+        }
+    } else if (length == 2) {
+        // Every occurrence of "ab" is preceded by something, if only the leading space
+        int suffix = symbolOf((unsigned char)text[0]) * SEARCH_SYMBOLS + symbolOf((unsigned char)text[1]);
+        for (int symbol = 0; symbol < SEARCH_SYMBOLS; symbol++) {
+            int trigram = symbol * SEARCH_SYMBOLS * SEARCH_SYMBOLS + suffix;
+            for (int p = search->postingStart[trigram]; p < search->postingStart[trigram + 1]; p++) {
+                int song = search->postings[p];
+                if (search->hits[song]++ == 0) search->touched[search->touchedCount++] = song;
+            }
+        }
+        for (int i = 0; i < search->touchedCount; i++) {
+            candidateCount = addCandidate(search, search->touched[i], &query, query.trigramCount, candidateCount);
+        }
+        clearHits(search);
+    } else if (symbolOf((unsigned char)text[0]) != OTHER_SYMBOL) {
+        // Single letter: the masks answer everything, without a branch per song
+        static const uint8_t levels[4] = { 0, SCORE_SUBSTRING, SCORE_WORD, SCORE_PREFIX };
+        for (int song = 0; song < search->songCount; song++) {
+            int level = ((search->symbolMask[song] & query.mask) != 0) + ((search->wordStartMask[song] & query.mask) != 0) +
+                        (search->firstLetter[song] == text[0]);
+            search->scores[song] = levels[level];
+        }
+        candidateCount = search->songCount; // Makes rankCandidates collect from scores
+    } else {
+        for (int song = 0; song < search->songCount; song++) {
+            if ((search->symbolMask[song] & query.mask) != query.mask) continue;
+            candidateCount = addCandidate(search, song, &query, query.trigramCount, candidateCount);
+        }
+    }
+    rankCandidates(search, candidateCount);
+    return search->resultCount;
+}
+
+void freeSongSearch(SongSearch* search) {
+    free(search->text);
+    free(search->textStart);
+    free(search->symbolMask);
+    free(search->wordStartMask);
+    free(search->firstLetter);
+    free(search->postingStart);
+    free(search->postings);
+    free(search->hits);
+    free(search->scores);
+    free(search->touched);
+    free(search->results);
+    free(search->scratch);
+    memset(search, 0, sizeof(*search));
+}
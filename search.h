@@ -0,0 +1,38 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include "library.h"
+
+#define SEARCH_SYMBOLS 38       // a-z, 0-9, space, anything else
+#define SEARCH_TRIGRAMS (SEARCH_SYMBOLS * SEARCH_SYMBOLS * SEARCH_SYMBOLS)
+#define SEARCH_QUERY_MAX 256
+
+// Fuzzy search index over song names and BPMs
+typedef struct {
+    int songCount;              // Songs indexed
+    char* text;                 // Normalized " name bpm " of every song, NUL separated
+    int* textStart;             // Offset of each song's text
+    uint64_t* symbolMask;       // Per song: bit per symbol present
+    uint64_t* wordStartMask;    // Per song: bit per symbol that starts a word
+    char* firstLetter;          // Per song: first character of the normalized name
+    int* postingStart;          // SEARCH_TRIGRAMS + 1 offsets into postings
+    int* postings;              // Song ids containing each trigram, ascending
+    uint8_t* hits;              // Per song count of query trigrams it contains
+    uint8_t* scores;            // Per song score (query scratch)
+    int* touched;               // Songs with nonzero hits
+    int touchedCount;
+
+    char query[SEARCH_QUERY_MAX]; // Normalized query of the last run
+    int queryLength;
+    int countedTrigrams;        // Distinct query trigrams already added to hits
+    int* results;               // Matching song indices, best first
+    int resultCount;
+    int* scratch;               // Candidate list of the run in progress
+} SongSearch;
+
+void buildSongSearch(SongSearch* search, const SavedSong* songs, int songCount);
+int runSongSearch(SongSearch* search, const char* query);
+void freeSongSearch(SongSearch* search);
+
+#endif
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sheet.h"
+
+// MIDI note for each ASCII key, -1 for keys that are not notes
+static const signed char keyNotes[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 37, -1, 40, 42, 44, 47, -1, 51, 52, 49, -1, -1, -1, -1, -1,
+    52, 36, 38, 40, 41, 43, 45, 47, 48, 50, -1, -1, -1, -1, -1, -1,
+    39, 71, 94, 90, 75, 58, 76, 78, 80, 66, 82, 83, 85, 97, 95, 68,
+    70, 54, 59, 73, 61, 64, 92, 56, 88, 63, 87, -1, -1, -1, 46, -1,
+    -1, 71, 93, 89, 74, 57, 76, 77, 79, 65, 81, 83, 84, 96, 95, 67,
+    69, 53, 59, 72, 60, 64, 91, 55, 88, 62, 86, -1, -1, -1, -1, -1,
+};
+
+// Map a typed key to its MIDI note, or -1
+int sheetKeyToNote(int key) {
+    return (key >= 0 && key < 128) ? keyNotes[key] : -1;
+}
+
+// Grow an event array to hold at least needed entries
+static bool reserveEvents(NoteEvent** events, int* capacity, int needed) {
+    if (needed <= *capacity) return true;
+    int newCapacity = *capacity ? *capacity : 256;
+    while (newCapacity < needed) newCapacity *= 2;
+    NoteEvent* grown = realloc(*events, sizeof(NoteEvent) * newCapacity);
+    if (!grown) return false;
+    *events = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+static bool reserveLines(Sheet* sheet, int needed) {
+    if (needed <= sheet->lineCapacity) return true;
+    int newCapacity = sheet->lineCapacity ? sheet->lineCapacity : 64;
+    while (newCapacity < needed) newCapacity *= 2;
+    SheetLine* grown = realloc(sheet->lines, sizeof(SheetLine) * newCapacity);
+    if (!grown) return false;
+    sheet->lines = grown;
+    sheet->lineCapacity = newCapacity;
+    return true;
+}
+
+static void emitNote(NoteEvent* event, int note, uint32_t tick, uint32_t duration) {
+    event->tick = tick;
+    event->duration = duration;
+    event->note = (uint8_t)note;
+    event->velocity = SHEET_VELOCITY;
+    event->channel = 0;
+    event->track = 0;
+}
+
+// Tokenize one line into sheet->scratch starting at *count. The caller reserves
+// room for one event per character. Returns the line length in ticks.
+static uint32_t tokenizeLine(Sheet* sheet, const char* line, int length, uint32_t startTick, int* count) {
+    NoteEvent* out = sheet->scratch;
+    uint32_t tick = startTick;
+    int stepFirst = *count; // Notes of the last sounding step, extended by rests
+
+    for (int i = 0; i < length; i++) {
+        int c = (unsigned char)line[i];
+        int restSteps = (c == ' ') ? 1 : (c == '|') ? 2 : 0;
+
+        if (restSteps) {
+            for (int n = stepFirst; n < *count; n++) out[n].duration += restSteps * SHEET_PPQ;
+            tick += restSteps * SHEET_PPQ;
+        } else if (c == '[') {
+            int close = i + 1;
+            int notes = 0;
+            bool arpeggio = false;
+            while (close < length && line[close] != ']') {
+                if (sheetKeyToNote((unsigned char)line[close]) >= 0) notes++;
+                else if (line[close] == ' ' && notes > 0) arpeggio = true;
+                close++;
+            }
+            if (notes > 0) {
+                uint32_t spacing = 0;
+                if (arpeggio) spacing = (notes > 8) ? SHEET_PPQ / notes : SHEET_PPQ / 8;
+                stepFirst = *count;
+                int index = 0;
+                for (int j = i + 1; j < close; j++) {
+                    int note = sheetKeyToNote((unsigned char)line[j]);
+                    if (note < 0) continue;
+                    uint32_t offset = spacing * index++;
+                    emitNote(&out[(*count)++], note, tick + offset, SHEET_PPQ - offset);
+                }
+                tick += SHEET_PPQ;
+            }
+            i = close; // Skip past ']' (or to the end of an unterminated chord)
+        } else {
+            int note = sheetKeyToNote(c);
+            if (note >= 0) {
+                stepFirst = *count;
+                emitNote(&out[(*count)++], note, tick, SHEET_PPQ);
+                tick += SHEET_PPQ;
+            }
+        }
+    }
+    return tick - startTick;
+}
+
+// Index of the line containing text offset pos (last line starting at or before it)
+static int findLine(const Sheet* sheet, int pos) {
+    int low = 0;
+    int high = sheet->lineCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (sheet->lines[mid].start <= pos) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+// Recompile the whole sheet
+void sheetCompile(Sheet* sheet, const char* text, int length) {
+    if (!reserveLines(sheet, 1)) return;
+    memset(&sheet->lines[0], 0, sizeof(SheetLine));
+    sheet->lineCount = 1;
+    sheet->timeline.eventCount = 0;
+    sheet->timeline.ppq = SHEET_PPQ;
+    sheet->timeline.endTick = 0;
+    sheetUpdate(sheet, text, length, 0, 0, length);
+}
+
+// Apply an edit that replaced old text [editStart, oldEditEnd) with new text
+// [editStart, newEditEnd). Only the lines touching the edit are re-tokenized;
+// the rest of the timeline is spliced and shifted in place.
+void sheetUpdate(Sheet* sheet, const char* text, int length, int editStart, int oldEditEnd, int newEditEnd) {
+    if (sheet->lineCount == 0) {
+        sheetCompile(sheet, text, length);
+        return;
+    }
+
+    int first = findLine(sheet, editStart);
+    int last = findLine(sheet, oldEditEnd);
+    int charDelta = newEditEnd - oldEditEnd;
+
+    int oldFirstEvent = sheet->lines[first].firstEvent;
+    int oldEventEnd = sheet->lines[last].firstEvent + sheet->lines[last].eventCount;
+    uint32_t firstTick = sheet->lines[first].startTick;
+    uint32_t oldTickEnd = sheet->lines[last].startTick + sheet->lines[last].ticks;
+
+    // New text to re-tokenize: from the first touched line to the end of the line holding newEditEnd
+    int scanStart = sheet->lines[first].start;
+    int scanEnd = newEditEnd < length ? newEditEnd : length;
+    while (scanEnd < length && text[scanEnd] != '\n') scanEnd++;
+
+    int newLineCount = 1;
+    for (int i = scanStart; i < scanEnd; i++) {
+        if (text[i] == '\n') newLineCount++;
+    }
+
+    int oldLineCount = last - first + 1;
+    int tailLines = sheet->lineCount - last - 1;
+    if (!reserveLines(sheet, sheet->lineCount - oldLineCount + newLineCount)) return;
+    memmove(&sheet->lines[first + newLineCount], &sheet->lines[last + 1], sizeof(SheetLine) * tailLines);
+    sheet->lineCount += newLineCount - oldLineCount;
+
+    // Tokenize the replacement lines into scratch
+    int scratchCount = 0;
+    uint32_t tick = firstTick;
+    int pos = scanStart;
+    for (int n = 0; n < newLineCount; n++) {
+        int lineEnd = pos;
+        while (lineEnd < scanEnd && text[lineEnd] != '\n') lineEnd++;
+        if (!reserveEvents(&sheet->scratch, &sheet->scratchCapacity, scratchCount + (lineEnd - pos))) return;
+
+        SheetLine* line = &sheet->lines[first + n];
+        line->start = pos;
+        line->length = lineEnd - pos;
+        line->firstEvent = oldFirstEvent + scratchCount;
+        line->startTick = tick;
+        int before = scratchCount;
+        line->ticks = tokenizeLine(sheet, text + pos, lineEnd - pos, tick, &scratchCount);
+        line->eventCount = scratchCount - before;
+        tick += line->ticks;
+        pos = lineEnd + 1;
+    }
+
+    // Splice the new events over the old ones
+    Timeline* timeline = &sheet->timeline;
+    int eventDelta = scratchCount - (oldEventEnd - oldFirstEvent);
+    int tailEvents = timeline->eventCount - oldEventEnd;
+    if (!reserveEvents(&timeline->events, &sheet->eventCapacity, timeline->eventCount + eventDelta)) return;
+    if (tailEvents > 0) memmove(&timeline->events[oldEventEnd + eventDelta], &timeline->events[oldEventEnd], sizeof(NoteEvent) * tailEvents);
+    if (scratchCount > 0) memcpy(&timeline->events[oldFirstEvent], sheet->scratch, sizeof(NoteEvent) * scratchCount);
+    timeline->eventCount += eventDelta;
+
+    // Shift everything after the edit in text, event index and time
+    int64_t tickDelta = (int64_t)tick - (int64_t)oldTickEnd;
+    if (tickDelta != 0) {
+        for (int i = oldFirstEvent + scratchCount; i < timeline->eventCount; i++) {
+            timeline->events[i].tick = (uint32_t)(timeline->events[i].tick + tickDelta);
+        }
+    }
+    for (int i = first + newLineCount; i < sheet->lineCount; i++) {
+        SheetLine* line = &sheet->lines[i];
+        line->start += charDelta;
+        line->firstEvent += eventDelta;
+        line->startTick = (uint32_t)(line->startTick + tickDelta);
+    }
+
+    SheetLine* lastLine = &sheet->lines[sheet->lineCount - 1];
+    timeline->ppq = SHEET_PPQ;
+    timeline->endTick = lastLine->startTick + lastLine->ticks;
+}
+
+// Free all memory owned by a sheet
+void freeSheet(Sheet* sheet) {
+    free(sheet->lines);
+    free(sheet->scratch);
+    freeTimeline(&sheet->timeline);
+    memset(sheet, 0, sizeof(*sheet));
+}
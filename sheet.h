@@ -0,0 +1,44 @@
+#ifndef SHEET_H
+#define SHEET_H
+
+#include "timeline.h"
+
+// Virtual-piano letter notation:
+//   1234567890qwertyuiopasdfghjklzxcvbnm   white keys C2..C7
+//   uppercase letters / !@$%^*(            sharp of the unshifted key
+//   [abc]                                  chord, one step
+//   [a b c]                                quick arpeggio within one step
+//   space                                  one step rest
+//   |                                      two step rest
+// Every note or chord takes one step (one beat at the song bpm) and rings
+// through the rests that follow it on the same line.
+#define SHEET_PPQ 96            // Ticks per step
+#define SHEET_VELOCITY 96       // Velocity given to every sheet note
+
+// One line of sheet text and its slice of the compiled timeline
+typedef struct {
+    int start;                  // Offset of the first character in the text
+    int length;                 // Length excluding the '\n'
+    int firstEvent;             // Index of the line's first event in the timeline
+    int eventCount;             // Number of events compiled from the line
+    uint32_t startTick;         // Tick at which the line starts
+    uint32_t ticks;             // Length of the line in ticks
+} SheetLine;
+
+// Compiled sheet, kept per line so edits only re-tokenize the lines they touch
+typedef struct {
+    SheetLine* lines;           // Line table in text order
+    int lineCount;              // Number of lines (always at least 1)
+    int lineCapacity;           // Allocated entries in lines
+    Timeline timeline;          // Packed events of all lines, sorted by tick
+    int eventCapacity;          // Allocated entries in timeline.events
+    NoteEvent* scratch;         // Reusable buffer for re-tokenized lines
+    int scratchCapacity;        // Allocated entries in scratch
+} Sheet;
+
+int sheetKeyToNote(int key);
+void sheetCompile(Sheet* sheet, const char* text, int length);
+void sheetUpdate(Sheet* sheet, const char* text, int length, int editStart, int oldEditEnd, int newEditEnd);
+void freeSheet(Sheet* sheet);
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "json.h"
+#include "midi.h"
+#include "sheet.h"
+#include "song.h"
+
+// Read a saved song without touching the window or GPU. Unknown members are
+// skipped, so files written by newer versions still load.
+bool loadSong(const char* path, Song* song) {
+    memset(song, 0, sizeof(*song));
+    MappedFile file;
+    if (!mapFile(path, &file)) return false;
+
+    JsonReader reader;
+    jsonReaderInit(&reader, (const char*)file.data, file.size);
+    char* midiFile = NULL;
+    char key[32];
+    if (jsonBeginObject(&reader)) {
+        while (jsonNextMember(&reader, key, sizeof(key))) {
+            char** target = strcmp(key, "songName") == 0 ? &song->name :
+                            strcmp(key, "songInfo") == 0 ? &song->sheet :
+                            strcmp(key, "midiFile") == 0 ? &midiFile : NULL;
+            if (target && jsonIsString(&reader)) {
+                free(*target);
+                *target = jsonReadString(&reader, target == &song->sheet ? &song->sheetLength : NULL);
+            } else if (strcmp(key, "BPM") == 0) {
+                // Written as a string, but accept a number too
+                double bpm = 0;
+                if (jsonIsString(&reader)) {
+                    char* text = jsonReadString(&reader, NULL);
+                    if (text) bpm = atoi(text);
+                    free(text);
+                } else {
+                    jsonReadNumber(&reader, &bpm);
+                }
+                song->bpm = (int)bpm;
+            } else {
+                jsonSkipValue(&reader);
+            }
+        }
+    }
+    bool malformed = reader.error;
+    unmapFile(&file);
+
+    if (midiFile && midiFile[0]) song->midiPath = siblingPath(path, midiFile);
+    free(midiFile);
+
+    if (malformed || !song->name || !song->sheet) {
+        TraceLog(LOG_WARNING, "SONG: %s is %s", path, malformed ? "not valid JSON" : "missing songName or songInfo");
+        freeSong(song);
+        return false;
+    }
+    return true;
+}
+
+// Write a song as JSON. The file is written beside the target and renamed
+// over it, so readers and the library watcher never see half a song.
+bool saveSong(const char* path, const Song* song) {
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "wb");
+    JsonWriter writer;
+    if (!jsonWriterInit(&writer, file)) {
+        jsonWriterClose(&writer);
+        if (file) fclose(file);
+        TraceLog(LOG_ERROR, "SONG: Failed to open %s for writing", temporary);
+        return false;
+    }
+
+    char bpm[16] = "";
+    if (song->bpm > 0) snprintf(bpm, sizeof(bpm), "%d", song->bpm);
+    jsonWriteBeginObject(&writer);
+    jsonWriteKey(&writer, "songName");
+    jsonWriteString(&writer, song->name, strlen(song->name));
+    jsonWriteKey(&writer, "BPM");
+    jsonWriteString(&writer, bpm, strlen(bpm));
+    if (song->midiPath) {
+        const char* midiFile = GetFileName(song->midiPath);
+        jsonWriteKey(&writer, "midiFile");
+        jsonWriteString(&writer, midiFile, strlen(midiFile));
+    }
+    jsonWriteKey(&writer, "songInfo");
+    jsonWriteString(&writer, song->sheet, song->sheetLength);
+    jsonWriteEndObject(&writer);
+    jsonWriteRaw(&writer, "\n", 1);
+
+    bool ok = jsonWriterClose(&writer);
+    if (fclose(file) != 0) ok = false;
+#ifdef _WIN32
+    if (ok) remove(path); // rename() does not replace on Windows
+#endif
+    if (!ok || rename(temporary, path) != 0) {
+        TraceLog(LOG_ERROR, "SONG: Failed to write %s", path);
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+// Compile the song's notes: its MIDI file if it has one, otherwise its sheet.
+// Fails, leaving the timeline empty, when there are no notes to play.
+bool loadSongTimeline(const Song* song, Timeline* timeline) {
+    memset(timeline, 0, sizeof(*timeline));
+    if (!song->midiPath || !loadMidiFile(song->midiPath, timeline)) {
+        Sheet sheet = { 0 };
+        sheetCompile(&sheet, song->sheet ? song->sheet : "", song->sheetLength);
+        *timeline = sheet.timeline;
+        memset(&sheet.timeline, 0, sizeof(sheet.timeline));
+        freeSheet(&sheet);
+    }
+    if (timeline->eventCount == 0) {
+        freeTimeline(timeline);
+        return false;
+    }
+    return true;
+}
+
+void freeSong(Song* song) {
+    free(song->name);
+    free(song->sheet);
+    free(song->midiPath);
+    memset(song, 0, sizeof(*song));
+}
@@ -0,0 +1,21 @@
+#ifndef SONG_H
+#define SONG_H
+
+#include <stdbool.h>
+#include "timeline.h"
+
+// A saved song as stored in noctivoxFiles/*.json
+typedef struct {
+    char* name;                 // songName
+    int bpm;                    // BPM (0 = play at the native tempo)
+    char* sheet;                // songInfo, unescaped
+    int sheetLength;            // Length of sheet in bytes
+    char* midiPath;             // midiFile resolved next to the JSON (NULL if none)
+} Song;
+
+bool loadSong(const char* path, Song* song);
+bool saveSong(const char* path, const Song* song);
+bool loadSongTimeline(const Song* song, Timeline* timeline);
+void freeSong(Song* song);
+
+#endif
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "midi.h"
+#include "songcache.h"
+
+#define CACHE_MAGIC "NVXC"
+#define CACHE_BYTE_ORDER 0x01020304u    // Read back swapped on a foreign-endian machine
+#define CACHE_FROM_SHEET 1u             // flags: the timeline is the sheet's and lines are stored
+
+// Fixed header at the start of a .nvx file. The sections follow in this
+// order, each 8-byte aligned: events, tempos, time signatures, sheet lines,
+// then the name, sheet and MIDI file name strings, each NUL-terminated.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    int64_t jsonSize;           // Size of the JSON the sidecar was compiled from
+    int64_t jsonModifiedTime;   // Its modification time in nanoseconds
+    uint64_t jsonHash;          // hashBytes of its contents
+    int64_t midiSize;           // Size of the MIDI file the song names (-1 if none or missing)
+    int64_t midiModifiedTime;   // Its modification time in nanoseconds
+    int32_t bpm;
+    int32_t ppq;
+    uint32_t endTick;
+    uint32_t eventCount;
+    uint32_t tempoCount;
+    uint32_t timeSignatureCount;
+    uint32_t lineCount;
+    uint32_t nameLength;
+    uint32_t sheetLength;
+    uint32_t midiFileLength;
+} CacheHeader;
+
+// Byte offsets of each section, computed from the header
+typedef struct {
+    uint64_t events;
+    uint64_t tempos;
+    uint64_t timeSignatures;
+    uint64_t lines;
+    uint64_t name;
+    uint64_t sheet;
+    uint64_t midiFile;
+    uint64_t end;
+} CacheLayout;
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static CacheLayout layoutCache(const CacheHeader* header) {
+    CacheLayout layout;
+    uint64_t offset = sizeof(CacheHeader);
+    layout.events = offset = align8(offset);
+    offset += (uint64_t)header->eventCount * sizeof(NoteEvent);
+    layout.tempos = offset = align8(offset);
+    offset += (uint64_t)header->tempoCount * sizeof(TempoChange);
+    layout.timeSignatures = offset = align8(offset);
+    offset += (uint64_t)header->timeSignatureCount * sizeof(TimeSignature);
+    layout.lines = offset = align8(offset);
+    offset += (uint64_t)header->lineCount * sizeof(SheetLine);
+    layout.name = offset;
+    offset += (uint64_t)header->nameLength + 1;
+    layout.sheet = offset;
+    offset += (uint64_t)header->sheetLength + 1;
+    layout.midiFile = offset;
+    offset += (uint64_t)header->midiFileLength + 1;
+    layout.end = offset;
+    return layout;
+}
+
+// Content hash used to tell whether a touched JSON really changed
+static uint64_t hashBytes(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) hash = (hash ^ data[i]) * 0x100000001b3ull;
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 32);
+}
+
+static bool hashFile(const char* path, uint64_t* hash) {
+    MappedFile file;
+    if (!mapFile(path, &file)) return false;
+    *hash = hashBytes(file.data, file.size);
+    unmapFile(&file);
+    return true;
+}
+
+// "song.json" -> "song.nvx"
+static void cachePath(const char* jsonPath, char* path, size_t size) {
+    size_t length = strlen(jsonPath);
+    if (length > 5 && strcmp(jsonPath + length - 5, ".json") == 0) length -= 5;
+    snprintf(path, size, "%.*s%s", (int)length, jsonPath, SONG_CACHE_EXTENSION);
+}
+
+// Size and time of a song's MIDI file, -1 and 0 if it has none or it is missing
+static void midiFileInfo(const char* midiPath, int64_t* size, int64_t* modifiedTime) {
+    *size = -1;
+    *modifiedTime = 0;
+    if (midiPath && !getFileInfo(midiPath, size, modifiedTime)) {
+        *size = -1;
+        *modifiedTime = 0;
+    }
+}
+
+// Map the sidecar of a song. Fails if it is missing, from another version,
+// or stale: the JSON's size and time are checked first and its contents are
+// hashed only when the time alone changed. The MIDI file it names must have
+// the size and time it had when the sidecar was written.
+bool openCompiledSong(const char* jsonPath, CompiledSong* compiled) {
+    memset(compiled, 0, sizeof(*compiled));
+    char path[1024];
+    cachePath(jsonPath, path, sizeof(path));
+    if (!mapFile(path, &compiled->file)) return false;
+
+    CacheHeader header;
+    const unsigned char* data = compiled->file.data;
+    bool valid = compiled->file.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, CACHE_MAGIC, 4) == 0 && header.version == SONG_CACHE_VERSION &&
+                header.byteOrder == CACHE_BYTE_ORDER;
+    }
+
+    int64_t jsonSize = -1;
+    int64_t jsonModifiedTime = 0;
+    valid = valid && getFileInfo(jsonPath, &jsonSize, &jsonModifiedTime) && jsonSize == header.jsonSize;
+    if (valid && jsonModifiedTime != header.jsonModifiedTime) {
+        uint64_t hash;
+        valid = hashFile(jsonPath, &hash) && hash == header.jsonHash;
+    }
+
+    CacheLayout layout;
+    if (valid) {
+        layout = layoutCache(&header);
+        valid = layout.end <= compiled->file.size && data[layout.sheet - 1] == '\0' &&
+                data[layout.midiFile - 1] == '\0' && data[layout.end - 1] == '\0';
+    }
+    if (valid && data[layout.midiFile] != '\0') {
+        char* midiPath = siblingPath(jsonPath, (const char*)data + layout.midiFile);
+        int64_t midiSize;
+        int64_t midiModifiedTime;
+        midiFileInfo(midiPath, &midiSize, &midiModifiedTime);
+        valid = midiPath && midiSize == header.midiSize && midiModifiedTime == header.midiModifiedTime;
+        free(midiPath);
+    }
+    if (!valid) {
+        unmapFile(&compiled->file);
+        memset(compiled, 0, sizeof(*compiled));
+        return false;
+    }
+
+    // The timeline borrows the mapping; callers only ever read it
+    Timeline* timeline = &compiled->timeline;
+    timeline->events = (NoteEvent*)(data + layout.events);
+    timeline->eventCount = (int)header.eventCount;
+    timeline->tempos = (TempoChange*)(data + layout.tempos);
+    timeline->tempoCount = (int)header.tempoCount;
+    timeline->timeSignatures = (TimeSignature*)(data + layout.timeSignatures);
+    timeline->timeSignatureCount = (int)header.timeSignatureCount;
+    timeline->ppq = header.ppq;
+    timeline->endTick = header.endTick;
+    if (header.flags & CACHE_FROM_SHEET) {
+        compiled->lines = (const SheetLine*)(data + layout.lines);
+        compiled->lineCount = (int)header.lineCount;
+    }
+    compiled->name = (const char*)data + layout.name;
+    compiled->bpm = header.bpm;
+    compiled->sheet = (const char*)data + layout.sheet;
+    compiled->sheetLength = (int)header.sheetLength;
+    compiled->midiFile = (const char*)data + layout.midiFile;
+    return true;
+}
+
+void closeCompiledSong(CompiledSong* compiled) {
+    unmapFile(&compiled->file);
+    memset(compiled, 0, sizeof(*compiled));
+}
+
+static void writeSection(unsigned char* buffer, uint64_t offset, const void* data, size_t size) {
+    if (size) memcpy(buffer + offset, data, size);
+}
+
+// Write the sidecar of a song that was just read or saved. sheet is the
+// compiled song->sheet; the song's MIDI file, if it has one and it loads,
+// takes precedence just as in loadSongTimeline.
+bool writeCompiledSong(const char* jsonPath, const Song* song, const Sheet* sheet) {
+    CacheHeader header = { 0 };
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = SONG_CACHE_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER;
+    // Time before hash: a write racing with us leaves a mismatched time, never a wrong hash
+    if (!getFileInfo(jsonPath, &header.jsonSize, &header.jsonModifiedTime) || !hashFile(jsonPath, &header.jsonHash)) {
+        return false;
+    }
+
+    midiFileInfo(song->midiPath, &header.midiSize, &header.midiModifiedTime);
+    Timeline midi = { 0 };
+    bool fromMidi = song->midiPath && loadMidiFile(song->midiPath, &midi);
+    const Timeline* timeline = fromMidi ? &midi : &sheet->timeline;
+    const char* midiFile = song->midiPath ? GetFileName(song->midiPath) : "";
+    header.flags = fromMidi ? 0 : CACHE_FROM_SHEET;
+    header.bpm = song->bpm;
+    header.ppq = timeline->ppq;
+    header.endTick = timeline->endTick;
+    header.eventCount = (uint32_t)timeline->eventCount;
+    header.tempoCount = (uint32_t)timeline->tempoCount;
+    header.timeSignatureCount = (uint32_t)timeline->timeSignatureCount;
+    header.lineCount = fromMidi ? 0 : (uint32_t)sheet->lineCount;
+    header.nameLength = (uint32_t)strlen(song->name);
+    header.sheetLength = (uint32_t)song->sheetLength;
+    header.midiFileLength = (uint32_t)strlen(midiFile);
+
+    CacheLayout layout = layoutCache(&header);
+    unsigned char* buffer = calloc(1, (size_t)layout.end);
+    if (!buffer) {
+        freeTimeline(&midi);
+        return false;
+    }
+    memcpy(buffer, &header, sizeof(header));
+    writeSection(buffer, layout.events, timeline->events, sizeof(NoteEvent) * header.eventCount);
+    writeSection(buffer, layout.tempos, timeline->tempos, sizeof(TempoChange) * header.tempoCount);
+    writeSection(buffer, layout.timeSignatures, timeline->timeSignatures, sizeof(TimeSignature) * header.timeSignatureCount);
+    writeSection(buffer, layout.lines, sheet->lines, sizeof(SheetLine) * header.lineCount);
+    writeSection(buffer, layout.name, song->name, header.nameLength);
+    writeSection(buffer, layout.sheet, song->sheet, header.sheetLength);
+    writeSection(buffer, layout.midiFile, midiFile, header.midiFileLength);
+    freeTimeline(&midi);
+
+    char path[1024];
+    char temporary[1040];
+    cachePath(jsonPath, path, sizeof(path));
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "wb");
+    bool ok = file && fwrite(buffer, 1, (size_t)layout.end, file) == layout.end;
+    if (file && fclose(file) != 0) ok = false;
+    free(buffer);
+#ifdef _WIN32
+    if (ok) remove(path); // rename() does not replace on Windows
+#endif
+    if (!ok || rename(temporary, path) != 0) {
+        TraceLog(LOG_WARNING, "Failed to write compiled song: %s", path);
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+// Copy the cached metadata and sheet text into an owned Song
+bool compiledSongToSong(const CompiledSong* compiled, const char* jsonPath, Song* song) {
+    memset(song, 0, sizeof(*song));
+    song->name = strdup(compiled->name);
+    song->bpm = compiled->bpm;
+    song->sheet = malloc(compiled->sheetLength + 1);
+    if (song->sheet) memcpy(song->sheet, compiled->sheet, compiled->sheetLength + 1);
+    song->sheetLength = compiled->sheetLength;
+    if (compiled->midiFile[0]) song->midiPath = siblingPath(jsonPath, compiled->midiFile);
+    if (!song->name || !song->sheet || (compiled->midiFile[0] && !song->midiPath)) {
+        freeSong(song);
+        return false;
+    }
+    return true;
+}
+
+// Rebuild an editable Sheet from the cached line table and events, without
+// tokenizing. Fails if the cached notes came from MIDI rather than the sheet.
+bool compiledSongToSheet(const CompiledSong* compiled, Sheet* sheet) {
+    memset(sheet, 0, sizeof(*sheet));
+    if (!compiled->lines || compiled->lineCount < 1) return false;
+    int lineCount = compiled->lineCount;
+    int eventCount = compiled->timeline.eventCount;
+    sheet->lines = malloc(sizeof(SheetLine) * lineCount);
+    sheet->timeline.events = malloc(sizeof(NoteEvent) * (eventCount ? eventCount : 1));
+    if (!sheet->lines || !sheet->timeline.events) {
+        freeSheet(sheet);
+        return false;
+    }
+    memcpy(sheet->lines, compiled->lines, sizeof(SheetLine) * lineCount);
+    memcpy(sheet->timeline.events, compiled->timeline.events, sizeof(NoteEvent) * eventCount);
+    sheet->lineCount = lineCount;
+    sheet->lineCapacity = lineCount;
+    sheet->timeline.eventCount = eventCount;
+    sheet->eventCapacity = eventCount ? eventCount : 1;
+    sheet->timeline.ppq = compiled->timeline.ppq;
+    sheet->timeline.endTick = compiled->timeline.endTick;
+    return true;
+}
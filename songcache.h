@@ -0,0 +1,33 @@
+#ifndef SONGCACHE_H
+#define SONGCACHE_H
+
+#include <stdbool.h>
+#include "platform.h"
+#include "sheet.h"
+#include "song.h"
+#include "timeline.h"
+
+#define SONG_CACHE_EXTENSION ".nvx"     // Sidecar written beside each song's .json
+#define SONG_CACHE_VERSION 2
+
+// A song's compiled sidecar, mapped read-only. Every pointer points into the
+// mapping and stays valid until closeCompiledSong; never free them.
+typedef struct {
+    MappedFile file;
+    Timeline timeline;          // The notes playback uses (MIDI file or sheet)
+    const SheetLine* lines;     // Line table of the compiled sheet (NULL if the notes came from MIDI)
+    int lineCount;
+    const char* name;           // songName
+    int bpm;                    // BPM (0 = play at the native tempo)
+    const char* sheet;          // songInfo, unescaped
+    int sheetLength;
+    const char* midiFile;       // MIDI file name beside the JSON ("" if none)
+} CompiledSong;
+
+bool openCompiledSong(const char* jsonPath, CompiledSong* compiled);
+void closeCompiledSong(CompiledSong* compiled);
+bool writeCompiledSong(const char* jsonPath, const Song* song, const Sheet* sheet);
+bool compiledSongToSong(const CompiledSong* compiled, const char* jsonPath, Song* song);
+bool compiledSongToSheet(const CompiledSong* compiled, Sheet* sheet);
+
+#endif
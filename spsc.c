@@ -0,0 +1,47 @@
+#include <stdlib.h>
+#include <string.h>
+#include "spsc.h"
+
+// Allocate a queue; capacity is rounded up to a power of two
+bool initSpscQueue(SpscQueue* queue, uint32_t elementSize, uint32_t capacity) {
+    uint32_t size = 2;
+    while (size < capacity) size *= 2;
+    memset(queue, 0, sizeof(*queue));
+    queue->buffer = malloc((size_t)size * elementSize);
+    if (!queue->buffer) return false;
+    queue->elementSize = elementSize;
+    queue->mask = size - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    return true;
+}
+
+void freeSpscQueue(SpscQueue* queue) {
+    free(queue->buffer);
+    queue->buffer = NULL;
+}
+
+// Producer side: copy element in, fails when full
+bool spscPush(SpscQueue* queue, const void* element) {
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail > queue->mask) return false;
+    memcpy(queue->buffer + (size_t)(head & queue->mask) * queue->elementSize, element, queue->elementSize);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumer side: copy the oldest element out, fails when empty
+bool spscPop(SpscQueue* queue, void* element) {
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (head == tail) return false;
+    memcpy(element, queue->buffer + (size_t)(tail & queue->mask) * queue->elementSize, queue->elementSize);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Approximate number of queued elements (exact from either endpoint's thread)
+uint32_t spscCount(SpscQueue* queue) {
+    return atomic_load_explicit(&queue->head, memory_order_acquire) - atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
@@ -0,0 +1,24 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer ring of fixed-size elements
+typedef struct {
+    unsigned char* buffer;      // capacity * elementSize bytes
+    uint32_t elementSize;       // Size of one element in bytes
+    uint32_t mask;              // capacity - 1 (capacity is a power of two)
+    _Atomic uint32_t head;      // Next slot to write, owned by the producer
+    char padding[60];           // Keep head and tail on separate cache lines
+    _Atomic uint32_t tail;      // Next slot to read, owned by the consumer
+} SpscQueue;
+
+bool initSpscQueue(SpscQueue* queue, uint32_t elementSize, uint32_t capacity);
+void freeSpscQueue(SpscQueue* queue);
+bool spscPush(SpscQueue* queue, const void* element);
+bool spscPop(SpscQueue* queue, void* element);
+uint32_t spscCount(SpscQueue* queue);
+
+#endif
@@ -0,0 +1,303 @@
+#include <math.h>
+#include <string.h>
+#include "synth.h"
+
+#define TWO_PI 6.283185307179586
+#define INHARMONICITY 0.0004f           // String stiffness, stretches upper partials
+#define SILENCE 0.0001f                 // Envelope level at which a voice is freed
+#define ATTACK_PEAK 0.99f               // Envelope level that ends the attack
+
+static const float partialWeights[SYNTH_PARTIALS] = { 1.0f, 0.5f, 0.28f };
+
+// One-pole coefficient that covers ~63% of the distance in the given time
+static float envelopeRate(float seconds, float sampleRate) {
+    if (seconds < 0.0001f) seconds = 0.0001f;
+    return 1.0f - expf(-1.0f / (seconds * sampleRate));
+}
+
+static void setLane(SynthVec* vector, int lane, float value) {
+    (*vector)[lane] = value;
+}
+
+void initSynth(Synth* synth, float sampleRate) {
+    memset(synth, 0, sizeof(*synth));
+    synth->sampleRate = sampleRate;
+    synth->envelope = (SynthEnvelope){ 0.004f, 1.2f, 0.35f, 0.18f };
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    synth->wideVectors = __builtin_cpu_supports("avx");
+#endif
+}
+
+// Free voice if there is one, otherwise the quietest releasing voice,
+// otherwise the oldest voice
+static int allocateVoice(Synth* synth) {
+    int quietest = -1;
+    float quietestLevel = 2.0f;
+    int oldest = 0;
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        const SynthVoice* voice = &synth->voices[i];
+        if (voice->stage == ENVELOPE_OFF) return i;
+        if (voice->stage == ENVELOPE_RELEASE) {
+            float level = synth->groups[i / SYNTH_LANES].env[i % SYNTH_LANES];
+            if (level < quietestLevel) {
+                quietestLevel = level;
+                quietest = i;
+            }
+        }
+        if (voice->startFrame < synth->voices[oldest].startFrame) oldest = i;
+    }
+    return quietest >= 0 ? quietest : oldest;
+}
+
+void synthNoteOn(Synth* synth, int note, int velocity) {
+    if (note < 0 || note > 127) return;
+    if (velocity <= 0) {
+        synthNoteOff(synth, note);
+        return;
+    }
+
+    int index = allocateVoice(synth);
+    SynthVoice* voice = &synth->voices[index];
+    SynthVoiceGroup* group = &synth->groups[index / SYNTH_LANES];
+    int lane = index % SYNTH_LANES;
+    if (voice->stage == ENVELOPE_OFF) synth->activeVoices++;
+
+    float rate = synth->sampleRate;
+    double frequency = 440.0 * pow(2.0, (note - 69) / 12.0);
+
+    // Low strings ring for seconds, high strings die quickly; upper partials faster still
+    float ring = 4.0f * powf(2.0f, -(note - 48) / 24.0f);
+    if (ring < 0.4f) ring = 0.4f;
+    if (ring > 8.0f) ring = 8.0f;
+
+    float loudness = velocity > 127 ? 1.0f : velocity / 127.0f;
+    float gain = 0.12f * powf(loudness, 1.6f);
+    float pan = (note - 64) / 128.0f;
+    if (pan < -0.5f) pan = -0.5f;
+    if (pan > 0.5f) pan = 0.5f;
+    float angle = (pan + 1.0f) * (float)(TWO_PI / 8.0);
+
+    voice->stage = ENVELOPE_ATTACK;
+    voice->note = note;
+    voice->startFrame = synth->frame;
+    voice->decayRate = envelopeRate(synth->envelope.decay, rate);
+    voice->releaseRate = envelopeRate(synth->envelope.release, rate);
+    for (int k = 0; k < SYNTH_PARTIALS; k++) {
+        int harmonic = k + 1;
+        double partialFrequency = frequency * harmonic * sqrt(1.0 + INHARMONICITY * harmonic * harmonic);
+        float lifetime = ring / powf((float)harmonic, 1.5f);
+        voice->phase[k] = 0.0;
+        voice->phaseStep[k] = TWO_PI * partialFrequency / rate;
+        voice->amplitude[k] = partialFrequency < rate * 0.45 ? partialWeights[k] : 0.0f;
+        voice->damping[k] = expf(-1.0f / (lifetime * rate));
+        setLane(&group->cosStep[k], lane, voice->damping[k] * (float)cos(voice->phaseStep[k]));
+        setLane(&group->sinStep[k], lane, voice->damping[k] * (float)sin(voice->phaseStep[k]));
+    }
+    setLane(&group->env, lane, 0.0f);
+    setLane(&group->envTarget, lane, 1.0f);
+    setLane(&group->envRate, lane, envelopeRate(synth->envelope.attack / 4.6f, rate));
+    setLane(&group->gainLeft, lane, gain * cosf(angle));
+    setLane(&group->gainRight, lane, gain * sinf(angle));
+}
+
+static void releaseVoice(Synth* synth, int index) {
+    SynthVoice* voice = &synth->voices[index];
+    SynthVoiceGroup* group = &synth->groups[index / SYNTH_LANES];
+    voice->stage = ENVELOPE_RELEASE;
+    setLane(&group->envTarget, index % SYNTH_LANES, 0.0f);
+    setLane(&group->envRate, index % SYNTH_LANES, voice->releaseRate);
+}
+
+// Release the oldest held voice playing this note
+void synthNoteOff(Synth* synth, int note) {
+    int found = -1;
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        const SynthVoice* voice = &synth->voices[i];
+        if (voice->note != note) continue;
+        if (voice->stage != ENVELOPE_ATTACK && voice->stage != ENVELOPE_DECAY) continue;
+        if (found < 0 || voice->startFrame < synth->voices[found].startFrame) found = i;
+    }
+    if (found >= 0) releaseVoice(synth, found);
+}
+
+void synthAllNotesOff(Synth* synth) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        SynthVoice* voice = &synth->voices[i];
+        if (voice->stage == ENVELOPE_ATTACK || voice->stage == ENVELOPE_DECAY) releaseVoice(synth, i);
+    }
+}
+
+static bool groupActive(const Synth* synth, int group) {
+    const SynthVoice* voices = &synth->voices[group * SYNTH_LANES];
+    for (int lane = 0; lane < SYNTH_LANES; lane++) {
+        if (voices[lane].stage != ENVELOPE_OFF) return true;
+    }
+    return false;
+}
+
+// Load each active voice's partial phasors from its exact phase and amplitude,
+// so rounding in the per-sample rotation never accumulates past one block
+static void beginBlock(Synth* synth) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        const SynthVoice* voice = &synth->voices[i];
+        if (voice->stage == ENVELOPE_OFF) continue;
+        SynthVoiceGroup* group = &synth->groups[i / SYNTH_LANES];
+        int lane = i % SYNTH_LANES;
+        for (int k = 0; k < SYNTH_PARTIALS; k++) {
+            setLane(&group->re[k], lane, voice->amplitude[k] * (float)cos(voice->phase[k]));
+            setLane(&group->im[k], lane, voice->amplitude[k] * (float)sin(voice->phase[k]));
+        }
+    }
+}
+
+// Advance phases and amplitudes past the block and move envelopes between stages
+static void endBlock(Synth* synth, int frames) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        SynthVoice* voice = &synth->voices[i];
+        if (voice->stage == ENVELOPE_OFF) continue;
+        SynthVoiceGroup* group = &synth->groups[i / SYNTH_LANES];
+        int lane = i % SYNTH_LANES;
+
+        for (int k = 0; k < SYNTH_PARTIALS; k++) {
+            voice->phase[k] = fmod(voice->phase[k] + voice->phaseStep[k] * frames, TWO_PI);
+            voice->amplitude[k] *= powf(voice->damping[k], (float)frames);
+        }
+
+        float level = group->env[lane];
+        if (voice->stage == ENVELOPE_ATTACK && level >= ATTACK_PEAK) {
+            voice->stage = ENVELOPE_DECAY;
+            setLane(&group->envTarget, lane, synth->envelope.sustain);
+            setLane(&group->envRate, lane, voice->decayRate);
+        } else if (level < SILENCE && voice->stage != ENVELOPE_ATTACK) {
+            voice->stage = ENVELOPE_OFF;
+            synth->activeVoices--;
+            for (int k = 0; k < SYNTH_PARTIALS; k++) {
+                setLane(&group->re[k], lane, 0.0f);
+                setLane(&group->im[k], lane, 0.0f);
+            }
+            setLane(&group->env, lane, 0.0f);
+            setLane(&group->gainLeft, lane, 0.0f);
+            setLane(&group->gainRight, lane, 0.0f);
+        } else if (voice->amplitude[0] + voice->amplitude[1] + voice->amplitude[2] < SILENCE) {
+            // The string itself has died away; nothing left to release
+            releaseVoice(synth, i);
+            setLane(&group->env, lane, 0.0f);
+        }
+    }
+}
+
+// Render SYNTH_LANES voices into per-lane accumulators. Every lane is an
+// independent voice, so the loop is pure vertical SIMD; lanes are summed once
+// per frame after all groups are done.
+static inline __attribute__((always_inline)) void renderGroup(SynthVoiceGroup* group, int frames, SynthVec* left, SynthVec* right) {
+    SynthVec re[SYNTH_PARTIALS];
+    SynthVec im[SYNTH_PARTIALS];
+    SynthVec cosStep[SYNTH_PARTIALS];
+    SynthVec sinStep[SYNTH_PARTIALS];
+    for (int k = 0; k < SYNTH_PARTIALS; k++) {
+        re[k] = group->re[k];
+        im[k] = group->im[k];
+        cosStep[k] = group->cosStep[k];
+        sinStep[k] = group->sinStep[k];
+    }
+    SynthVec env = group->env;
+    SynthVec target = group->envTarget;
+    SynthVec rate = group->envRate;
+    SynthVec gainLeft = group->gainLeft;
+    SynthVec gainRight = group->gainRight;
+
+    for (int f = 0; f < frames; f++) {
+        env += (target - env) * rate;
+        SynthVec sum = re[0];
+        for (int k = 1; k < SYNTH_PARTIALS; k++) sum += re[k];
+        SynthVec sample = sum * env;
+        left[f] += sample * gainLeft;
+        right[f] += sample * gainRight;
+        for (int k = 0; k < SYNTH_PARTIALS; k++) {
+            SynthVec rotated = re[k] * cosStep[k] - im[k] * sinStep[k];
+            im[k] = re[k] * sinStep[k] + im[k] * cosStep[k];
+            re[k] = rotated;
+        }
+    }
+    group->env = env;
+}
+
+// Baseline build: GCC splits each 8-lane vector into SSE pairs on x86, NEON on ARM
+static void renderGroups(Synth* synth, int frames, SynthVec* left, SynthVec* right) {
+    for (int g = 0; g < SYNTH_GROUPS; g++) {
+        if (groupActive(synth, g)) renderGroup(&synth->groups[g], frames, left, right);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Same loop compiled for AVX, picked at runtime when the CPU supports it
+__attribute__((target("avx"))) static void renderGroupsAvx(Synth* synth, int frames, SynthVec* left, SynthVec* right) {
+    for (int g = 0; g < SYNTH_GROUPS; g++) {
+        if (groupActive(synth, g)) renderGroup(&synth->groups[g], frames, left, right);
+    }
+}
+#endif
+
+static float sumLanes(const SynthVec* vector) {
+    float sum = 0.0f;
+    for (int lane = 0; lane < SYNTH_LANES; lane++) sum += (*vector)[lane];
+    return sum;
+}
+
+// Soft clip that is transparent at normal levels and saturates past full scale
+static float softClip(float x) {
+    if (x > 3.0f) return 1.0f;
+    if (x < -3.0f) return -1.0f;
+    return x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+}
+
+// Move envelopes across a block in closed form instead of sample by sample
+static void skipEnvelopes(Synth* synth, int frames) {
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) {
+        if (synth->voices[i].stage == ENVELOPE_OFF) continue;
+        SynthVoiceGroup* group = &synth->groups[i / SYNTH_LANES];
+        int lane = i % SYNTH_LANES;
+        float target = group->envTarget[lane];
+        float remaining = powf(1.0f - group->envRate[lane], (float)frames);
+        setLane(&group->env, lane, target + (group->env[lane] - target) * remaining);
+    }
+}
+
+// Render interleaved stereo frames, overwriting output. Never allocates.
+// A NULL output fast-forwards the voices without producing audio, following
+// the same block boundaries so the state matches a real render.
+void synthRender(Synth* synth, float* output, int frames) {
+    SynthVec left[SYNTH_BLOCK];
+    SynthVec right[SYNTH_BLOCK];
+
+    while (frames > 0) {
+        int count = frames < SYNTH_BLOCK ? frames : SYNTH_BLOCK;
+        if (!output) {
+            if (synth->activeVoices > 0) {
+                skipEnvelopes(synth, count);
+                endBlock(synth, count);
+            }
+        } else if (synth->activeVoices == 0) {
+            memset(output, 0, sizeof(float) * 2 * count);
+        } else {
+            memset(left, 0, sizeof(SynthVec) * count);
+            memset(right, 0, sizeof(SynthVec) * count);
+            beginBlock(synth);
+#if defined(__x86_64__) || defined(__i386__)
+            if (synth->wideVectors) renderGroupsAvx(synth, count, left, right);
+            else renderGroups(synth, count, left, right);
+#else
+            renderGroups(synth, count, left, right);
+#endif
+            endBlock(synth, count);
+            for (int f = 0; f < count; f++) {
+                output[f * 2] = softClip(sumLanes(&left[f]));
+                output[f * 2 + 1] = softClip(sumLanes(&right[f]));
+            }
+        }
+        synth->frame += count;
+        if (output) output += count * 2;
+        frames -= count;
+    }
+}
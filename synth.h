@@ -0,0 +1,74 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYNTH_LANES 8                   // Voices processed together (one AVX register)
+#define SYNTH_GROUPS 20                 // Voice groups
+#define SYNTH_MAX_VOICES (SYNTH_LANES * SYNTH_GROUPS)
+#define SYNTH_PARTIALS 3                // Harmonics per voice
+#define SYNTH_BLOCK 64                  // Frames between envelope/phase updates
+
+// Eight floats, aligned like malloc so Synth needs no special allocator
+typedef float SynthVec __attribute__((vector_size(32), aligned(16)));
+
+typedef enum {
+    ENVELOPE_OFF = 0,
+    ENVELOPE_ATTACK,
+    ENVELOPE_DECAY,
+    ENVELOPE_RELEASE
+} EnvelopeStage;
+
+// ADSR times in seconds; sustain is a level (0-1)
+typedef struct {
+    float attack;
+    float decay;
+    float sustain;
+    float release;
+} SynthEnvelope;
+
+// Lane state for SYNTH_LANES voices, laid out for SIMD
+typedef struct {
+    SynthVec re[SYNTH_PARTIALS];        // Partial phasors, reset every block
+    SynthVec im[SYNTH_PARTIALS];
+    SynthVec cosStep[SYNTH_PARTIALS];   // Per-sample rotation including damping
+    SynthVec sinStep[SYNTH_PARTIALS];
+    SynthVec env;                       // Envelope level
+    SynthVec envTarget;                 // Level the envelope is gliding toward
+    SynthVec envRate;                   // One-pole coefficient toward envTarget
+    SynthVec gainLeft;                  // Velocity and pan gain
+    SynthVec gainRight;
+} SynthVoiceGroup;
+
+// Scalar per-voice bookkeeping
+typedef struct {
+    EnvelopeStage stage;                // OFF when the voice is free
+    int note;                           // MIDI note being played
+    uint64_t startFrame;                // Frame the voice started, for stealing the oldest
+    double phase[SYNTH_PARTIALS];       // Partial phases in radians
+    double phaseStep[SYNTH_PARTIALS];   // Partial phase advance per frame
+    float amplitude[SYNTH_PARTIALS];    // Partial amplitude at the next block start
+    float damping[SYNTH_PARTIALS];      // Per-frame partial decay
+    float decayRate;                    // Envelope coefficient for the decay stage
+    float releaseRate;                  // Envelope coefficient for the release stage
+} SynthVoice;
+
+// Fixed-pool polyphonic piano-like synthesizer
+typedef struct {
+    SynthVoiceGroup groups[SYNTH_GROUPS];
+    SynthVoice voices[SYNTH_MAX_VOICES];
+    SynthEnvelope envelope;             // ADSR used for new voices
+    float sampleRate;                   // Output rate in Hz
+    uint64_t frame;                     // Frames rendered so far
+    int activeVoices;                   // Voices not OFF
+    bool wideVectors;                   // CPU has AVX, use the 8-lane path
+} Synth;
+
+void initSynth(Synth* synth, float sampleRate);
+void synthNoteOn(Synth* synth, int note, int velocity);
+void synthNoteOff(Synth* synth, int note);
+void synthAllNotesOff(Synth* synth);
+void synthRender(Synth* synth, float* output, int frames);
+
+#endif
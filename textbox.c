@@ -0,0 +1,753 @@
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "fonts.h"
+#include "inputlog.h"
+#include "textbox.h"
+
+#define SCROLLBAR_COLOR (Color){ 0x49, 0x4D, 0x5A, 255 }   // #494D5A, like the song list's
+
+// Advance table for a font and size, built on first use
+const GlyphAdvances* glyphAdvances(Font font, float fontSize) {
+    static GlyphAdvances tables[GLYPH_TABLE_FONTS];
+    static int next = 0;
+    for (int i = 0; i < GLYPH_TABLE_FONTS; i++) {
+        if (tables[i].textureId == font.texture.id && tables[i].fontSize == fontSize) return &tables[i];
+    }
+
+    GlyphAdvances* table = &tables[next];
+    next = (next + 1) % GLYPH_TABLE_FONTS;
+    table->textureId = font.texture.id;
+    table->font = font;
+    table->fontSize = fontSize;
+    table->scale = fontSize / (float)font.baseSize;
+    for (int c = 0; c < 128; c++) {
+        int index = GetGlyphIndex(font, c);
+        float advance = font.glyphs[index].advanceX ? font.glyphs[index].advanceX : font.recs[index].width + font.glyphs[index].offsetX;
+        table->advance[c] = advance * table->scale + 1;
+    }
+    return table;
+}
+
+// Advance of the UTF-8 sequence at text; codepoints without a glyph advance
+// like the '?' raylib draws in their place
+static float sequenceAdvance(const GlyphAdvances* glyphs, const char* text, int length, int* size) {
+    int advance = fontGlyphAdvance(glyphs->font, decodeCodepoint(text, length, size));
+    return advance < 0 ? glyphs->advance['?'] : advance * glyphs->scale + 1;
+}
+
+// Summed advances include the 1px spacing after the last glyph, which
+// MeasureTextEx leaves out; carets and selections are placed the same way
+static float trimSpacing(float advances) {
+    return advances > 0 ? advances - 1 : 0;
+}
+
+// Width of text as MeasureTextEx reports it at spacing 1
+float textAdvance(const GlyphAdvances* glyphs, const char* text, int length) {
+    float width = 0;
+    for (int i = 0; i < length; ) {
+        unsigned char c = (unsigned char)text[i];
+        int size = 1;
+        width += c < 0x80 ? glyphs->advance[c] : sequenceAdvance(glyphs, text + i, length - i, &size);
+        i += size;
+    }
+    return trimSpacing(width);
+}
+
+// Prefix sums of the advances: caretX[i] is the offset of a caret before
+// byte i, for i in 0..length, equal to textAdvance of the first i bytes.
+// Positions inside a UTF-8 sequence share the offset after it.
+void buildCaretOffsets(const GlyphAdvances* glyphs, const char* text, int length, float* caretX) {
+    float width = 0;
+    caretX[0] = 0;
+    for (int i = 0; i < length; ) {
+        unsigned char c = (unsigned char)text[i];
+        int size = 1;
+        width += c < 0x80 ? glyphs->advance[c] : sequenceAdvance(glyphs, text + i, length - i, &size);
+        for (int j = 1; j <= size; j++) caretX[i + j] = trimSpacing(width);
+        i += size;
+    }
+}
+
+// Caret position nearest to offset x, never inside a UTF-8 sequence
+int caretIndexAt(const char* text, const float* caretX, int length, float x) {
+    int low = 0;
+    int high = length;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (caretX[mid] < x) low = mid + 1;
+        else high = mid;
+    }
+    if (low > 0 && x - caretX[low - 1] < caretX[low] - x) low--;
+    while (low < length && ((unsigned char)text[low] & 0xC0) == 0x80) low++;
+    return low;
+}
+
+// Render fixed-size textbox text
+void drawTextboxText(Textbox* textbox, Color textColor, bool isPasteArea) {
+    const char* displayText = (textbox->textLength == 0 && !textbox->editing) ? textbox->placeholder : textbox->text;
+    useFontGlyphs(textbox->font, displayText, strlen(displayText));
+    Vector2 textSize = MeasureTextEx(textbox->font, displayText, textbox->fontSize, 1);
+    float maxTextWidth = textbox->bounds.width - 10;
+    float maxTextHeight = textbox->bounds.height - 10;
+
+    textbox->horizontalOffset = (textSize.x > maxTextWidth) ? (textSize.x - maxTextWidth) : 0;
+
+    Rectangle scissorRect = { textbox->bounds.x + 5, textbox->bounds.y + 5, maxTextWidth, maxTextHeight };
+    BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
+
+    float yPos = textbox->bounds.y + 5;
+    DrawTextEx(textbox->font, displayText, 
+               (Vector2){ textbox->bounds.x + 5 - textbox->horizontalOffset, yPos }, 
+               textbox->fontSize, 1, textColor);
+
+    // Draw selection highlight
+    if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
+        int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+        int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+        const GlyphAdvances* glyphs = glyphAdvances(textbox->font, textbox->fontSize);
+        float startX = textbox->bounds.x + 5 + textAdvance(glyphs, displayText, start) - textbox->horizontalOffset;
+        float endX = textbox->bounds.x + 5 + textAdvance(glyphs, displayText, end) - textbox->horizontalOffset;
+        DrawRectangle(startX, yPos, endX - startX, textbox->fontSize, Fade(WHITE, 0.3f));
+    }
+
+    // Draw cursor
+    if (textbox->editing && textbox->cursorBlink < 0.5f) {
+        if (textbox->textLength == 0) {
+            float cursorX = textbox->bounds.x + 5 - textbox->horizontalOffset;
+            DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
+        } else {
+            const GlyphAdvances* glyphs = glyphAdvances(textbox->font, textbox->fontSize);
+            float cursorX = textbox->bounds.x + 5 + textAdvance(glyphs, displayText, textbox->cursorPos) - textbox->horizontalOffset;
+            DrawRectangle(cursorX, yPos, 2, textbox->fontSize, textColor);
+        }
+    }
+
+    EndScissorMode();
+}
+
+// Render dynamic textbox text (paste area). Only the lines inside the
+// visible window are copied out and drawn; widths come from the line index.
+void drawDynamicTextboxText(DynamicTextbox* textbox, Color textColor) {
+    bool showPlaceholder = textbox->textLength == 0 && !textbox->editing;
+    float maxTextWidth = textbox->bounds.width - 15;
+    float maxTextHeight = textbox->bounds.height - 10;
+    float lineHeight = textbox->fontSize + 2;
+    const GlyphAdvances* glyphs = glyphAdvances(textbox->font, textbox->fontSize);
+
+    // Horizontal offset follows the longest line
+    float maxLineWidth = dynamicTextboxMaxLineWidth(textbox);
+    textbox->horizontalOffset = (maxLineWidth > maxTextWidth) ? (maxLineWidth - maxTextWidth) : 0;
+
+    Rectangle scissorRect = { textbox->bounds.x + 5, textbox->bounds.y + 5, maxTextWidth, maxTextHeight };
+    BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
+
+    float textX = textbox->bounds.x + 5 - textbox->horizontalOffset;
+    float textY = textbox->bounds.y + 5 - textbox->verticalOffset;
+    float totalHeight = textbox->lineCount * lineHeight;
+    int firstLine = (int)(textbox->verticalOffset / lineHeight);
+    int lastLine = (int)((textbox->verticalOffset + maxTextHeight) / lineHeight) + 1;
+    if (firstLine < 0) firstLine = 0;
+    if (lastLine > textbox->lineCount) lastLine = textbox->lineCount;
+
+    // Render the visible lines
+    if (showPlaceholder) {
+        DrawTextEx(textbox->font, textbox->placeholder, (Vector2){ textX, textY }, textbox->fontSize, 1, textColor);
+    } else {
+        for (int i = firstLine; i < lastLine; i++) {
+            int lineLen = 0;
+            const char* line = dynamicTextboxLine(textbox, i, &lineLen);
+            if (line && line[0]) {
+                useFontGlyphs(textbox->font, line, lineLen);
+                DrawTextEx(textbox->font, line, (Vector2){ textX, textY + i * lineHeight }, textbox->fontSize, 1, textColor);
+            }
+        }
+    }
+
+    // Draw selection highlight
+    if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
+        int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+        int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+        for (int i = firstLine; i < lastLine; i++) {
+            int lineStart = dynamicTextboxLineStart(textbox, i);
+            int lineLen = dynamicTextboxLineLength(textbox, i);
+            if (lineStart + lineLen < start || lineStart > end) continue;
+            const char* line = dynamicTextboxLine(textbox, i, NULL);
+            if (!line) continue;
+            float startX = textX;
+            float endX = startX + textbox->lineWidths[i];
+            if (lineStart < start) startX += textAdvance(glyphs, line, start - lineStart);
+            if (lineStart + lineLen > end) endX = textX + textAdvance(glyphs, line, end - lineStart);
+            DrawRectangle(startX, textY + i * lineHeight, endX - startX, textbox->fontSize, Fade(WHITE, 0.3f));
+        }
+    }
+
+    // Draw cursor
+    if (textbox->editing && textbox->cursorBlink < 0.5f) {
+        int line = findDynamicTextboxLine(textbox, textbox->cursorPos);
+        const char* text = dynamicTextboxLine(textbox, line, NULL);
+        float cursorX = textX + (text ? textAdvance(glyphs, text, textbox->cursorPos - dynamicTextboxLineStart(textbox, line)) : 0);
+        DrawRectangle(cursorX, textY + line * lineHeight, 2, textbox->fontSize, textColor);
+    }
+
+    // Scrolling logic
+    Vector2 mousePos = inputMousePosition();
+    if (CheckCollisionPointRec(mousePos, textbox->bounds)) {
+        float wheel = inputMouseWheelMove();
+        if (wheel != 0) {
+            if (totalHeight > maxTextHeight) {
+                textbox->verticalOffset -= wheel * 20.0f;
+                if (textbox->verticalOffset < 0) textbox->verticalOffset = 0;
+                if (textbox->verticalOffset > totalHeight - maxTextHeight) textbox->verticalOffset = totalHeight - maxTextHeight;
+            } else {
+                textbox->verticalOffset = 0;
+            }
+        }
+    }
+
+    EndScissorMode();
+
+    // Scrollbar
+    if (totalHeight > maxTextHeight) {
+        float scrollBarHeight = maxTextHeight * maxTextHeight / totalHeight;
+        float scrollBarY = textbox->bounds.y + 5 + (textbox->verticalOffset * (maxTextHeight - scrollBarHeight) / (totalHeight - maxTextHeight));
+        DrawRectangle(textbox->bounds.x + textbox->bounds.width - 10, scrollBarY, 5, scrollBarHeight, SCROLLBAR_COLOR);
+    }
+}
+
+// Start of the character before pos
+int previousCharStart(const char* text, int pos) {
+    do pos--; while (pos > 0 && ((unsigned char)text[pos] & 0xC0) == 0x80);
+    return pos;
+}
+
+// End of the character starting at pos
+int nextCharEnd(const char* text, int length, int pos) {
+    do pos++; while (pos < length && ((unsigned char)text[pos] & 0xC0) == 0x80);
+    return pos;
+}
+
+// Input handling for fixed-size textbox
+void handleTextboxInput(Textbox* textbox, bool isPasteArea) {
+    Vector2 mousePos = inputMousePosition();
+    bool mouseOver = CheckCollisionPointRec(mousePos, textbox->bounds);
+
+    if (mouseOver && inputMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+        float caretX[sizeof(textbox->text) + 1];
+        float xOffset = mousePos.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
+        buildCaretOffsets(glyphAdvances(textbox->font, textbox->fontSize), textbox->text, textbox->textLength, caretX);
+        int pos = caretIndexAt(textbox->text, caretX, textbox->textLength, xOffset);
+        if (inputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            textbox->selectionStart = -1;
+            textbox->cursorPos = pos;
+        }
+        textbox->selectionEnd = pos;
+        if (textbox->selectionStart == -1) textbox->selectionStart = textbox->cursorPos;
+    }
+
+    int key = inputCharPressed();
+    while (key > 0 && textbox->textLength < 255) {
+        if (textbox->numericOnly) {
+            if (key >= '0' && key <= '9') { 
+                textbox->text[textbox->textLength++] = (char)key;
+                textbox->text[textbox->textLength] = '\0';
+                textbox->cursorPos++;
+            }
+        } else if (key >= 32 && key != 127) {
+            int size = 0;
+            const char* utf8 = CodepointToUTF8(key, &size);
+            if (textbox->textLength + size <= 255) {
+                memcpy(textbox->text + textbox->textLength, utf8, size);
+                textbox->textLength += size;
+                textbox->text[textbox->textLength] = '\0';
+                textbox->cursorPos += size;
+            }
+        }
+        key = inputCharPressed();
+    }
+
+    if ((inputKeyDown(KEY_LEFT_CONTROL) || inputKeyDown(KEY_RIGHT_CONTROL)) && inputKeyPressed(KEY_V)) {
+        const char* clipboard = inputClipboardText();
+        if (clipboard) {
+            int len = strlen(clipboard);
+            int spaceLeft = 255 - textbox->textLength;
+            int charsToCopy = (len < spaceLeft) ? len : spaceLeft;
+            while (charsToCopy > 0 && charsToCopy < len && ((unsigned char)clipboard[charsToCopy] & 0xC0) == 0x80) charsToCopy--;
+            if (textbox->numericOnly) {
+                for (int i = 0; i < charsToCopy; i++) {
+                    if (clipboard[i] >= '0' && clipboard[i] <= '9') {
+                        textbox->text[textbox->textLength++] = clipboard[i];
+                        textbox->cursorPos++;
+                    }
+                }
+            } else {
+                strncpy(textbox->text + textbox->textLength, clipboard, charsToCopy);
+                textbox->textLength += charsToCopy;
+                textbox->cursorPos += charsToCopy;
+            }
+            textbox->text[textbox->textLength] = '\0';
+        }
+    }
+
+    if ((inputKeyDown(KEY_LEFT_CONTROL) || inputKeyDown(KEY_RIGHT_CONTROL)) && inputKeyPressed(KEY_A)) {
+        textbox->selectionStart = 0;
+        textbox->selectionEnd = textbox->textLength;
+        textbox->cursorPos = textbox->textLength;
+    }
+
+    if (inputKeyPressed(KEY_LEFT) && textbox->cursorPos > 0) {
+        textbox->cursorPos = previousCharStart(textbox->text, textbox->cursorPos);
+        textbox->selectionStart = textbox->selectionEnd = -1;
+    }
+    if (inputKeyPressed(KEY_RIGHT) && textbox->cursorPos < textbox->textLength) {
+        textbox->cursorPos = nextCharEnd(textbox->text, textbox->textLength, textbox->cursorPos);
+        textbox->selectionStart = textbox->selectionEnd = -1;
+    }
+
+    if (inputKeyPressed(KEY_BACKSPACE) && textbox->textLength > 0) {
+        if (textbox->selectionStart != -1 && textbox->selectionEnd != -1 && textbox->selectionStart != textbox->selectionEnd) {
+            int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+            int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+            int lenToRemove = end - start;
+            memmove(textbox->text + start, textbox->text + end, textbox->textLength - end + 1);
+            textbox->textLength -= lenToRemove;
+            textbox->cursorPos = start;
+            textbox->selectionStart = textbox->selectionEnd = -1;
+        } else if (textbox->cursorPos > 0) {
+            int start = previousCharStart(textbox->text, textbox->cursorPos);
+            memmove(textbox->text + start, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
+            textbox->textLength -= textbox->cursorPos - start;
+            textbox->cursorPos = start;
+        }
+        textbox->backspaceTimer = 0.3f;
+    }
+
+    if (inputKeyDown(KEY_BACKSPACE) && textbox->textLength > 0 && textbox->cursorPos > 0) {
+        textbox->backspaceTimer -= inputFrameTime();
+        if (textbox->backspaceTimer <= 0) {
+            int start = previousCharStart(textbox->text, textbox->cursorPos);
+            memmove(textbox->text + start, textbox->text + textbox->cursorPos, textbox->textLength - textbox->cursorPos + 1);
+            textbox->textLength -= textbox->cursorPos - start;
+            textbox->cursorPos = start;
+            textbox->backspaceTimer = 0.05f;
+        }
+    }
+
+    if (inputKeyReleased(KEY_BACKSPACE)) {
+        textbox->backspaceTimer = 0;
+    }
+
+    textbox->cursorBlink += inputFrameTime();
+    if (textbox->cursorBlink > 1.0f) textbox->cursorBlink = 0.0f;
+}
+
+// Record that removedLength chars at pos were replaced by insertedLength chars,
+// merging with edits not yet consumed so consumers see one changed range
+void markDynamicTextboxEdit(DynamicTextbox* textbox, int pos, int removedLength, int insertedLength) {
+    if (textbox->editStart < 0) {
+        textbox->editStart = pos;
+        textbox->editOldEnd = pos + removedLength;
+        textbox->editNewEnd = pos + insertedLength;
+        return;
+    }
+    int unchangedFrom = textbox->editNewEnd > pos + removedLength ? textbox->editNewEnd : pos + removedLength;
+    if (pos < textbox->editStart) textbox->editStart = pos;
+    textbox->editOldEnd += unchangedFrom - textbox->editNewEnd;
+    textbox->editNewEnd = unchangedFrom + insertedLength - removedLength;
+}
+
+// Offset of the first character of a line
+int dynamicTextboxLineStart(const DynamicTextbox* textbox, int line) {
+    return textbox->lineStarts[line] + (line >= textbox->shiftFrom ? textbox->shiftDelta : 0);
+}
+
+// Move the start of the pending shift to line. Only the lines between the
+// old and new position are rewritten, so edits that stay in one area of
+// the text cost the same however many lines follow.
+static void settleDynamicTextboxShift(DynamicTextbox* textbox, int line) {
+    if (line > textbox->lineCount) line = textbox->lineCount;
+    for (int i = textbox->shiftFrom; i < line; i++) textbox->lineStarts[i] += textbox->shiftDelta;
+    for (int i = line; i < textbox->shiftFrom; i++) textbox->lineStarts[i] -= textbox->shiftDelta;
+    textbox->shiftFrom = line;
+}
+
+// Index of the line containing logical position pos
+int findDynamicTextboxLine(const DynamicTextbox* textbox, int pos) {
+    int low = 0;
+    int high = textbox->lineCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (dynamicTextboxLineStart(textbox, mid) <= pos) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+// Length of a line, not counting its newline
+int dynamicTextboxLineLength(const DynamicTextbox* textbox, int line) {
+    int end = line + 1 < textbox->lineCount ? dynamicTextboxLineStart(textbox, line + 1) - 1 : textbox->textLength;
+    return end - dynamicTextboxLineStart(textbox, line);
+}
+
+// Terminated copy of one line in the textbox's scratch buffer, valid until
+// the next call
+const char* dynamicTextboxLine(DynamicTextbox* textbox, int line, int* length) {
+    int start = dynamicTextboxLineStart(textbox, line);
+    int lineLen = dynamicTextboxLineLength(textbox, line);
+    if (lineLen + 1 > textbox->lineScratchCapacity) {
+        int capacity = lineLen + 256;
+        char* scratch = realloc(textbox->lineScratch, capacity);
+        if (!scratch) return NULL;
+        textbox->lineScratch = scratch;
+        textbox->lineScratchCapacity = capacity;
+    }
+    int before = textbox->gapStart - start;
+    if (before > lineLen) before = lineLen;
+    if (before < 0) before = 0;
+    int gapSize = textbox->gapEnd - textbox->gapStart;
+    memcpy(textbox->lineScratch, textbox->text + start, before);
+    memcpy(textbox->lineScratch + before, textbox->text + start + before + gapSize, lineLen - before);
+    textbox->lineScratch[lineLen] = '\0';
+    if (length) *length = lineLen;
+    return textbox->lineScratch;
+}
+
+// Re-measure one line, keeping the cached widest line width in step
+static void measureDynamicTextboxLine(DynamicTextbox* textbox, int line) {
+    int length = 0;
+    const char* text = dynamicTextboxLine(textbox, line, &length);
+    float oldWidth = textbox->lineWidths[line];
+    float width = text ? textAdvance(glyphAdvances(textbox->font, textbox->fontSize), text, length) : 0;
+    textbox->lineWidths[line] = width;
+    if (textbox->maxLineWidth < 0) return;
+    if (width >= textbox->maxLineWidth) textbox->maxLineWidth = width;
+    else if (oldWidth == textbox->maxLineWidth) textbox->maxLineWidth = -1;
+}
+
+static bool reserveDynamicTextboxLines(DynamicTextbox* textbox, int count) {
+    if (count <= textbox->lineCapacity) return true;
+    int capacity = textbox->lineCapacity ? textbox->lineCapacity : 64;
+    while (capacity < count) capacity *= 2;
+    int* starts = realloc(textbox->lineStarts, sizeof(int) * capacity);
+    if (!starts) return false;
+    textbox->lineStarts = starts;
+    float* widths = realloc(textbox->lineWidths, sizeof(float) * capacity);
+    if (!widths) return false;
+    textbox->lineWidths = widths;
+    textbox->lineCapacity = capacity;
+    return true;
+}
+
+// Width of the longest line, searched for again only after the widest line
+// got narrower or was removed
+float dynamicTextboxMaxLineWidth(DynamicTextbox* textbox) {
+    if (textbox->maxLineWidth < 0) {
+        textbox->maxLineWidth = 0;
+        for (int i = 0; i < textbox->lineCount; i++) {
+            if (textbox->lineWidths[i] > textbox->maxLineWidth) textbox->maxLineWidth = textbox->lineWidths[i];
+        }
+    }
+    return textbox->maxLineWidth;
+}
+
+// Move the gap so that it starts at logical position pos. Only the text
+// between the old and new gap position is moved.
+static void moveDynamicTextboxGap(DynamicTextbox* textbox, int pos) {
+    int gapSize = textbox->gapEnd - textbox->gapStart;
+    if (pos < textbox->gapStart) {
+        int count = textbox->gapStart - pos;
+        memmove(textbox->text + textbox->gapEnd - count, textbox->text + pos, count);
+    } else if (pos > textbox->gapStart) {
+        int count = pos - textbox->gapStart;
+        memmove(textbox->text + textbox->gapStart, textbox->text + textbox->gapEnd, count);
+    }
+    textbox->gapStart = pos;
+    textbox->gapEnd = pos + gapSize;
+}
+
+// Make the gap hold at least length bytes plus one spare for the terminator
+static bool reserveDynamicTextboxGap(DynamicTextbox* textbox, int length) {
+    if (textbox->gapEnd - textbox->gapStart > length) return true;
+    int capacity = textbox->textCapacity;
+    while (capacity - textbox->textLength <= length) capacity *= 2;
+    char* text = realloc(textbox->text, capacity);
+    if (!text) return false;
+    int tail = textbox->textCapacity - textbox->gapEnd;
+    memmove(text + capacity - tail, text + textbox->gapEnd, tail);
+    textbox->text = text;
+    textbox->gapEnd = capacity - tail;
+    textbox->textCapacity = capacity;
+    return true;
+}
+
+// Insert text at logical position pos. Lines after the insertion are
+// shifted; only the lines the new text lands on are measured.
+bool insertDynamicTextboxText(DynamicTextbox* textbox, int pos, const char* text, int length) {
+    if (length <= 0) return true;
+    int newLines = 0;
+    for (const char* c = memchr(text, '\n', length); c; c = memchr(c + 1, '\n', length - (c + 1 - text))) newLines++;
+    if (!reserveDynamicTextboxLines(textbox, textbox->lineCount + newLines)) return false;
+    if (!reserveDynamicTextboxGap(textbox, length)) return false;
+    moveDynamicTextboxGap(textbox, pos);
+    memcpy(textbox->text + textbox->gapStart, text, length);
+    textbox->gapStart += length;
+    textbox->textLength += length;
+    markDynamicTextboxEdit(textbox, pos, 0, length);
+    textbox->caretLine = -1;
+
+    int line = findDynamicTextboxLine(textbox, pos);
+    settleDynamicTextboxShift(textbox, line + 1);
+    if (newLines > 0) {
+        int tail = textbox->lineCount - line - 1;
+        memmove(&textbox->lineStarts[line + 1 + newLines], &textbox->lineStarts[line + 1], sizeof(int) * tail);
+        memmove(&textbox->lineWidths[line + 1 + newLines], &textbox->lineWidths[line + 1], sizeof(float) * tail);
+        textbox->lineCount += newLines;
+        int next = line + 1;
+        for (int i = 0; i < length; i++) {
+            if (text[i] != '\n') continue;
+            textbox->lineStarts[next] = pos + i + 1;
+            textbox->lineWidths[next++] = -1;
+        }
+    }
+    textbox->shiftFrom = line + 1 + newLines;
+    textbox->shiftDelta += length;
+    for (int i = line; i <= line + newLines; i++) measureDynamicTextboxLine(textbox, i);
+    return true;
+}
+
+// Remove length bytes starting at logical position pos. Lines whose
+// newline was removed merge into the line holding pos.
+void deleteDynamicTextboxText(DynamicTextbox* textbox, int pos, int length) {
+    if (length <= 0) return;
+    int first = findDynamicTextboxLine(textbox, pos);
+    int last = findDynamicTextboxLine(textbox, pos + length);
+    moveDynamicTextboxGap(textbox, pos);
+    textbox->gapEnd += length;
+    textbox->textLength -= length;
+    markDynamicTextboxEdit(textbox, pos, length, 0);
+    textbox->caretLine = -1;
+
+    for (int i = first + 1; i <= last; i++) {
+        if (textbox->lineWidths[i] == textbox->maxLineWidth) textbox->maxLineWidth = -1;
+    }
+    settleDynamicTextboxShift(textbox, last + 1);
+    if (last > first) {
+        int tail = textbox->lineCount - last - 1;
+        memmove(&textbox->lineStarts[first + 1], &textbox->lineStarts[last + 1], sizeof(int) * tail);
+        memmove(&textbox->lineWidths[first + 1], &textbox->lineWidths[last + 1], sizeof(float) * tail);
+        textbox->lineCount -= last - first;
+    }
+    textbox->shiftFrom = first + 1;
+    textbox->shiftDelta -= length;
+    measureDynamicTextboxLine(textbox, first);
+}
+
+// Remove the selected text and put the cursor where it began. Returns false
+// if nothing was selected.
+bool deleteDynamicTextboxSelection(DynamicTextbox* textbox) {
+    if (textbox->selectionStart == -1 || textbox->selectionEnd == -1 || textbox->selectionStart == textbox->selectionEnd) return false;
+    int start = textbox->selectionStart < textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+    int end = textbox->selectionStart > textbox->selectionEnd ? textbox->selectionStart : textbox->selectionEnd;
+    deleteDynamicTextboxText(textbox, start, end - start);
+    textbox->cursorPos = start;
+    textbox->selectionStart = textbox->selectionEnd = -1;
+    return true;
+}
+
+// Replace all of the text, leaving the gap at the end, and rebuild the line
+// index
+bool setDynamicTextboxText(DynamicTextbox* textbox, const char* text, int length) {
+    int lineCount = 1;
+    for (const char* c = memchr(text, '\n', length); c; c = memchr(c + 1, '\n', length - (c + 1 - text))) lineCount++;
+    if (!reserveDynamicTextboxLines(textbox, lineCount)) return false;
+    if (length + 1 > textbox->textCapacity) {
+        char* buffer = realloc(textbox->text, length + 256);
+        if (!buffer) return false;
+        textbox->text = buffer;
+        textbox->textCapacity = length + 256;
+    }
+    memcpy(textbox->text, text, length);
+    textbox->text[length] = '\0';
+    textbox->textLength = length;
+    textbox->gapStart = length;
+    textbox->gapEnd = textbox->textCapacity;
+
+    textbox->lineCount = 1;
+    textbox->lineStarts[0] = 0;
+    textbox->shiftFrom = 0;
+    textbox->shiftDelta = 0;
+    textbox->caretLine = -1;
+    for (int i = 0; i < length; i++) {
+        if (text[i] == '\n') textbox->lineStarts[textbox->lineCount++] = i + 1;
+    }
+    textbox->maxLineWidth = 0;
+    for (int i = 0; i < textbox->lineCount; i++) {
+        textbox->lineWidths[i] = -1;
+        measureDynamicTextboxLine(textbox, i);
+    }
+    return true;
+}
+
+// The whole text as one terminated string. Moves the gap to the end, so it
+// costs a pass over everything after the gap; not for per-keystroke use.
+char* dynamicTextboxText(DynamicTextbox* textbox) {
+    moveDynamicTextboxGap(textbox, textbox->textLength);
+    textbox->text[textbox->textLength] = '\0';
+    return textbox->text;
+}
+
+// Text from the start through the end of the line holding pos, contiguous at
+// the returned pointer. Only that line is moved across the gap, so the
+// incremental sheet update after a keystroke stays proportional to the line.
+const char* dynamicTextboxThroughLine(DynamicTextbox* textbox, int pos) {
+    int lineEnd = pos;
+    while (lineEnd < textbox->textLength && dynamicTextboxByte(textbox, lineEnd) != '\n') lineEnd++;
+    int needed = lineEnd < textbox->textLength ? lineEnd + 1 : lineEnd;
+    if (textbox->gapStart < needed) moveDynamicTextboxGap(textbox, needed);
+    return textbox->text;
+}
+
+// Byte at logical position pos
+char dynamicTextboxByte(const DynamicTextbox* textbox, int pos) {
+    return textbox->text[pos < textbox->gapStart ? pos : pos + textbox->gapEnd - textbox->gapStart];
+}
+
+// Start of the character before pos
+int dynamicTextboxPreviousChar(const DynamicTextbox* textbox, int pos) {
+    do pos--; while (pos > 0 && ((unsigned char)dynamicTextboxByte(textbox, pos) & 0xC0) == 0x80);
+    return pos;
+}
+
+// End of the character starting at pos
+int dynamicTextboxNextChar(const DynamicTextbox* textbox, int pos) {
+    do pos++; while (pos < textbox->textLength && ((unsigned char)dynamicTextboxByte(textbox, pos) & 0xC0) == 0x80);
+    return pos;
+}
+
+// Text position under a point, or -1 if the point is below the last line.
+// The caret offsets of the line are kept, so dragging along one line is a
+// binary search per frame.
+int dynamicTextboxIndexAt(DynamicTextbox* textbox, Vector2 point) {
+    float xOffset = point.x - (textbox->bounds.x + 5) + textbox->horizontalOffset;
+    float yOffset = point.y - (textbox->bounds.y + 5) + textbox->verticalOffset;
+    int line = (int)(yOffset / (textbox->fontSize + 2));
+    if (line < 0) line = 0;
+    if (line >= textbox->lineCount) return -1;
+
+    int lineLen = 0;
+    const char* text = dynamicTextboxLine(textbox, line, &lineLen);
+    if (!text) return dynamicTextboxLineStart(textbox, line);
+    if (textbox->caretLine != line) {
+        if (lineLen + 1 > textbox->caretXCapacity) {
+            float* caretX = realloc(textbox->caretX, sizeof(float) * (lineLen + 256));
+            if (!caretX) return dynamicTextboxLineStart(textbox, line);
+            textbox->caretX = caretX;
+            textbox->caretXCapacity = lineLen + 256;
+        }
+        buildCaretOffsets(glyphAdvances(textbox->font, textbox->fontSize), text, lineLen, textbox->caretX);
+        textbox->caretLine = line;
+    }
+    return dynamicTextboxLineStart(textbox, line) + caretIndexAt(text, textbox->caretX, lineLen, xOffset);
+}
+
+void freeDynamicTextbox(DynamicTextbox* textbox) {
+    free(textbox->text);
+    free(textbox->lineStarts);
+    free(textbox->lineWidths);
+    free(textbox->lineScratch);
+    free(textbox->caretX);
+}
+
+// Input handling for dynamic textbox (paste area)
+void handleDynamicTextboxInput(DynamicTextbox* textbox) {
+    Vector2 mousePos = inputMousePosition();
+    bool mouseOver = CheckCollisionPointRec(mousePos, textbox->bounds);
+
+    if (mouseOver && inputMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        textbox->selectionStart = -1;
+        textbox->selectionEnd = -1;
+        int index = dynamicTextboxIndexAt(textbox, mousePos);
+        textbox->cursorPos = index >= 0 ? index : textbox->textLength;
+    }
+
+    if (mouseOver && inputMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+        int index = dynamicTextboxIndexAt(textbox, mousePos);
+        if (index >= 0) {
+            textbox->selectionEnd = index;
+            if (textbox->selectionStart == -1) textbox->selectionStart = textbox->cursorPos;
+        }
+    }
+
+    int key = inputCharPressed();
+    while (key > 0) {
+        bool accepted = textbox->numericOnly ? (key >= '0' && key <= '9') : ((key >= 32 && key != 127) || key == '\n');
+        if (accepted) {
+            int size = 0;
+            const char* utf8 = CodepointToUTF8(key, &size);
+            deleteDynamicTextboxSelection(textbox);
+            if (insertDynamicTextboxText(textbox, textbox->cursorPos, utf8, size)) textbox->cursorPos += size;
+        }
+        key = inputCharPressed();
+    }
+
+    if ((inputKeyDown(KEY_LEFT_CONTROL) || inputKeyDown(KEY_RIGHT_CONTROL)) && inputKeyPressed(KEY_V)) {
+        const char* clipboard = inputClipboardText();
+        char* cleanClipboard = clipboard ? malloc(strlen(clipboard) + 1) : NULL;
+        if (cleanClipboard) {
+            int len = strlen(clipboard);
+            int cleanLen = 0;
+            for (int i = 0; i < len; i++) {
+                if (clipboard[i] == '\r' && i + 1 < len && clipboard[i + 1] == '\n') {
+                    if (!textbox->numericOnly) cleanClipboard[cleanLen++] = '\n';
+                    i++;
+                } else if (textbox->numericOnly ? (clipboard[i] >= '0' && clipboard[i] <= '9') : clipboard[i] != '\r') {
+                    cleanClipboard[cleanLen++] = clipboard[i];
+                }
+            }
+            deleteDynamicTextboxSelection(textbox);
+            if (insertDynamicTextboxText(textbox, textbox->cursorPos, cleanClipboard, cleanLen)) textbox->cursorPos += cleanLen;
+            free(cleanClipboard);
+        }
+    }
+
+    if ((inputKeyDown(KEY_LEFT_CONTROL) || inputKeyDown(KEY_RIGHT_CONTROL)) && inputKeyPressed(KEY_A)) {
+        textbox->selectionStart = 0;
+        textbox->selectionEnd = textbox->textLength;
+        textbox->cursorPos = textbox->textLength;
+    }
+
+    if (inputKeyPressed(KEY_LEFT) && textbox->cursorPos > 0) {
+        textbox->cursorPos = dynamicTextboxPreviousChar(textbox, textbox->cursorPos);
+        textbox->selectionStart = textbox->selectionEnd = -1;
+    }
+    if (inputKeyPressed(KEY_RIGHT) && textbox->cursorPos < textbox->textLength) {
+        textbox->cursorPos = dynamicTextboxNextChar(textbox, textbox->cursorPos);
+        textbox->selectionStart = textbox->selectionEnd = -1;
+    }
+
+    if (inputKeyPressed(KEY_BACKSPACE) && textbox->textLength > 0) {
+        if (!deleteDynamicTextboxSelection(textbox) && textbox->cursorPos > 0) {
+            int start = dynamicTextboxPreviousChar(textbox, textbox->cursorPos);
+            deleteDynamicTextboxText(textbox, start, textbox->cursorPos - start);
+            textbox->cursorPos = start;
+        }
+        textbox->backspaceTimer = 0.3f;
+    }
+
+    if (inputKeyDown(KEY_BACKSPACE) && textbox->textLength > 0 && textbox->cursorPos > 0) {
+        textbox->backspaceTimer -= inputFrameTime();
+        if (textbox->backspaceTimer <= 0) {
+            int start = dynamicTextboxPreviousChar(textbox, textbox->cursorPos);
+            deleteDynamicTextboxText(textbox, start, textbox->cursorPos - start);
+            textbox->cursorPos = start;
+            textbox->backspaceTimer = 0.05f;
+        }
+    }
+
+    if (inputKeyReleased(KEY_BACKSPACE)) {
+        textbox->backspaceTimer = 0;
+    }
+
+    textbox->cursorBlink += inputFrameTime();
+    if (textbox->cursorBlink > 1.0f) textbox->cursorBlink = 0.0f;
+}
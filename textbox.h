@@ -0,0 +1,104 @@
+#ifndef TEXTBOX_H
+#define TEXTBOX_H
+
+#include <stdbool.h>
+#include "raylib.h"
+
+#define GLYPH_TABLE_FONTS 8         // Font and size pairs with a cached advance table
+
+// Fixed-size textbox for most inputs
+typedef struct {
+    Rectangle bounds;           // Position and size
+    char text[256];             // Fixed buffer for text
+    int textLength;             // Current length of text
+    bool editing;               // Is this textbox active?
+    float cursorBlink;          // Blink timer for cursor
+    bool numericOnly;           // Restrict to positive nonzero numbers?
+    Font font;                  // Custom font
+    float fontSize;             // Font size
+    float horizontalOffset;     // Horizontal offset for long text
+    float verticalOffset;       // Vertical offset for scrolling
+    float backspaceTimer;       // Time for multi-character removal
+    const char* placeholder;    // Placeholder text
+    int cursorPos;              // Cursor position in text
+    int selectionStart;         // Start of text selection (-1 if none)
+    int selectionEnd;           // End of text selection
+} Textbox;
+
+// Dynamic textbox for paste area
+typedef struct {
+    Rectangle bounds;           // Position and size
+    char* text;                 // Gap buffer: text before the gap, the gap, text after it
+    int textLength;             // Current length of text (gap excluded)
+    int textCapacity;           // Allocated capacity of text buffer
+    int gapStart;               // First byte of the gap; text resumes at gapEnd
+    int gapEnd;                 // First byte after the gap
+    bool editing;               // Is this textbox active?
+    float cursorBlink;          // Blink timer for cursor
+    bool numericOnly;           // Restrict to positive nonzero numbers?
+    Font font;                  // Custom font
+    float fontSize;             // Font size
+    float horizontalOffset;     // Horizontal offset for long text
+    float verticalOffset;       // Vertical offset for scrolling
+    float backspaceTimer;       // Time for multi-character removal
+    const char* placeholder;    // Placeholder text
+    int cursorPos;              // Cursor position in text
+    int selectionStart;         // Start of text selection (-1 if none)
+    int selectionEnd;           // End of text selection
+    int editStart;              // Start of text changed since the last consume (-1 if none)
+    int editOldEnd;             // End of the changed range before the edits
+    int editNewEnd;             // End of the changed range after the edits
+    int* lineStarts;            // Offset of the first character of each line (see shiftFrom)
+    float* lineWidths;          // Measured width of each line
+    int lineCount;              // Lines in the text (at least one)
+    int lineCapacity;           // Allocated entries of lineStarts and lineWidths
+    int shiftFrom;              // lineStarts from this line on are stale by shiftDelta
+    int shiftDelta;             // Pending shift, so edits don't touch every later line
+    float maxLineWidth;         // Width of the longest line (-1 until searched for)
+    char* lineScratch;          // Terminated copy of one line for raylib text calls
+    int lineScratchCapacity;    // Allocated size of lineScratch
+    float* caretX;              // Caret offsets of every position in caretLine
+    int caretXCapacity;         // Allocated entries of caretX
+    int caretLine;              // Line caretX was built for (-1 if none)
+} DynamicTextbox;
+
+// Pen advance of every ASCII character for one font and size, text spacing
+// included, so widths and caret offsets are sums instead of MeasureTextEx
+// calls. Other codepoints are looked up in the font's glyph cache.
+typedef struct {
+    unsigned int textureId;     // Font the table was built for (0 if unused)
+    Font font;
+    float fontSize;
+    float scale;                // fontSize over the font's base size
+    float advance[128];
+} GlyphAdvances;
+
+const GlyphAdvances* glyphAdvances(Font font, float fontSize);
+float textAdvance(const GlyphAdvances* glyphs, const char* text, int length);
+void buildCaretOffsets(const GlyphAdvances* glyphs, const char* text, int length, float* caretX);
+int caretIndexAt(const char* text, const float* caretX, int length, float x);
+void drawTextboxText(Textbox* textbox, Color textColor, bool isPasteArea);
+void drawDynamicTextboxText(DynamicTextbox* textbox, Color textColor);
+int previousCharStart(const char* text, int pos);
+int nextCharEnd(const char* text, int length, int pos);
+void handleTextboxInput(Textbox* textbox, bool isPasteArea);
+void handleDynamicTextboxInput(DynamicTextbox* textbox);
+void markDynamicTextboxEdit(DynamicTextbox* textbox, int pos, int removedLength, int insertedLength);
+bool insertDynamicTextboxText(DynamicTextbox* textbox, int pos, const char* text, int length);
+void deleteDynamicTextboxText(DynamicTextbox* textbox, int pos, int length);
+bool deleteDynamicTextboxSelection(DynamicTextbox* textbox);
+bool setDynamicTextboxText(DynamicTextbox* textbox, const char* text, int length);
+char* dynamicTextboxText(DynamicTextbox* textbox);
+const char* dynamicTextboxThroughLine(DynamicTextbox* textbox, int pos);
+int dynamicTextboxLineStart(const DynamicTextbox* textbox, int line);
+int findDynamicTextboxLine(const DynamicTextbox* textbox, int pos);
+int dynamicTextboxLineLength(const DynamicTextbox* textbox, int line);
+const char* dynamicTextboxLine(DynamicTextbox* textbox, int line, int* length);
+float dynamicTextboxMaxLineWidth(DynamicTextbox* textbox);
+char dynamicTextboxByte(const DynamicTextbox* textbox, int pos);
+int dynamicTextboxPreviousChar(const DynamicTextbox* textbox, int pos);
+int dynamicTextboxNextChar(const DynamicTextbox* textbox, int pos);
+int dynamicTextboxIndexAt(DynamicTextbox* textbox, Vector2 point);
+void freeDynamicTextbox(DynamicTextbox* textbox);
+
+#endif
@@ -0,0 +1,42 @@
+#include <stdlib.h>
+#include <string.h>
+#include "timeline.h"
+
+// Free all arrays owned by a timeline and reset it
+void freeTimeline(Timeline* timeline) {
+    free(timeline->events);
+    free(timeline->tempos);
+    free(timeline->timeSignatures);
+    memset(timeline, 0, sizeof(*timeline));
+}
+
+// Convert a tick to seconds. A positive bpm rescales the tempo map so that
+// its first tempo plays at bpm; without a tempo map bpm is used directly.
+double timelineTickToSeconds(const Timeline* timeline, uint32_t tick, float bpm) {
+    if (timeline->ppq <= 0) return 0.0;
+
+    if (timeline->tempoCount == 0) {
+        double beatsPerMinute = bpm > 0 ? bpm : timelineNativeBpm(timeline);
+        return (double)tick / timeline->ppq * 60.0 / beatsPerMinute;
+    }
+
+    double scale = 1.0;
+    if (bpm > 0) scale = timelineNativeBpm(timeline) / bpm;
+
+    double seconds = 0.0;
+    uint32_t lastTick = 0;
+    uint32_t usPerQuarter = timeline->tempos[0].usPerQuarter;
+    for (int i = 0; i < timeline->tempoCount && timeline->tempos[i].tick < tick; i++) {
+        seconds += (double)(timeline->tempos[i].tick - lastTick) * usPerQuarter;
+        lastTick = timeline->tempos[i].tick;
+        usPerQuarter = timeline->tempos[i].usPerQuarter;
+    }
+    seconds += (double)(tick - lastTick) * usPerQuarter;
+    return seconds / timeline->ppq / 1000000.0 * scale;
+}
+
+// Tempo the timeline plays at when no bpm override is given
+double timelineNativeBpm(const Timeline* timeline) {
+    if (timeline->tempoCount == 0) return 120.0;
+    return 60000000.0 / timeline->tempos[0].usPerQuarter;
+}
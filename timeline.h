@@ -0,0 +1,46 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A single note with its onset and length in timeline ticks
+typedef struct {
+    uint32_t tick;              // Onset in ticks
+    uint32_t duration;          // Length in ticks
+    uint8_t note;               // MIDI note number (60 = middle C)
+    uint8_t velocity;           // Note-on velocity (1-127)
+    uint8_t channel;            // Source MIDI channel
+    uint8_t track;              // Source track (or sheet line group)
+} NoteEvent;
+
+// Tempo change from a MIDI set-tempo meta event
+typedef struct {
+    uint32_t tick;              // Tick the tempo takes effect
+    uint32_t usPerQuarter;      // Microseconds per quarter note
+} TempoChange;
+
+// Time signature from a MIDI time-signature meta event
+typedef struct {
+    uint32_t tick;              // Tick the signature takes effect
+    uint8_t numerator;          // Beats per bar
+    uint8_t denominator;        // Beat unit (4 = quarter note)
+} TimeSignature;
+
+// Compact, time-sorted note timeline shared by the MIDI importer and sheet compiler
+typedef struct {
+    NoteEvent* events;          // Events sorted by tick
+    int eventCount;             // Number of events
+    TempoChange* tempos;        // Tempo map sorted by tick (empty = play at the song bpm)
+    int tempoCount;             // Number of tempo changes
+    TimeSignature* timeSignatures; // Time signatures sorted by tick
+    int timeSignatureCount;     // Number of time signatures
+    int ppq;                    // Ticks per quarter note (beat)
+    uint32_t endTick;           // Tick at which the song ends
+} Timeline;
+
+void freeTimeline(Timeline* timeline);
+double timelineTickToSeconds(const Timeline* timeline, uint32_t tick, float bpm);
+double timelineNativeBpm(const Timeline* timeline);
+
+#endif
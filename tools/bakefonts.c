@@ -0,0 +1,134 @@
+// Build step: rasterize the embedded TrueType faces at the sizes the UI uses
+// and write them out as a header of BakedFont atlases (see fonts.h), so the
+// app never runs the TrueType rasterizer on its own faces and does not carry
+// the TTF data. Each face gets its ASCII atlas, uploaded at startup, and an
+// extra set of accented Latin and Greek glyphs uploaded only as needed.
+//
+//     bakefonts resources/baked_fonts.h
+//
+// Only CPU-side raylib calls are used; no window or GL context is needed.
+#include <stdbool.h>
+#include <stdio.h>
+#include "raylib.h"
+#include "../resources/GFSNeohellenic_Italic.h"
+#include "../resources/GFSNeohellenic_Bold.h"
+#include "../resources/GFSNeohellenic_BoldItalic.h"
+
+#define GLYPH_PADDING 4         // Same as LoadFontFromMemory
+
+typedef struct {
+    const char* name;           // BakedFont variable in the header
+    const unsigned char* data;
+    int dataSize;
+    int fontSize;
+} FontBake;
+
+static const FontBake bakes[] = {
+    { "bakedItalic14", font_data_italic, sizeof(font_data_italic), 14 },
+    { "bakedBold20", font_data_bold, sizeof(font_data_bold), 20 },
+    { "bakedBold14", font_data_bold, sizeof(font_data_bold), 14 },
+    { "bakedBoldItalic12", font_data_bold_italic, sizeof(font_data_bold_italic), 12 },
+};
+
+// Non-ASCII ranges baked for every face, as far as the face covers them.
+// They are copied into the font's glyph cells only when text uses them.
+static const int extraRanges[][2] = {
+    { 0x00A0, 0x017F },         // Latin-1 Supplement, Latin Extended-A
+    { 0x0370, 0x03FF },         // Greek and Coptic
+    { 0x1F00, 0x1FFF },         // Greek Extended
+    { 0x2010, 0x205E },         // General Punctuation
+    { 0x20AC, 0x20AC },         // Euro sign
+};
+
+// Pack glyphs into an atlas and write it as a BakedFont named name
+static bool writeBakedFont(FILE* out, const char* name, const GlyphInfo* glyphs, int glyphCount, int fontSize) {
+    Rectangle* recs = NULL;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, glyphCount, fontSize, GLYPH_PADDING, 0);
+    if (!atlas.data || atlas.format != PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA) {
+        UnloadImage(atlas);
+        RL_FREE(recs);
+        return false;
+    }
+
+    // Every atlas pixel is white; only the coverage is kept
+    const unsigned char* pixels = atlas.data;
+    int count = atlas.width*atlas.height;
+    fprintf(out, "static const unsigned char %sAlpha[%d] = {", name, count);
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "%s%d,", i % 32 == 0 ? "\n    " : "", pixels[i*2 + 1]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const Rectangle %sRecs[%d] = {\n", name, glyphCount);
+    for (int i = 0; i < glyphCount; i++) {
+        fprintf(out, "    { %g, %g, %g, %g },\n", recs[i].x, recs[i].y, recs[i].width, recs[i].height);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const GlyphInfo %sGlyphs[%d] = {\n", name, glyphCount);
+    for (int i = 0; i < glyphCount; i++) {
+        fprintf(out, "    { %d, %d, %d, %d, { 0 } },\n", glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const BakedFont %s = { %d, %d, %d, %d, %d, %sAlpha, %sRecs, %sGlyphs };\n\n",
+            name, fontSize, GLYPH_PADDING, atlas.width, atlas.height, glyphCount, name, name, name);
+
+    UnloadImage(atlas);
+    RL_FREE(recs);
+    return true;
+}
+
+static bool writeBake(FILE* out, const FontBake* bake) {
+    int glyphCount = 95;        // ASCII 32..126, as LoadFontFromMemory picks by default
+    GlyphInfo* glyphs = LoadFontData(bake->data, bake->dataSize, bake->fontSize, NULL, 0, FONT_DEFAULT);
+    if (!glyphs) return false;
+    bool ok = writeBakedFont(out, bake->name, glyphs, glyphCount, bake->fontSize);
+    UnloadFontData(glyphs, glyphCount);
+    if (!ok) return false;
+
+    int codepoints[1024];
+    int codepointCount = 0;
+    for (size_t i = 0; i < sizeof(extraRanges)/sizeof(extraRanges[0]); i++) {
+        for (int c = extraRanges[i][0]; c <= extraRanges[i][1]; c++) codepoints[codepointCount++] = c;
+    }
+    glyphs = LoadFontData(bake->data, bake->dataSize, bake->fontSize, codepoints, codepointCount, FONT_DEFAULT);
+    if (!glyphs) return false;
+
+    // Drop the codepoints the face has no glyph for
+    GlyphInfo present[1024];
+    int presentCount = 0;
+    for (int i = 0; i < codepointCount; i++) {
+        if (glyphs[i].image.data || glyphs[i].advanceX != 0) present[presentCount++] = glyphs[i];
+    }
+    char extraName[64];
+    snprintf(extraName, sizeof(extraName), "%sExtra", bake->name);
+    ok = presentCount > 0 && writeBakedFont(out, extraName, present, presentCount, bake->fontSize);
+    UnloadFontData(glyphs, codepointCount);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s output.h\n", argv[0]);
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "bakefonts: cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "// Generated by tools/bakefonts.c; do not edit\n");
+    fprintf(out, "#ifndef BAKED_FONTS_H\n#define BAKED_FONTS_H\n\n#include \"../fonts.h\"\n\n");
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(bakes)/sizeof(bakes[0]) && ok; i++) {
+        ok = writeBake(out, &bakes[i]);
+        if (!ok) fprintf(stderr, "bakefonts: failed to rasterize %s\n", bakes[i].name);
+    }
+    fprintf(out, "#endif\n");
+    if (fclose(out) != 0) ok = false;
+    if (!ok) remove(argv[1]);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,535 @@
+// Headless benchmarks of the library, song files, paste area, search,
+// reverb, seeking and recording, run by `make bench`. No window or GL context is opened: fonts are used
+// through their baked metrics only.
+//
+//     bench [songs] [paste megabytes] [directory]
+//
+// Results go to stdout as CSV, one row per benchmark:
+//
+//     benchmark,size,samples,mean_ms,p50_ms,p99_ms,max_ms
+//
+// size is the number of songs for library and search rows, the number of
+// bytes of text for song file and paste area rows, the impulse length in
+// frames for reverb rows and the number of note events for seek and
+// recording rows. Progress goes to stderr. The synthetic songs are written
+// to the directory (default bench-library) and removed again afterwards.
+// The recording benchmark first checks that steady rhythms come out
+// unchanged, and bench exits non-zero if they do not.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "../platform.h"
+#include "../audio.h"
+#include "../song.h"
+#include "../library.h"
+#include "../search.h"
+#include "../sheet.h"
+#include "../textbox.h"
+#include "../reverb.h"
+#include "../performance.h"
+#include "../keyrecord.h"
+#include "../fonts.h"
+#include "../resources/baked_fonts.h"
+
+#define BENCH_DEFAULT_SONGS 2000
+#define BENCH_DEFAULT_PASTE_MB 4
+#define BENCH_EDITS 2000            // Keystrokes replayed against the paste area
+#define BENCH_MAX_SAMPLES 4096
+#define BENCH_REVERB_SECONDS 3      // Impulse response length
+#define BENCH_REVERB_BLOCKS 2000    // Device-sized blocks pushed through it
+#define BENCH_SEEK_NOTES 1000000    // Notes in the song seeked through
+#define BENCH_SEEKS 4000
+#define BENCH_RECORD_NOTES 20000    // Presses in the recording converted to notation
+#define BENCH_RECORDS 50
+
+typedef struct {
+    const char* name;
+    long size;
+    double samples[BENCH_MAX_SAMPLES];  // Milliseconds
+    int count;
+    double started;
+} Bench;
+
+// Samples of the benchmark in progress; the paste area times edits and
+// sheet updates side by side
+static Bench current;
+static Bench updates;
+static Font pasteFont;          // The paste area's font, metrics only
+
+static const char* nameWords[] = {
+    "moonlight", "sonata", "nocturne", "river", "flows", "in", "you", "waltz", "prelude", "autumn",
+    "leaves", "clair", "de", "lune", "gymnopedie", "canon", "fur", "elise", "winter", "wind",
+    "etude", "ballade", "the", "entertainer", "maple", "rag", "spring", "kiss", "rain", "requiem"
+};
+#define NAME_WORDS (int)(sizeof(nameWords) / sizeof(nameWords[0]))
+
+static const char sheetKeys[] = "1234567890qwertyuiopasdfghjklzxcvbnmQWERTYUIOPSDGHJLZCVB!@$%^*(";
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void benchBegin(Bench* bench, const char* name, long size) {
+    bench->name = name;
+    bench->size = size;
+    bench->count = 0;
+    fprintf(stderr, "%s...\n", name);
+}
+
+static void sampleBegin(Bench* bench) {
+    bench->started = nowSeconds();
+}
+
+static void sampleEnd(Bench* bench) {
+    if (bench->count < BENCH_MAX_SAMPLES) bench->samples[bench->count++] = (nowSeconds() - bench->started) * 1000.0;
+}
+
+// Same nearest-rank percentiles as the profiler
+static void benchEnd(Bench* bench) {
+    if (bench->count == 0) return;
+    qsort(bench->samples, bench->count, sizeof(double), compareDoubles);
+    double total = 0;
+    for (int i = 0; i < bench->count; i++) total += bench->samples[i];
+    printf("%s,%ld,%d,%.4f,%.4f,%.4f,%.4f\n", bench->name, bench->size, bench->count, total / bench->count,
+           bench->samples[(bench->count + 1) / 2 - 1], bench->samples[(bench->count * 99 + 99) / 100 - 1],
+           bench->samples[bench->count - 1]);
+    fflush(stdout);
+}
+
+// One line of random sheet notation: notes, chords, arpeggios and rests
+static int appendSheetLine(char* text, int capacity) {
+    int length = 0;
+    int target = 40 + rand() % 60;
+    while (length < target && length + 16 < capacity) {
+        int kind = rand() % 10;
+        if (kind < 5) {
+            text[length++] = sheetKeys[rand() % (sizeof(sheetKeys) - 1)];
+        } else if (kind < 7) {
+            int notes = 2 + rand() % 4;
+            bool spaced = kind == 6;
+            text[length++] = '[';
+            for (int i = 0; i < notes; i++) {
+                if (spaced && i > 0) text[length++] = ' ';
+                text[length++] = sheetKeys[rand() % 36];
+            }
+            text[length++] = ']';
+        } else {
+            text[length++] = kind == 9 ? '|' : ' ';
+        }
+    }
+    if (length < capacity) text[length++] = '\n';
+    return length;
+}
+
+// Sheet text of roughly size bytes, whole lines only. Free the result.
+static char* makeSheet(int size, int* length) {
+    char* text = malloc(size + 1);
+    if (!text) return NULL;
+    int used = 0;
+    while (used < size - 128) used += appendSheetLine(text + used, size - used);
+    text[used] = '\0';
+    *length = used;
+    return text;
+}
+
+static void makeSongName(char* name, int size) {
+    int words = 1 + rand() % 4;
+    int used = 0;
+    for (int i = 0; i < words && used < size; i++) {
+        used += snprintf(name + used, size - used, "%s%s", i ? " " : "", nameWords[rand() % NAME_WORDS]);
+    }
+    if (used < size) snprintf(name + used, size - used, " %d", rand() % 100);
+}
+
+static void songPath(char* path, int size, const char* directory, int index) {
+    snprintf(path, size, "%s/bench_%05d.json", directory, index);
+}
+
+// Write the synthetic library: songCount songs of 1-8 KB of sheet each
+static bool writeLibrary(const char* directory, int songCount) {
+    if (!DirectoryExists(directory) && MakeDirectory(directory) != 0) return false;
+    char path[512];
+    char name[128];
+    for (int i = 0; i < songCount; i++) {
+        int length = 0;
+        char* sheet = makeSheet(1024 + rand() % 7168, &length);
+        if (!sheet) return false;
+        makeSongName(name, sizeof(name));
+        Song song = { name, 60 + rand() % 140, sheet, length, NULL };
+        songPath(path, sizeof(path), directory, i);
+        bool saved = saveSong(path, &song);
+        free(sheet);
+        if (!saved) return false;
+    }
+    return true;
+}
+
+static void removeLibrary(const char* directory, int songCount) {
+    char path[512];
+    for (int i = 0; i < songCount; i++) {
+        songPath(path, sizeof(path), directory, i);
+        remove(path);
+        int extension = (int)strlen(path) - 5;
+        strcpy(path + extension, ".nvx");
+        remove(path);
+    }
+    snprintf(path, sizeof(path), "%s/%s", directory, LIBRARY_INDEX_NAME);
+    remove(path);
+    remove(directory);
+}
+
+static void benchLibrary(const char* directory, int songCount, SavedSong** songs, int* loadedCount) {
+    char indexPath[512];
+    snprintf(indexPath, sizeof(indexPath), "%s/%s", directory, LIBRARY_INDEX_NAME);
+
+    // Without the index every song's JSON is read for its metadata
+    benchBegin(&current, "library_scan_cold", songCount);
+    for (int i = 0; i < 5; i++) {
+        remove(indexPath);
+        SavedSong* scanned = NULL;
+        int count = 0;
+        sampleBegin(&current);
+        loadSavedSongs(&scanned, &count, directory);
+        sampleEnd(&current);
+        freeSavedSongs(scanned, count);
+    }
+    benchEnd(&current);
+
+    benchBegin(&current, "library_scan_warm", songCount);
+    for (int i = 0; i < 20; i++) {
+        SavedSong* scanned = NULL;
+        int count = 0;
+        sampleBegin(&current);
+        loadSavedSongs(&scanned, &count, directory);
+        sampleEnd(&current);
+        if (i < 19) freeSavedSongs(scanned, count);
+        else {
+            *songs = scanned;
+            *loadedCount = count;
+        }
+    }
+    benchEnd(&current);
+}
+
+static void benchSongFiles(const char* directory, int songCount, int pasteBytes) {
+    char path[512];
+    long totalBytes = 0;
+    benchBegin(&current, "song_parse_small", 0);
+    for (int i = 0; i < songCount && i < BENCH_MAX_SAMPLES; i++) {
+        songPath(path, sizeof(path), directory, i);
+        Song song;
+        sampleBegin(&current);
+        bool loaded = loadSong(path, &song);
+        sampleEnd(&current);
+        if (!loaded) continue;
+        totalBytes += song.sheetLength;
+        freeSong(&song);
+    }
+    current.size = current.count ? totalBytes / current.count : 0;
+    benchEnd(&current);
+
+    int length = 0;
+    char* sheet = makeSheet(pasteBytes, &length);
+    if (!sheet) return;
+    Song large = { "bench large song", 120, sheet, length, NULL };
+    snprintf(path, sizeof(path), "%s/bench_large.json", directory);
+
+    benchBegin(&current, "song_serialize_large", length);
+    for (int i = 0; i < 10; i++) {
+        sampleBegin(&current);
+        saveSong(path, &large);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+
+    benchBegin(&current, "song_parse_large", length);
+    for (int i = 0; i < 10; i++) {
+        Song song;
+        sampleBegin(&current);
+        bool loaded = loadSong(path, &song);
+        sampleEnd(&current);
+        if (loaded) freeSong(&song);
+    }
+    benchEnd(&current);
+    remove(path);
+    free(sheet);
+}
+
+// Replays what a frame does after each keystroke: the edit, then the
+// incremental sheet update
+static void benchPasteArea(int pasteBytes) {
+    int length = 0;
+    char* sheetText = makeSheet(pasteBytes, &length);
+    if (!sheetText) return;
+
+    DynamicTextbox paste = {
+        .bounds = { 170, 90, 380, 120 }, .text = malloc(256), .textCapacity = 256, .gapEnd = 256,
+        .font = pasteFont, .fontSize = 14, .placeholder = "", .selectionStart = -1, .selectionEnd = -1,
+        .editStart = -1
+    };
+    Sheet sheet = { 0 };
+
+    benchBegin(&current, "paste_set_text", length);
+    for (int i = 0; i < 5; i++) {
+        sampleBegin(&current);
+        setDynamicTextboxText(&paste, sheetText, length);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+
+    benchBegin(&current, "sheet_compile", length);
+    for (int i = 0; i < 5; i++) {
+        sampleBegin(&current);
+        sheetCompile(&sheet, dynamicTextboxText(&paste), paste.textLength);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+    paste.editStart = -1;
+
+    const char* editNames[] = { "paste_insert_char", "paste_delete_char", "paste_insert_lines" };
+    const char* updateNames[] = { "sheet_update_insert_char", "sheet_update_delete_char", "sheet_update_insert_lines" };
+    char lines[1024];
+    for (int kind = 0; kind < 3; kind++) {
+        benchBegin(&current, editNames[kind], paste.textLength);
+        benchBegin(&updates, updateNames[kind], paste.textLength);
+        int rounds = kind == 2 ? BENCH_EDITS / 10 : BENCH_EDITS;
+        for (int i = 0; i < rounds; i++) {
+            int pos = rand() % paste.textLength;
+            sampleBegin(&current);
+            if (kind == 0) {
+                insertDynamicTextboxText(&paste, pos, &sheetKeys[rand() % 36], 1);
+            } else if (kind == 1) {
+                deleteDynamicTextboxText(&paste, pos, 1);
+            } else {
+                int used = 0;
+                for (int line = 0; line < 10; line++) used += appendSheetLine(lines + used, sizeof(lines) - used);
+                insertDynamicTextboxText(&paste, pos, lines, used);
+            }
+            sampleEnd(&current);
+
+            sampleBegin(&updates);
+            const char* text = dynamicTextboxThroughLine(&paste, paste.editNewEnd);
+            sheetUpdate(&sheet, text, paste.textLength, paste.editStart, paste.editOldEnd, paste.editNewEnd);
+            paste.editStart = -1;
+            sampleEnd(&updates);
+        }
+        benchEnd(&current);
+        benchEnd(&updates);
+    }
+
+    // Clicks on random lines; each lands on a new line, so the caret
+    // offsets are rebuilt every time
+    benchBegin(&current, "paste_hit_test", paste.textLength);
+    for (int i = 0; i < BENCH_EDITS; i++) {
+        paste.verticalOffset = (float)(rand() % paste.lineCount) * (paste.fontSize + 2);
+        Vector2 point = { paste.bounds.x + 5 + rand() % (int)paste.bounds.width, paste.bounds.y + 5 };
+        sampleBegin(&current);
+        dynamicTextboxIndexAt(&paste, point);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+
+    benchBegin(&current, "paste_max_line_width", paste.textLength);
+    for (int i = 0; i < 100; i++) {
+        paste.maxLineWidth = -1;
+        sampleBegin(&current);
+        dynamicTextboxMaxLineWidth(&paste);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+
+    freeSheet(&sheet);
+    freeDynamicTextbox(&paste);
+    free(sheetText);
+}
+
+// Queries typed a character at a time, as the search box runs them
+static void benchSearch(const SavedSong* songs, int songCount) {
+    SongSearch search = { 0 };
+    benchBegin(&current, "search_build", songCount);
+    for (int i = 0; i < 5; i++) {
+        sampleBegin(&current);
+        buildSongSearch(&search, songs, songCount);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+
+    benchBegin(&current, "search_query", songCount);
+    char query[SEARCH_QUERY_MAX];
+    for (int i = 0; i < 200; i++) {
+        makeSongName(query, sizeof(query));
+        int length = (int)strlen(query);
+        for (int typed = 1; typed <= length; typed++) {
+            char prefix[SEARCH_QUERY_MAX];
+            memcpy(prefix, query, typed);
+            prefix[typed] = '\0';
+            sampleBegin(&current);
+            runSongSearch(&search, prefix);
+            sampleEnd(&current);
+        }
+    }
+    benchEnd(&current);
+    freeSongSearch(&search);
+}
+
+// One audio block at a time through a synthetic hall: decaying noise
+static void benchReverb(void) {
+    int impulseFrames = BENCH_REVERB_SECONDS * AUDIO_SAMPLE_RATE;
+    float* impulse = malloc(sizeof(float) * 2 * impulseFrames);
+    if (!impulse) return;
+    for (int i = 0; i < impulseFrames * 2; i++) {
+        impulse[i] = ((float)rand() / RAND_MAX - 0.5f) * expf(-6.9f * (i / 2) / impulseFrames);
+    }
+    Reverb* reverb = createReverb(impulse, impulseFrames, 2, REVERB_DEFAULT_MIX);
+    free(impulse);
+    if (!reverb) return;
+
+    float block[AUDIO_BUFFER_FRAMES * 2];
+    benchBegin(&current, "reverb_block", impulseFrames);
+    for (int i = 0; i < BENCH_REVERB_BLOCKS; i++) {
+        for (int f = 0; f < AUDIO_BUFFER_FRAMES * 2; f++) block[f] = (float)rand() / RAND_MAX - 0.5f;
+        sampleBegin(&current);
+        reverbProcess(reverb, block, AUDIO_BUFFER_FRAMES);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+    destroyReverb(reverb);
+}
+
+// Random seeks through a long song with pedalled notes: finding the event
+// and the notes held across it, as playback does
+static void benchSeek(void) {
+    Timeline timeline = { 0 };
+    timeline.ppq = 480;
+    timeline.events = malloc(sizeof(NoteEvent) * BENCH_SEEK_NOTES);
+    if (!timeline.events) return;
+    uint32_t tick = 0;
+    for (int i = 0; i < BENCH_SEEK_NOTES; i++) {
+        tick += rand() % 240;
+        NoteEvent* event = &timeline.events[i];
+        *event = (NoteEvent){ tick, 120 + rand() % 4000, 36 + rand() % 60, 40 + rand() % 80, 0, 0 };
+        if (tick + event->duration > timeline.endTick) timeline.endTick = tick + event->duration;
+    }
+    timeline.eventCount = BENCH_SEEK_NOTES;
+
+    Performance performance;
+    bool built = buildPerformance(&timeline, &performance);
+    freeTimeline(&timeline);
+    if (!built) return;
+
+    HeldNotes held;
+    benchBegin(&current, "seek", performance.eventCount);
+    for (int i = 0; i < BENCH_SEEKS; i++) {
+        double time = performance.duration * rand() / RAND_MAX;
+        sampleBegin(&current);
+        performanceHeldNotes(&performance, performanceFindEvent(&performance, time), &held);
+        sampleEnd(&current);
+    }
+    benchEnd(&current);
+    freePerformance(&performance);
+}
+
+// Quantize presses at 120 bpm and compare with the expected notation
+static bool checkRecording(const char* name, RecordedNote* notes, int count, int maxSubdivision, int bpm, const char* expected) {
+    int length = 0;
+    int recordBpm = 120;
+    char* text = recordedNotesToSheet(notes, count, &recordBpm, maxSubdivision, &length);
+    bool ok = text && strcmp(text, expected) == 0 && recordBpm == bpm;
+    if (!ok) fprintf(stderr, "recording check %s: got \"%s\" at %d bpm, expected \"%s\" at %d bpm\n", name, text ? text : "", recordBpm, expected, bpm);
+    free(text);
+    return ok;
+}
+
+// Played a little off the grid: eighths, then a sixteenth trill into a downbeat
+static bool checkRecordings(void) {
+    RecordedNote eighths[] = { { 0.0, 'a' }, { 0.26, 's' }, { 0.49, 'd' }, { 0.76, 'f' }, { 1.0, 'g' }, { 2.0, 'h' } };
+    RecordedNote trill[9];
+    for (int i = 0; i < 8; i++) trill[i] = (RecordedNote){ i * 0.125 + (i % 2 ? 0.015 : 0.0), i % 2 ? 'w' : 'e' };
+    trill[8] = (RecordedNote){ 1.0, 'a' };
+    bool ok = checkRecording("eighths", eighths, 6, RECORD_MAX_SUBDIVISION, 240, "asdfg| h");
+    ok = checkRecording("eighths at the beat", eighths, 6, 1, 120, "a[s d][f g] h") && ok;
+    ok = checkRecording("trill", trill, 9, RECORD_MAX_SUBDIVISION, 480, "ewewewewa") && ok;
+    return ok;
+}
+
+// Converting a long take of eighths and sixteenth trills with human timing
+static bool benchRecording(void) {
+    if (!checkRecordings()) return false;
+    RecordedNote* notes = malloc(sizeof(RecordedNote) * BENCH_RECORD_NOTES);
+    RecordedNote* take = malloc(sizeof(RecordedNote) * BENCH_RECORD_NOTES);
+    if (!notes || !take) {
+        free(notes);
+        free(take);
+        return true;
+    }
+    double time = 0;
+    for (int i = 0; i < BENCH_RECORD_NOTES; i++) {
+        time += (i / 64) % 2 ? 0.125 : 0.25;
+        notes[i] = (RecordedNote){ time + (rand() % 21 - 10) / 1000.0, sheetKeys[rand() % 36] };
+    }
+
+    benchBegin(&current, "record_to_sheet", BENCH_RECORD_NOTES);
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        memcpy(take, notes, sizeof(RecordedNote) * BENCH_RECORD_NOTES);
+        int bpm = 120;
+        int length = 0;
+        sampleBegin(&current);
+        char* text = recordedNotesToSheet(take, BENCH_RECORD_NOTES, &bpm, RECORD_MAX_SUBDIVISION, &length);
+        sampleEnd(&current);
+        free(text);
+    }
+    benchEnd(&current);
+    free(notes);
+    free(take);
+    return true;
+}
+
+// A Font over a baked atlas's metrics, without uploading the atlas
+static Font headlessFont(const BakedFont* baked) {
+    Font font = { 0 };
+    font.baseSize = baked->baseSize;
+    font.glyphCount = baked->glyphCount;
+    font.glyphPadding = baked->glyphPadding;
+    font.recs = (Rectangle*)baked->recs;
+    font.glyphs = (GlyphInfo*)baked->glyphs;
+    return font;
+}
+
+int main(int argc, char** argv) {
+    int songCount = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_SONGS;
+    int pasteMegabytes = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_PASTE_MB;
+    const char* directory = argc > 3 ? argv[3] : "bench-library";
+    if (songCount < 1) songCount = BENCH_DEFAULT_SONGS;
+    if (pasteMegabytes < 1) pasteMegabytes = BENCH_DEFAULT_PASTE_MB;
+    int pasteBytes = pasteMegabytes * 1024 * 1024;
+
+    SetTraceLogLevel(LOG_WARNING);
+    pasteFont = headlessFont(&bakedItalic14);
+    srand(1);
+
+    fprintf(stderr, "writing %d songs to %s...\n", songCount, directory);
+    if (!writeLibrary(directory, songCount)) {
+        fprintf(stderr, "could not write the library to %s\n", directory);
+        removeLibrary(directory, songCount);
+        return 1;
+    }
+
+    printf("benchmark,size,samples,mean_ms,p50_ms,p99_ms,max_ms\n");
+    SavedSong* songs = NULL;
+    int loadedCount = 0;
+    benchLibrary(directory, songCount, &songs, &loadedCount);
+    benchSongFiles(directory, songCount, pasteBytes);
+    benchPasteArea(pasteBytes);
+    benchSearch(songs, loadedCount);
+    benchReverb();
+    benchSeek();
+    bool recordingOk = benchRecording();
+
+    freeSavedSongs(songs, loadedCount);
+    removeLibrary(directory, songCount);
+    return recordingOk ? 0 : 1;
+}
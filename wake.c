@@ -0,0 +1,100 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+#include "platform.h"
+#include "wake.h"
+
+// raylib has no call to interrupt its event wait, but the GLFW it is built on
+// does, and glfwPostEmptyEvent may be called from any thread
+#if !defined(PLATFORM_ANDROID) && !defined(PLATFORM_DRM) && !defined(PLATFORM_RPI)
+void glfwPostEmptyEvent(void);
+#define CAN_POST_EMPTY_EVENT
+#endif
+
+// Timer thread behind wakeEventLoopAt
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    double deadline;            // nowSeconds() of the next timed wake (0 if none)
+    bool running;
+} timer;
+
+static atomic_bool started;
+
+static void* timerThread(void* argument) {
+    (void)argument;
+    pthread_mutex_lock(&timer.lock);
+    while (timer.running) {
+        if (timer.deadline == 0) {
+            pthread_cond_wait(&timer.changed, &timer.lock);
+            continue;
+        }
+        double remaining = timer.deadline - nowSeconds();
+        if (remaining <= 0) {
+            timer.deadline = 0;
+            pthread_mutex_unlock(&timer.lock);
+            wakeEventLoop();
+            pthread_mutex_lock(&timer.lock);
+            continue;
+        }
+
+        // Condition waits take wall-clock deadlines
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        double seconds = (double)until.tv_nsec * 1e-9 + remaining;
+        until.tv_sec += (time_t)seconds;
+        until.tv_nsec = (long)((seconds - (double)(time_t)seconds) * 1e9);
+        pthread_cond_timedwait(&timer.changed, &timer.lock, &until);
+    }
+    pthread_mutex_unlock(&timer.lock);
+    return NULL;
+}
+
+// Call after InitWindow
+bool startEventWake(void) {
+    pthread_mutex_init(&timer.lock, NULL);
+    pthread_cond_init(&timer.changed, NULL);
+    timer.deadline = 0;
+    timer.running = true;
+    if (pthread_create(&timer.thread, NULL, timerThread, NULL) != 0) {
+        timer.running = false;
+        pthread_cond_destroy(&timer.changed);
+        pthread_mutex_destroy(&timer.lock);
+        return false;
+    }
+    atomic_store(&started, true);
+    return true;
+}
+
+// Call before CloseWindow, after the threads that wake the loop are stopped
+void stopEventWake(void) {
+    if (!atomic_exchange(&started, false)) return;
+    pthread_mutex_lock(&timer.lock);
+    timer.running = false;
+    pthread_cond_signal(&timer.changed);
+    pthread_mutex_unlock(&timer.lock);
+    pthread_join(timer.thread, NULL);
+    pthread_cond_destroy(&timer.changed);
+    pthread_mutex_destroy(&timer.lock);
+}
+
+// Make the UI thread run a frame soon. Safe from any thread.
+void wakeEventLoop(void) {
+#ifdef CAN_POST_EMPTY_EVENT
+    if (atomic_load(&started)) glfwPostEmptyEvent();
+#endif
+}
+
+// Wake the UI thread at a nowSeconds() deadline, or earlier if another
+// deadline is already pending. Each frame asks again for what it still needs.
+void wakeEventLoopAt(double deadline) {
+    if (!atomic_load(&started)) return;
+    pthread_mutex_lock(&timer.lock);
+    if (timer.deadline == 0 || deadline < timer.deadline) {
+        timer.deadline = deadline;
+        pthread_cond_signal(&timer.changed);
+    }
+    pthread_mutex_unlock(&timer.lock);
+}
@@ -0,0 +1,13 @@
+#ifndef WAKE_H
+#define WAKE_H
+
+#include <stdbool.h>
+
+// Waking the UI thread while raylib's event waiting has it asleep in
+// EndDrawing. Until startEventWake, wake requests are ignored.
+bool startEventWake(void);
+void stopEventWake(void);
+void wakeEventLoop(void);
+void wakeEventLoopAt(double deadline);
+
+#endif
@@ -0,0 +1,320 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "platform.h"
+#include "wake.h"
+#include "watcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#define DEBOUNCE_QUIET 0.25     // Seconds without events before a batch is read
+#define DEBOUNCE_LIMIT 2.0      // Longest a busy directory delays a batch
+#define POLL_INTERVAL 2.0       // Rescan period where inotify is unavailable
+#define STOP_CHECK 0.1          // How often the thread checks for shutdown
+
+// File as last seen by the polling fallback
+typedef struct {
+    char* name;
+    int64_t size;
+    int64_t modifiedTime;
+} WatchedFile;
+
+struct LibraryWatcher {
+    char* directory;
+    pthread_t thread;
+    atomic_bool running;
+
+    // Owned by the watcher thread
+    char** pending;             // File names changed since the last batch
+    int pendingCount;
+    int pendingCapacity;
+    WatchedFile* snapshot;      // Polling fallback: directory contents, sorted by name
+    int snapshotCount;
+
+    // Handed to the UI thread under lock
+    pthread_mutex_t lock;
+    SavedSong* ready;           // Changes read off-thread, waiting to be applied
+    int readyCount;
+    int readyCapacity;
+    bool readyReload;           // Events were lost; the UI should rescan everything
+};
+
+static bool isSongFile(const char* name) {
+    size_t length = strlen(name);
+    return length > 5 && strcmp(name + length - 5, ".json") == 0;
+}
+
+static void addPending(LibraryWatcher* watcher, const char* name) {
+    if (watcher->pendingCount == watcher->pendingCapacity) {
+        int capacity = watcher->pendingCapacity ? watcher->pendingCapacity * 2 : 64;
+        char** pending = realloc(watcher->pending, sizeof(char*) * capacity);
+        if (!pending) return;
+        watcher->pending = pending;
+        watcher->pendingCapacity = capacity;
+    }
+    char* copy = strdup(name);
+    if (copy) watcher->pending[watcher->pendingCount++] = copy;
+}
+
+static int compareNames(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Read every distinct pending file on this thread and pass the results to the UI
+static void flushPending(LibraryWatcher* watcher) {
+    if (watcher->pendingCount == 0) return;
+    qsort(watcher->pending, watcher->pendingCount, sizeof(char*), compareNames);
+
+    SavedSong* changes = malloc(sizeof(SavedSong) * watcher->pendingCount);
+    int changeCount = 0;
+    for (int i = 0; i < watcher->pendingCount; i++) {
+        const char* name = watcher->pending[i];
+        bool duplicate = i > 0 && strcmp(name, watcher->pending[i - 1]) == 0;
+        if (changes && !duplicate) {
+            char* path = joinPath(watcher->directory, name);
+            SavedSong* change = &changes[changeCount];
+            if (path && !readSavedSong(path, change)) {
+                // Gone: a change without a songName removes it
+                memset(change, 0, sizeof(*change));
+                change->filename = strdup(path);
+            }
+            if (path && change->filename) changeCount++;
+            free(path);
+        }
+    }
+    for (int i = 0; i < watcher->pendingCount; i++) free(watcher->pending[i]);
+    watcher->pendingCount = 0;
+    if (!changes) {
+        pthread_mutex_lock(&watcher->lock);
+        watcher->readyReload = true;
+        pthread_mutex_unlock(&watcher->lock);
+        wakeEventLoop();
+        return;
+    }
+
+    pthread_mutex_lock(&watcher->lock);
+    if (watcher->readyCount + changeCount > watcher->readyCapacity) {
+        int capacity = watcher->readyCount + changeCount + 64;
+        SavedSong* ready = realloc(watcher->ready, sizeof(SavedSong) * capacity);
+        if (ready) {
+            watcher->ready = ready;
+            watcher->readyCapacity = capacity;
+        }
+    }
+    int accepted = 0;
+    if (watcher->readyCount + changeCount <= watcher->readyCapacity) {
+        memcpy(watcher->ready + watcher->readyCount, changes, sizeof(SavedSong) * changeCount);
+        watcher->readyCount += changeCount;
+        accepted = changeCount;
+    } else {
+        watcher->readyReload = true;
+    }
+    pthread_mutex_unlock(&watcher->lock);
+    wakeEventLoop();
+
+    for (int i = accepted; i < changeCount; i++) {
+        free(changes[i].filename);
+        free(changes[i].songName);
+    }
+    free(changes);
+}
+
+static void requestReload(LibraryWatcher* watcher) {
+    for (int i = 0; i < watcher->pendingCount; i++) free(watcher->pending[i]);
+    watcher->pendingCount = 0;
+    pthread_mutex_lock(&watcher->lock);
+    watcher->readyReload = true;
+    pthread_mutex_unlock(&watcher->lock);
+    wakeEventLoop();
+}
+
+// Directory listing gathered by the polling fallback
+typedef struct {
+    WatchedFile* files;
+    int count;
+    int capacity;
+} Snapshot;
+
+static void collectSnapshot(void* userData, const DirectoryEntry* entry) {
+    Snapshot* snapshot = userData;
+    if (!isSongFile(entry->name)) return;
+    if (snapshot->count == snapshot->capacity) {
+        int capacity = snapshot->capacity ? snapshot->capacity * 2 : 64;
+        WatchedFile* files = realloc(snapshot->files, sizeof(WatchedFile) * capacity);
+        if (!files) return;
+        snapshot->files = files;
+        snapshot->capacity = capacity;
+    }
+    char* name = strdup(entry->name);
+    if (name) snapshot->files[snapshot->count++] = (WatchedFile){ name, entry->size, entry->modifiedTime };
+}
+
+static int compareWatchedFiles(const void* a, const void* b) {
+    return strcmp(((const WatchedFile*)a)->name, ((const WatchedFile*)b)->name);
+}
+
+// Polling fallback: list the directory and queue whatever differs from last time
+static void pollDirectory(LibraryWatcher* watcher, bool queueChanges) {
+    Snapshot current = { 0 };
+    scanDirectory(watcher->directory, collectSnapshot, &current);
+    if (current.count > 1) qsort(current.files, current.count, sizeof(WatchedFile), compareWatchedFiles);
+
+    const WatchedFile* previous = watcher->snapshot;
+    int old = 0;
+    int now = 0;
+    while (queueChanges && (old < watcher->snapshotCount || now < current.count)) {
+        int order = old >= watcher->snapshotCount ? 1 : now >= current.count ? -1 : strcmp(previous[old].name, current.files[now].name);
+        if (order < 0) {
+            addPending(watcher, previous[old++].name);
+        } else if (order > 0) {
+            addPending(watcher, current.files[now++].name);
+        } else {
+            if (previous[old].size != current.files[now].size || previous[old].modifiedTime != current.files[now].modifiedTime) {
+                addPending(watcher, current.files[now].name);
+            }
+            old++;
+            now++;
+        }
+    }
+
+    for (int i = 0; i < watcher->snapshotCount; i++) free(watcher->snapshot[i].name);
+    free(watcher->snapshot);
+    watcher->snapshot = current.files;
+    watcher->snapshotCount = current.count;
+}
+
+static void pollLoop(LibraryWatcher* watcher) {
+    pollDirectory(watcher, false);
+    double nextPoll = nowSeconds() + POLL_INTERVAL;
+    while (atomic_load_explicit(&watcher->running, memory_order_acquire)) {
+        sleepUntil(nowSeconds() + STOP_CHECK);
+        if (nowSeconds() < nextPoll) continue;
+        pollDirectory(watcher, true);
+        flushPending(watcher);
+        nextPoll = nowSeconds() + POLL_INTERVAL;
+    }
+}
+
+#ifdef __linux__
+// inotify: collect names as events arrive and read them once the directory
+// has been quiet for DEBOUNCE_QUIET, or every DEBOUNCE_LIMIT during a long copy
+static bool inotifyLoop(LibraryWatcher* watcher) {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    if (inotify_add_watch(fd, watcher->directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+        close(fd);
+        return false;
+    }
+
+    char buffer[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+    double firstEvent = 0.0;
+    double lastEvent = 0.0;
+    while (atomic_load_explicit(&watcher->running, memory_order_acquire)) {
+        double wait = STOP_CHECK;
+        if (watcher->pendingCount > 0) {
+            double due = lastEvent + DEBOUNCE_QUIET;
+            if (firstEvent + DEBOUNCE_LIMIT < due) due = firstEvent + DEBOUNCE_LIMIT;
+            double remaining = due - nowSeconds();
+            if (remaining < wait) wait = remaining > 0 ? remaining : 0;
+        }
+        struct pollfd descriptor = { fd, POLLIN, 0 };
+        if (poll(&descriptor, 1, (int)(wait * 1000.0)) > 0) {
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                for (char* cursor = buffer; cursor < buffer + length; ) {
+                    const struct inotify_event* event = (const struct inotify_event*)cursor;
+                    cursor += sizeof(struct inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        requestReload(watcher);
+                        continue;
+                    }
+                    if (event->len == 0 || !isSongFile(event->name)) continue;
+                    if (watcher->pendingCount == 0) firstEvent = nowSeconds();
+                    lastEvent = nowSeconds();
+                    addPending(watcher, event->name);
+                }
+            }
+        }
+
+        double now = nowSeconds();
+        if (watcher->pendingCount > 0 && (now - lastEvent >= DEBOUNCE_QUIET || now - firstEvent >= DEBOUNCE_LIMIT)) {
+            flushPending(watcher);
+        }
+    }
+    close(fd);
+    return true;
+}
+#endif
+
+static void* watcherThread(void* argument) {
+    LibraryWatcher* watcher = argument;
+#ifdef __linux__
+    if (inotifyLoop(watcher)) return NULL;
+    TraceLog(LOG_WARNING, "Library watcher: inotify unavailable, polling %s", watcher->directory);
+#endif
+    pollLoop(watcher);
+    return NULL;
+}
+
+// Watch a song directory on a background thread. Files are re-read there;
+// the UI thread only merges finished batches.
+LibraryWatcher* createLibraryWatcher(const char* directory) {
+    LibraryWatcher* watcher = calloc(1, sizeof(LibraryWatcher));
+    if (!watcher) return NULL;
+    watcher->directory = strdup(directory);
+    pthread_mutex_init(&watcher->lock, NULL);
+    atomic_store(&watcher->running, true);
+    if (!watcher->directory || pthread_create(&watcher->thread, NULL, watcherThread, watcher) != 0) {
+        pthread_mutex_destroy(&watcher->lock);
+        free(watcher->directory);
+        free(watcher);
+        return NULL;
+    }
+    return watcher;
+}
+
+void destroyLibraryWatcher(LibraryWatcher* watcher) {
+    if (!watcher) return;
+    atomic_store(&watcher->running, false);
+    pthread_join(watcher->thread, NULL);
+    for (int i = 0; i < watcher->pendingCount; i++) free(watcher->pending[i]);
+    free(watcher->pending);
+    for (int i = 0; i < watcher->snapshotCount; i++) free(watcher->snapshot[i].name);
+    free(watcher->snapshot);
+    freeSavedSongs(watcher->ready, watcher->readyCount);
+    pthread_mutex_destroy(&watcher->lock);
+    free(watcher->directory);
+    free(watcher);
+}
+
+// Merge whatever the watcher has finished reading into the song list.
+// Never blocks the frame: if the watcher holds the lock, try next frame.
+// Returns the number of changes applied (or -1 after a full reload).
+int applyLibraryWatcherChanges(LibraryWatcher* watcher, SavedSong** songs, int* songCount, const char* directory) {
+    if (!watcher || pthread_mutex_trylock(&watcher->lock) != 0) return 0;
+    SavedSong* ready = watcher->ready;
+    int readyCount = watcher->readyCount;
+    bool reload = watcher->readyReload;
+    watcher->ready = NULL;
+    watcher->readyCount = 0;
+    watcher->readyCapacity = 0;
+    watcher->readyReload = false;
+    pthread_mutex_unlock(&watcher->lock);
+
+    if (reload) {
+        freeSavedSongs(ready, readyCount);
+        freeSavedSongs(*songs, *songCount);
+        loadSavedSongs(songs, songCount, directory);
+        return -1;
+    }
+    applySavedSongChanges(songs, songCount, ready, readyCount);
+    free(ready);
+    return readyCount;
+}
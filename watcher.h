@@ -0,0 +1,12 @@
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include "library.h"
+
+typedef struct LibraryWatcher LibraryWatcher;
+
+LibraryWatcher* createLibraryWatcher(const char* directory);
+void destroyLibraryWatcher(LibraryWatcher* watcher);
+int applyLibraryWatcherChanges(LibraryWatcher* watcher, SavedSong** songs, int* songCount, const char* directory);
+
+#endif